@@ -7,6 +7,8 @@
 
 #include "vector_ref.h"
 
+#include <evmc/utils.h>
+
 #include <utility>
 #include <cstdint>
 
@@ -18,8 +20,8 @@ using bytevec = std::vector<byte>;
 using bytesRef = vector_ref<byte>;
 using bytesConstRef = vector_ref<byte const>;
 
-std::pair<bool, bytevec> alt_bn128_pairing_product(bytesConstRef _in);
-std::pair<bool, bytevec> alt_bn128_G1_add(bytesConstRef _in);
-std::pair<bool, bytevec> alt_bn128_G1_mul(bytesConstRef _in);
+EVMC_EXPORT std::pair<bool, bytevec> alt_bn128_pairing_product(bytesConstRef _in);
+EVMC_EXPORT std::pair<bool, bytevec> alt_bn128_G1_add(bytesConstRef _in);
+EVMC_EXPORT std::pair<bool, bytevec> alt_bn128_G1_mul(bytesConstRef _in);
 
 }
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "advanced_analysis.hpp"
+#include "instructions_traits.hpp"
 #include "opcodes_helpers.h"
 #include <cassert>
 
@@ -39,7 +40,87 @@ struct BlockAnalysis
     }
 };
 
-AdvancedCodeAnalysis analyze(evmc_revision rev, bytes_view code) noexcept
+namespace
+{
+/// Decodes the PUSH instruction data into the instruction argument.
+///
+/// Small push values are stored directly in the argument, large ones go to
+/// the analysis.push_values storage.
+/// @return  The code position after the push data.
+const uint8_t* analyze_push(AdvancedCodeAnalysis& analysis, Instruction& instr, uint8_t opcode,
+    const uint8_t* code_pos, const uint8_t* code_end) noexcept
+{
+    const auto push_size = static_cast<size_t>(opcode - OP_PUSH1) + 1;
+
+    if (opcode <= OP_PUSH8)
+    {
+        const auto push_end = std::min(code_pos + push_size, code_end);
+
+        uint64_t value = 0;
+        auto insert_bit_pos = (push_size - 1) * 8;
+        while (code_pos < push_end)
+        {
+            value |= uint64_t{*code_pos++} << insert_bit_pos;
+            insert_bit_pos -= 8;
+        }
+        instr.arg.small_push_value = value;
+        return code_pos;
+    }
+
+    const auto push_end = code_pos + push_size;
+
+    auto& push_value = analysis.push_values.emplace_back();
+    const auto push_value_bytes = intx::as_bytes(push_value);
+    auto insert_pos = &push_value_bytes[push_size - 1];
+
+    // Copy bytes to the deticated storage in the order to match native endianness.
+    // The condition `code_pos < code_end` is to handle the edge case of PUSH being at
+    // the end of the code with incomplete value bytes.
+    // This condition can be replaced with single `push_end <= code_end` done once before
+    // the loop. Then the push value will stay 0 but the value is not reachable
+    // during the execution anyway.
+    // This seems like a good micro-optimization but we were not able to show
+    // this is faster, at least with GCC 8 (producing the best results at the time).
+    // FIXME: Add support for big endian architectures.
+    while (code_pos < push_end && code_pos < code_end)
+        *insert_pos-- = *code_pos++;
+
+    instr.arg.push_value = &push_value;
+    return code_pos;
+}
+
+/// Marks the code offsets being targets of the relative jumps (RJUMP, RJUMPI, RJUMPV).
+/// The EOF code section must be valid.
+std::vector<bool> find_rjump_targets(bytes_view code)
+{
+    std::vector<bool> targets(code.size());
+    for (size_t i = 0; i < code.size();)
+    {
+        const auto op = code[i];
+        if (op == OP_RJUMP || op == OP_RJUMPI)
+        {
+            const auto offset = read_int16_be(&code[i + 1]);
+            i += 3;
+            targets[static_cast<size_t>(static_cast<int64_t>(i) + offset)] = true;
+        }
+        else if (op == OP_RJUMPV)
+        {
+            const auto count = size_t{code[i + 1]} + 1;
+            const auto pc_post = i + 2 + count * sizeof(int16_t);
+            for (size_t k = 0; k < count; ++k)
+            {
+                const auto offset = read_int16_be(&code[i + 2 + k * sizeof(int16_t)]);
+                targets[static_cast<size_t>(static_cast<int64_t>(pc_post) + offset)] = true;
+            }
+            i = pc_post;
+        }
+        else
+            i += size_t{1} + instr::traits[op].immediate_size;
+    }
+    return targets;
+}
+
+AdvancedCodeAnalysis analyze_legacy(evmc_revision rev, bytes_view code) noexcept
 {
     const auto& op_tbl = get_op_table(rev);
     const auto opx_beginblock_fn = op_tbl[OPX_BEGINBLOCK].fn;
@@ -124,45 +205,9 @@ AdvancedCodeAnalysis analyze(evmc_revision rev, bytes_view code) noexcept
             break;
 
         case ANY_SMALL_PUSH:
-        {
-            const auto push_size = static_cast<size_t>(opcode - OP_PUSH1) + 1;
-            const auto push_end = std::min(code_pos + push_size, code_end);
-
-            uint64_t value = 0;
-            auto insert_bit_pos = (push_size - 1) * 8;
-            while (code_pos < push_end)
-            {
-                value |= uint64_t{*code_pos++} << insert_bit_pos;
-                insert_bit_pos -= 8;
-            }
-            instr.arg.small_push_value = value;
-            break;
-        }
-
         case ANY_LARGE_PUSH:
-        {
-            const auto push_size = static_cast<size_t>(opcode - OP_PUSH1) + 1;
-            const auto push_end = code_pos + push_size;
-
-            auto& push_value = analysis.push_values.emplace_back();
-            const auto push_value_bytes = intx::as_bytes(push_value);
-            auto insert_pos = &push_value_bytes[push_size - 1];
-
-            // Copy bytes to the deticated storage in the order to match native endianness.
-            // The condition `code_pos < code_end` is to handle the edge case of PUSH being at
-            // the end of the code with incomplete value bytes.
-            // This condition can be replaced with single `push_end <= code_end` done once before
-            // the loop. Then the push value will stay 0 but the value is not reachable
-            // during the execution anyway.
-            // This seems like a good micro-optimization but we were not able to show
-            // this is faster, at least with GCC 8 (producing the best results at the time).
-            // FIXME: Add support for big endian architectures.
-            while (code_pos < push_end && code_pos < code_end)
-                *insert_pos-- = *code_pos++;
-
-            instr.arg.push_value = &push_value;
+            code_pos = analyze_push(analysis, instr, opcode, code_pos, code_end);
             break;
-        }
 
         case OP_GAS:
         case OP_CALL:
@@ -196,4 +241,196 @@ AdvancedCodeAnalysis analyze(evmc_revision rev, bytes_view code) noexcept
     return analysis;
 }
 
+AdvancedCodeAnalysis analyze_eof1(evmc_revision rev, bytes_view container) noexcept
+{
+    const auto& op_tbl = get_op_table(rev, 1);
+
+    // In EOF the JUMPDEST is a no-op so the OPX_BEGINBLOCK is taken from the legacy table.
+    const auto opx_beginblock_fn = get_op_table(rev)[OPX_BEGINBLOCK].fn;
+
+    AdvancedCodeAnalysis analysis;
+    analysis.eof_header = read_valid_eof1_header(container);
+    const auto& header = analysis.eof_header;
+    const auto num_code_sections = header.code_sizes.size();
+
+    size_t total_code_size = 0;
+    for (const auto code_size : header.code_sizes)
+        total_code_size += code_size;
+
+    // Every instruction can be preceded by an injected OPX_BEGINBLOCK.
+    const auto max_instrs_size = 2 * total_code_size + num_code_sections;
+    analysis.instrs.reserve(max_instrs_size);
+
+    // The push_values must never be reallocated, see analyze_legacy().
+    const auto max_args_storage_size = total_code_size + 1;
+    analysis.push_values.reserve(max_args_storage_size);
+
+    analysis.code_section_entries.reserve(num_code_sections);
+
+    for (size_t code_idx = 0; code_idx < num_code_sections; ++code_idx)
+    {
+        const auto code = header.get_code(container, code_idx);
+        const auto rjump_targets = find_rjump_targets(code);
+
+        // The instruction indexes of the OPX_BEGINBLOCKs starting at the rjump targets.
+        std::vector<int32_t> target_instrs(code.size());
+
+        // The RJUMP/RJUMPI instructions and the RJUMPV tables to be resolved at the section end.
+        // Until then they contain code offsets of the jump targets.
+        std::vector<size_t> rjump_instrs;
+        std::vector<size_t> rjumpv_table_indexes;
+
+        // Every code section (function) starts with a new block.
+        analysis.code_section_entries.emplace_back(static_cast<int32_t>(analysis.instrs.size()));
+        auto block = BlockAnalysis{analysis.instrs.size()};
+        analysis.instrs.emplace_back(opx_beginblock_fn);
+
+        // The previous instruction ends the block: it is a terminating or a jump instruction.
+        bool block_ended = false;
+
+        const auto code_begin = code.data();
+        const auto code_end = code_begin + code.size();
+        auto code_pos = code_begin;
+        while (code_pos != code_end)
+        {
+            const auto offset = static_cast<size_t>(code_pos - code_begin);
+            const auto opcode = *code_pos++;
+            const auto& opcode_info = op_tbl[opcode];
+
+            if (offset != 0 && (block_ended || rjump_targets[offset]))
+            {
+                // Save current block.
+                analysis.instrs[block.begin_block_index].arg.block = block.close();
+                // Create new block.
+                block = BlockAnalysis{analysis.instrs.size()};
+                analysis.instrs.emplace_back(opx_beginblock_fn);
+                block_ended = false;
+            }
+
+            if (rjump_targets[offset])
+                target_instrs[offset] = static_cast<int32_t>(block.begin_block_index);
+
+            analysis.instrs.emplace_back(opcode_info.fn);
+
+            block.stack_req = std::max(block.stack_req, opcode_info.stack_req - block.stack_change);
+            block.stack_change += opcode_info.stack_change;
+            block.stack_max_growth = std::max(block.stack_max_growth, block.stack_change);
+
+            block.gas_cost += opcode_info.gas_cost;
+
+            auto& instr = analysis.instrs.back();
+
+            if (instr::traits[opcode].is_terminating)
+                block_ended = true;
+
+            switch (opcode)
+            {
+            default:
+                break;
+
+            case OP_RJUMP:
+            case OP_RJUMPI:
+            {
+                // RJUMPI ends the block, the follow-by block has its own OPX_BEGINBLOCK.
+                instr.arg.number = static_cast<int64_t>(offset) + 3 + read_int16_be(code_pos);
+                rjump_instrs.emplace_back(analysis.instrs.size() - 1);
+                code_pos += 2;
+                block_ended = true;
+                break;
+            }
+
+            case OP_RJUMPV:
+            {
+                const auto count = size_t{*code_pos} + 1;
+                const auto pc_post = static_cast<int64_t>(offset) + 2 + 2 * static_cast<int64_t>(count);
+                instr.arg.number = static_cast<int64_t>(analysis.rjumpv_tables.size());
+                rjumpv_table_indexes.emplace_back(analysis.rjumpv_tables.size());
+                analysis.rjumpv_tables.emplace_back(static_cast<int32_t>(count));
+                for (size_t k = 0; k < count; ++k)
+                {
+                    const auto rel_offset = read_int16_be(code_pos + 1 + k * sizeof(int16_t));
+                    analysis.rjumpv_tables.emplace_back(static_cast<int32_t>(pc_post + rel_offset));
+                }
+                code_pos += 1 + count * sizeof(int16_t);
+                block_ended = true;
+                break;
+            }
+
+            case OP_CALLF:
+            {
+                const auto fid = read_uint16_be(code_pos);
+                instr.arg.number = fid;
+
+                // The callee inputs are required on the stack. The rest of callee stack
+                // requirements are checked by its own blocks and by CALLF itself.
+                block.stack_req =
+                    std::max(block.stack_req, header.types[fid].inputs - block.stack_change);
+
+                // The execution continues after RETF with the new block.
+                code_pos += 2;
+                block_ended = true;
+                break;
+            }
+
+            case OP_DATALOADN:
+                instr.arg.number = read_uint16_be(code_pos);
+                code_pos += 2;
+                break;
+
+            case OP_DUPN:
+            case OP_SWAPN:
+                instr.arg.number = *code_pos++;
+                break;
+
+            case ANY_SMALL_PUSH:
+            case ANY_LARGE_PUSH:
+                code_pos = analyze_push(analysis, instr, opcode, code_pos, code_end);
+                break;
+
+            case OP_GAS:
+            case OP_CALL:
+            case OP_DELEGATECALL:
+            case OP_STATICCALL:
+            case OP_CREATE:
+            case OP_CREATE2:
+            case OP_SSTORE:
+                instr.arg.number = block.gas_cost;
+                break;
+            }
+        }
+
+        // Save current block. Validation guarantees the section ends with a terminating
+        // instruction or RJUMP so there is no need to inject STOP.
+        analysis.instrs[block.begin_block_index].arg.block = block.close();
+
+        // Replace the jump target code offsets with the indexes of the target blocks.
+        for (const auto instr_index : rjump_instrs)
+        {
+            auto& target = analysis.instrs[instr_index].arg.number;
+            target = target_instrs[static_cast<size_t>(target)];
+        }
+        for (const auto table_index : rjumpv_table_indexes)
+        {
+            const auto count = static_cast<size_t>(analysis.rjumpv_tables[table_index]);
+            for (size_t k = 1; k <= count; ++k)
+            {
+                auto& target = analysis.rjumpv_tables[table_index + k];
+                target = target_instrs[static_cast<size_t>(target)];
+            }
+        }
+    }
+
+    assert(analysis.instrs.size() <= max_instrs_size);
+    assert(analysis.push_values.size() <= max_args_storage_size);
+
+    return analysis;
+}
+}  // namespace
+
+AdvancedCodeAnalysis analyze(evmc_revision rev, bytes_view code) noexcept
+{
+    if (rev < EVMC_PRAGUE || !is_eof_container(code))
+        return analyze_legacy(rev, code);
+    return analyze_eof1(rev, code);
+}
 }  // namespace evmone::advanced
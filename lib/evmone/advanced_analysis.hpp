@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma once
 
+#include "eof.hpp"
 #include "execution_state.hpp"
 #include "instructions_opcodes.hpp"
 #include <evmc/evmc.hpp>
@@ -88,6 +89,9 @@ struct AdvancedExecutionState : ExecutionState
     /// This is only needed to correctly calculate the "current gas left" value.
     uint32_t current_block_cost = 0;
 
+    /// The return stack of EOF functions: the instructions to continue execution from after RETF.
+    std::vector<const Instruction*> return_stack;
+
     AdvancedExecutionState() noexcept : stack{stack_space.bottom()} {}
 
     AdvancedExecutionState(const evmc_message& message, evmc_revision revision,
@@ -115,6 +119,7 @@ struct AdvancedExecutionState : ExecutionState
         stack.reset(stack_space.bottom());
         analysis.advanced = nullptr;  // For consistency with previous behavior.
         current_block_cost = 0;
+        return_stack.clear();
     }
 };
 
@@ -179,6 +184,16 @@ struct AdvancedCodeAnalysis
     /// matching the elements from jumdest_offsets.
     /// This is value to which the next instruction pointer must be set in JUMP/JUMPI.
     std::vector<int32_t> jumpdest_targets;
+
+    /// The EOF header. The version is 0 for legacy code.
+    EOF1Header eof_header;
+
+    /// The indexes of the first instructions of EOF code sections, i.e. the CALLF targets.
+    std::vector<int32_t> code_section_entries;
+
+    /// The RJUMPV jump tables of instruction indexes.
+    /// Each table is prefixed with the number of its entries.
+    std::vector<int32_t> rjumpv_tables;
 };
 
 inline int find_jumpdest(const AdvancedCodeAnalysis& analysis, int offset) noexcept
@@ -191,8 +206,14 @@ inline int find_jumpdest(const AdvancedCodeAnalysis& analysis, int offset) noexc
                -1;
 }
 
+/// Analyzes the code (legacy or EOF container) and produces the instruction table.
+///
+/// For EOF all code sections are analyzed into a single instruction table.
+/// The relative jump (RJUMP, RJUMPI, RJUMPV) targets and the CALLF targets are resolved
+/// to instruction indexes so no code offsets are needed during execution.
 EVMC_EXPORT AdvancedCodeAnalysis analyze(evmc_revision rev, bytes_view code) noexcept;
 
-EVMC_EXPORT const OpTable& get_op_table(evmc_revision rev) noexcept;
+/// Returns the instruction table for the given revision and EOF version (0 means legacy code).
+EVMC_EXPORT const OpTable& get_op_table(evmc_revision rev, uint8_t eof_version = 0) noexcept;
 
 }  // namespace evmone::advanced
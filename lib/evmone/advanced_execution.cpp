@@ -5,6 +5,7 @@
 #include "advanced_execution.hpp"
 #include "advanced_analysis.hpp"
 #include "eof.hpp"
+#include "vm.hpp"
 #include <memory>
 
 namespace evmone::advanced
@@ -26,27 +27,21 @@ evmc_result execute(AdvancedExecutionState& state, const AdvancedCodeAnalysis& a
         state.memory.data() + state.output_offset, state.output_size);
 }
 
-evmc_result execute(evmc_vm* /*unused*/, const evmc_host_interface* host, evmc_host_context* ctx,
+evmc_result execute(evmc_vm* c_vm, const evmc_host_interface* host, evmc_host_context* ctx,
     evmc_revision rev, const evmc_message* msg, const uint8_t* code, size_t code_size) noexcept
 {
-    AdvancedCodeAnalysis analysis;
     const bytes_view container = {code, code_size};
-    if (is_eof_container(container))
+    if (is_eof_container(container) && rev < EVMC_PRAGUE)
     {
-        if (rev >= EVMC_PRAGUE)
-        {
-            const auto eof1_header = read_valid_eof1_header(container);
-            analysis = analyze(rev, eof1_header.get_code(container, 0));
-        }
-        else
-            // Skip analysis, because it will recognize 01 section id as OP_ADD and return
-            // EVMC_STACKUNDERFLOW.
-            return evmc::make_result(EVMC_UNDEFINED_INSTRUCTION, 0, 0, nullptr, 0);
+        // Skip analysis, because it will recognize 01 section id as OP_ADD and return
+        // EVMC_STACKUNDERFLOW.
+        return evmc::make_result(EVMC_UNDEFINED_INSTRUCTION, 0, 0, nullptr, 0);
     }
-    else
-        analysis = analyze(rev, container);
-    auto state =
-        std::make_unique<AdvancedExecutionState>(*msg, rev, *host, ctx, container, bytes_view{});
+
+    const auto analysis = analyze(rev, container);
+    const auto data = analysis.eof_header.get_data(container);
+    auto state = std::make_unique<AdvancedExecutionState>(*msg, rev, *host, ctx, container, data);
+    state->host_ext = static_cast<VM*>(c_vm)->get_host_ext(host);
     return execute(*state, analysis);
 }
 }  // namespace evmone::advanced
@@ -226,6 +226,84 @@ const Instruction* op_create(const Instruction* instr, AdvancedExecutionState& s
     return ++instr;
 }
 
+const Instruction* op_rjump(const Instruction* instr, AdvancedExecutionState& state) noexcept
+{
+    return &state.analysis.advanced->instrs[static_cast<size_t>(instr->arg.number)];
+}
+
+const Instruction* op_rjumpi(const Instruction* instr, AdvancedExecutionState& state) noexcept
+{
+    if (state.stack.pop() != 0)
+        return op_rjump(instr, state);
+    return ++instr;  // follow-by block
+}
+
+const Instruction* op_rjumpv(const Instruction* instr, AdvancedExecutionState& state) noexcept
+{
+    const auto& analysis = *state.analysis.advanced;
+    const auto table = &analysis.rjumpv_tables[static_cast<size_t>(instr->arg.number)];
+    const auto count = static_cast<uint64_t>(table[0]);
+
+    if (const auto case_ = state.stack.pop(); case_ < count)
+        return &analysis.instrs[static_cast<size_t>(table[1 + static_cast<size_t>(case_)])];
+    return ++instr;  // follow-by block
+}
+
+const Instruction* op_callf(const Instruction* instr, AdvancedExecutionState& state) noexcept
+{
+    const auto& analysis = *state.analysis.advanced;
+    const auto index = static_cast<size_t>(instr->arg.number);
+    const auto& type = analysis.eof_header.types[index];
+
+    if (state.stack.size() + type.max_stack_height - type.inputs > StackSpace::limit)
+        return state.exit(EVMC_STACK_OVERFLOW);
+
+    if (state.return_stack.size() >= StackSpace::limit)
+        return state.exit(EVMC_STACK_OVERFLOW);  // TODO: Add different error code.
+
+    state.return_stack.push_back(instr + 1);
+    return &analysis.instrs[static_cast<size_t>(analysis.code_section_entries[index])];
+}
+
+const Instruction* op_retf(const Instruction*, AdvancedExecutionState& state) noexcept
+{
+    const auto next = state.return_stack.back();
+    state.return_stack.pop_back();
+    return next;
+}
+
+const Instruction* op_dataloadn(const Instruction* instr, AdvancedExecutionState& state) noexcept
+{
+    const auto index = static_cast<size_t>(instr->arg.number);
+    state.stack.push(intx::be::unsafe::load<uint256>(&state.data[index]));
+    return ++instr;
+}
+
+const Instruction* op_dupn(const Instruction* instr, AdvancedExecutionState& state) noexcept
+{
+    const auto n = static_cast<int>(instr->arg.number) + 1;
+    if (state.stack.size() < n)
+        return state.exit(EVMC_STACK_UNDERFLOW);
+
+    state.stack.push(state.stack[n - 1]);
+    return ++instr;
+}
+
+const Instruction* op_swapn(const Instruction* instr, AdvancedExecutionState& state) noexcept
+{
+    const auto n = static_cast<int>(instr->arg.number) + 1;
+    if (state.stack.size() <= n)
+        return state.exit(EVMC_STACK_UNDERFLOW);
+
+    std::swap(state.stack.top(), state.stack[n]);
+    return ++instr;
+}
+
+const Instruction* op_nop(const Instruction* instr, AdvancedExecutionState& /*state*/) noexcept
+{
+    return ++instr;
+}
+
 const Instruction* op_undefined(const Instruction*, AdvancedExecutionState& state) noexcept
 {
     return state.exit(EVMC_UNDEFINED_INSTRUCTION);
@@ -260,51 +338,72 @@ constexpr std::array<instruction_exec_fn, 256> instruction_implementations = [](
     table[OP_CREATE2] = op_create<OP_CREATE2>;
     table[OP_STATICCALL] = op_call<OP_STATICCALL>;
 
-    table[OP_RJUMP] = op_undefined;
-    table[OP_RJUMPI] = op_undefined;
-    table[OP_RJUMPV] = op_undefined;
-    table[OP_CALLF] = op_undefined;
-    table[OP_RETF] = op_undefined;
-    table[OP_DATALOAD] = op_undefined;
-    table[OP_DATALOADN] = op_undefined;
-    table[OP_DATASIZE] = op_undefined;
-    table[OP_DATACOPY] = op_undefined;
-
-    table[OP_DUPN] = op_undefined;
-    table[OP_SWAPN] = op_undefined;
+    table[OP_RJUMP] = op_rjump;
+    table[OP_RJUMPI] = op_rjumpi;
+    table[OP_RJUMPV] = op_rjumpv;
+    table[OP_CALLF] = op_callf;
+    table[OP_RETF] = op_retf;
+    table[OP_DATALOADN] = op_dataloadn;
+    table[OP_DUPN] = op_dupn;
+    table[OP_SWAPN] = op_swapn;
 
     return table;
 }();
-}  // namespace
 
-EVMC_EXPORT const OpTable& get_op_table(evmc_revision rev) noexcept
+/// Builds the op tables for all revisions.
+/// In EOF code the legacy jump instructions and other deprecated ones are undefined.
+/// In legacy code the EOF-only instructions are undefined.
+consteval std::array<OpTable, EVMC_MAX_REVISION + 1> build_op_tables(bool eof) noexcept
 {
-    static constexpr auto op_tables = []() noexcept {
-        std::array<OpTable, EVMC_MAX_REVISION + 1> tables{};
-        for (size_t r = EVMC_FRONTIER; r <= EVMC_MAX_REVISION; ++r)
+    std::array<OpTable, EVMC_MAX_REVISION + 1> tables{};
+    for (size_t r = EVMC_FRONTIER; r <= EVMC_MAX_REVISION; ++r)
+    {
+        auto& table = tables[r];
+        for (size_t i = 0; i < table.size(); ++i)
         {
-            auto& table = tables[r];
-            for (size_t i = 0; i < table.size(); ++i)
+            auto& t = table[i];
+            const auto gas_cost = instr::gas_costs[r][i];
+            if (gas_cost == instr::undefined)
+            {
+                t.fn = op_undefined;
+                t.gas_cost = 0;
+            }
+            else
             {
-                auto& t = table[i];
-                const auto gas_cost = instr::gas_costs[r][i];
-                if (gas_cost == instr::undefined)
-                {
-                    t.fn = op_undefined;
-                    t.gas_cost = 0;
-                }
-                else
-                {
-                    t.fn = instruction_implementations[i];
-                    t.gas_cost = gas_cost;
-                    t.stack_req = instr::traits[i].stack_height_required;
-                    t.stack_change = instr::traits[i].stack_height_change;
-                }
+                t.fn = instruction_implementations[i];
+                t.gas_cost = gas_cost;
+                t.stack_req = instr::traits[i].stack_height_required;
+                t.stack_change = instr::traits[i].stack_height_change;
             }
         }
-        return tables;
-    }();
 
-    return op_tables[rev];
+        if (eof)
+        {
+            for (const auto opcode : {OP_JUMP, OP_JUMPI, OP_PC, OP_CALLCODE, OP_SELFDESTRUCT})
+                table[opcode] = {op_undefined, 0, 0, 0};
+            // The JUMPDEST is not a block marker in EOF: blocks start at RJUMP* targets.
+            table[OP_JUMPDEST].fn = op_nop;
+        }
+        else
+        {
+            for (const auto opcode : {OP_RJUMP, OP_RJUMPI, OP_RJUMPV, OP_CALLF, OP_RETF,
+                     OP_DATALOAD, OP_DATALOADN, OP_DATASIZE, OP_DATACOPY})
+                table[opcode] = {op_undefined, 0, 0, 0};
+            // The DUPN and SWAPN are defined in legacy code with the same gas costs
+            // but their immediate arguments are not decoded.
+            table[OP_DUPN].fn = op_undefined;
+            table[OP_SWAPN].fn = op_undefined;
+        }
+    }
+    return tables;
+}
+}  // namespace
+
+EVMC_EXPORT const OpTable& get_op_table(evmc_revision rev, uint8_t eof_version) noexcept
+{
+    static constexpr auto legacy_op_tables = build_op_tables(false);
+    static constexpr auto eof_op_tables = build_op_tables(true);
+
+    return eof_version == 0 ? legacy_op_tables[rev] : eof_op_tables[rev];
 }
 }  // namespace evmone::advanced
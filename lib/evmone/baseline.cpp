@@ -4,10 +4,13 @@
 
 #include "baseline.hpp"
 #include "baseline_instruction_table.hpp"
+#include "checkpoints.hpp"
 #include "eof.hpp"
 #include "execution_state.hpp"
 #include "instructions.hpp"
 #include "vm.hpp"
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 #ifdef NDEBUG
@@ -26,15 +29,19 @@ namespace evmone::baseline
 {
 namespace
 {
-CodeAnalysis::JumpdestMap analyze_jumpdests(bytes_view code)
+/// Marks JUMPDESTs in the map scanning the code from the instruction at the begin offset
+/// until the end offset is reached.
+/// @return  The offset of the first instruction not scanned. It may be after the code end.
+inline size_t scan_jumpdests(
+    bytes_view code, size_t begin, size_t end, CodeAnalysis::JumpdestMap& map) noexcept
 {
     // To find if op is any PUSH opcode (OP_PUSH1 <= op <= OP_PUSH32)
     // it can be noticed that OP_PUSH32 is INT8_MAX (0x7f) therefore
     // static_cast<int8_t>(op) <= OP_PUSH32 is always true and can be skipped.
     static_assert(OP_PUSH32 == std::numeric_limits<int8_t>::max());
 
-    CodeAnalysis::JumpdestMap map(code.size());  // Allocate and init bitmap with zeros.
-    for (size_t i = 0; i < code.size(); ++i)
+    auto i = begin;
+    for (; i < end; ++i)
     {
         const auto op = code[i];
         if (static_cast<int8_t>(op) >= OP_PUSH1)  // If any PUSH opcode (see explanation above).
@@ -42,7 +49,13 @@ CodeAnalysis::JumpdestMap analyze_jumpdests(bytes_view code)
         else if (INTX_UNLIKELY(op == OP_JUMPDEST))
             map[i] = true;
     }
+    return i;
+}
 
+CodeAnalysis::JumpdestMap analyze_jumpdests(bytes_view code)
+{
+    CodeAnalysis::JumpdestMap map(code.size());  // Allocate and init bitmap with zeros.
+    scan_jumpdests(code, 0, code.size(), map);
     return map;
 }
 
@@ -60,11 +73,57 @@ std::unique_ptr<uint8_t[]> pad_code(bytes_view code)
     return padded_code;
 }
 
+/// Calls the function with the code offset and the data size
+/// of every PUSH instruction of at least min_predecoded_push_size data bytes.
+template <typename Fn>
+void for_each_predecoded_push(bytes_view code, Fn fn)
+{
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        const auto op = code[i];
+        if (static_cast<int8_t>(op) < OP_PUSH1)  // Not a PUSH opcode (see scan_jumpdests()).
+            continue;
+
+        const auto len = op - size_t{OP_PUSH1 - 1};
+        if (len >= CodeAnalysis::min_predecoded_push_size)
+            fn(i, len);
+        i += len;  // Skip PUSH data.
+    }
+}
+
+/// Decodes the values of the PUSH instructions of at least min_predecoded_push_size data bytes.
+/// The executable code must be padded so the push data can be loaded as full 32-byte words.
+/// Nothing is decoded if the number of the values exceeds the capacity of the index.
+void predecode_push_values(CodeAnalysis& analysis)
+{
+    const auto code = analysis.executable_code;
+    size_t num_values = 0;
+    for_each_predecoded_push(code, [&](size_t, size_t) noexcept { ++num_values; });
+    if (num_values == 0 ||
+        num_values > size_t{std::numeric_limits<CodeAnalysis::PushValueIndex>::max()} + 1)
+        return;
+
+    analysis.push_values.reserve(num_values);
+    analysis.push_value_index.resize(code.size());
+    for_each_predecoded_push(code, [&](size_t pos, size_t len) {
+        analysis.push_value_index[pos] =
+            static_cast<CodeAnalysis::PushValueIndex>(analysis.push_values.size());
+        // The data of the truncated PUSH at the code end is in the padding (not in the view).
+        analysis.push_values.emplace_back(
+            intx::be::unsafe::load<intx::uint256>(code.data() + pos + 1) >> (8 * (32 - len)));
+    });
+}
 
-CodeAnalysis analyze_legacy(bytes_view code)
+CodeAnalysis analyze_legacy(bytes_view code, bool lazy, bool predecode_push)
 {
     // TODO: The padded code buffer and jumpdest bitmap can be created with single allocation.
-    return {pad_code(code), code.size(), analyze_jumpdests(code)};
+    auto analysis =
+        lazy ?
+            CodeAnalysis{pad_code(code), code.size(), CodeAnalysis::JumpdestMap(code.size()), 0} :
+            CodeAnalysis{pad_code(code), code.size(), analyze_jumpdests(code), code.size()};
+    if (predecode_push)
+        predecode_push_values(analysis);
+    return analysis;
 }
 
 CodeAnalysis analyze_eof1(bytes_view container)
@@ -83,13 +142,23 @@ CodeAnalysis analyze_eof1(bytes_view container)
 }
 }  // namespace
 
-CodeAnalysis analyze(evmc_revision rev, bytes_view code)
+CodeAnalysis analyze(evmc_revision rev, bytes_view code, bool lazy, bool predecode_push)
 {
     if (rev < EVMC_PRAGUE || !is_eof_container(code))
-        return analyze_legacy(code);
+        return analyze_legacy(code, lazy, predecode_push);
     return analyze_eof1(code);
 }
 
+void CodeAnalysis::analyze_jumpdests_until(size_t offset) const noexcept
+{
+    // The analysis is extended in chunks to amortize the cost of jumps to nearby locations.
+    constexpr size_t chunk_size = 1024;
+
+    const auto end = std::min(executable_code.size(), (offset / chunk_size + 1) * chunk_size);
+    m_jumpdests_analyzed_end =
+        scan_jumpdests(executable_code, m_jumpdests_analyzed_end, end, m_jumpdest_map);
+}
+
 namespace
 {
 /// Checks instruction requirements before execution.
@@ -205,8 +274,16 @@ struct Position
 }
 /// @}
 
+/// Checks if the opcode is PUSH with the value pre-decoded by the code analysis.
+constexpr bool is_predecoded_push(Opcode op) noexcept
+{
+    return op > OP_PUSH0 && op <= OP_PUSH32 &&
+           size_t{op} - OP_PUSH0 >= CodeAnalysis::min_predecoded_push_size;
+}
+
 /// A helper to invoke the instruction implementation of the given opcode Op.
-template <Opcode Op>
+/// With PredecodedPush the wide PUSH instructions take the values from the code analysis.
+template <Opcode Op, bool PredecodedPush = false>
 [[release_inline]] inline Position invoke(const CostTable& cost_table, const uint256* stack_bottom,
     Position pos, int64_t& gas, ExecutionState& state) noexcept
 {
@@ -216,21 +293,22 @@ template <Opcode Op>
         state.status = status;
         return {nullptr, pos.stack_top};
     }
-    const auto new_pos = invoke(instr::core::impl<Op>, pos, gas, state);
+    code_iterator new_pos;
+    if constexpr (PredecodedPush && is_predecoded_push(Op))
+        new_pos = invoke(instr::core::push_predecoded<Op - OP_PUSH0>, pos, gas, state);
+    else
+        new_pos = invoke(instr::core::impl<Op>, pos, gas, state);
     const auto new_stack_top = pos.stack_top + instr::traits[Op].stack_height_change;
     return {new_pos, new_stack_top};
 }
 
 
-template <bool TracingEnabled>
+template <bool TracingEnabled, bool PredecodedPush = false>
 int64_t dispatch(const CostTable& cost_table, ExecutionState& state, int64_t gas,
-    const uint8_t* code, Tracer* tracer = nullptr) noexcept
+    const uint8_t* code, Position position, Tracer* tracer = nullptr) noexcept
 {
     const auto stack_bottom = state.stack_space.bottom();
 
-    // Code iterator and stack top pointer for interpreter loop.
-    Position position{code, stack_bottom};
-
     while (true)  // Guaranteed to terminate because padded code ends with STOP.
     {
         if constexpr (TracingEnabled)
@@ -250,7 +328,8 @@ int64_t dispatch(const CostTable& cost_table, ExecutionState& state, int64_t gas
 #define ON_OPCODE(OPCODE)                                                                     \
     case OPCODE:                                                                              \
         ASM_COMMENT(OPCODE);                                                                  \
-        if (const auto next = invoke<OPCODE>(cost_table, stack_bottom, position, gas, state); \
+        if (const auto next = invoke<OPCODE, PredecodedPush>(                                 \
+                cost_table, stack_bottom, position, gas, state);                              \
             next.code_it == nullptr)                                                          \
         {                                                                                     \
             return gas;                                                                       \
@@ -275,8 +354,9 @@ int64_t dispatch(const CostTable& cost_table, ExecutionState& state, int64_t gas
 }
 
 #if EVMONE_CGOTO_SUPPORTED
+template <bool PredecodedPush = false>
 int64_t dispatch_cgoto(
-    const CostTable& cost_table, ExecutionState& state, int64_t gas, const uint8_t* code) noexcept
+    const CostTable& cost_table, ExecutionState& state, int64_t gas, Position position) noexcept
 {
 #pragma GCC diagnostic ignored "-Wpedantic"
 
@@ -293,14 +373,12 @@ int64_t dispatch_cgoto(
 
     const auto stack_bottom = state.stack_space.bottom();
 
-    // Code iterator and stack top pointer for interpreter loop.
-    Position position{code, stack_bottom};
-
     goto* cgoto_table[*position.code_it];
 
 #define ON_OPCODE(OPCODE)                                                                 \
     TARGET_##OPCODE : ASM_COMMENT(OPCODE);                                                \
-    if (const auto next = invoke<OPCODE>(cost_table, stack_bottom, position, gas, state); \
+    if (const auto next = invoke<OPCODE, PredecodedPush>(                                 \
+            cost_table, stack_bottom, position, gas, state);                              \
         next.code_it == nullptr)                                                          \
     {                                                                                     \
         return gas;                                                                       \
@@ -321,31 +399,40 @@ TARGET_OP_UNDEFINED:
     return gas;
 }
 #endif
-}  // namespace
 
-evmc_result execute(
-    const VM& vm, int64_t gas, ExecutionState& state, const CodeAnalysis& analysis) noexcept
+/// Executes the code from the given position in the code (with the stack already prepared).
+evmc_result execute_from(const VM& vm, int64_t gas, ExecutionState& state,
+    const CodeAnalysis& analysis, Position position) noexcept
 {
-    state.analysis.baseline = &analysis;  // Assign code analysis for instruction implementations.
-
     const auto code = analysis.executable_code;
 
     const auto& cost_table = get_baseline_cost_table(state.rev, analysis.eof_header.version);
 
-    auto* tracer = vm.get_tracer();
+    auto* tracer = vm.get_tracer(*state.msg, state.original_code);
     if (INTX_UNLIKELY(tracer != nullptr))
     {
         tracer->notify_execution_start(state.rev, *state.msg, analysis.executable_code);
-        gas = dispatch<true>(cost_table, state, gas, code.data(), tracer);
+        gas = dispatch<true>(cost_table, state, gas, code.data(), position, tracer);
+    }
+    else if (!analysis.push_values.empty())
+    {
+        // The separate dispatch loops for the pre-decoded PUSH values so the default ones
+        // are not affected. The tracing uses the PUSH data from the code in both cases.
+#if EVMONE_CGOTO_SUPPORTED
+        if (vm.cgoto)
+            gas = dispatch_cgoto<true>(cost_table, state, gas, position);
+        else
+#endif
+            gas = dispatch<false, true>(cost_table, state, gas, code.data(), position);
     }
     else
     {
 #if EVMONE_CGOTO_SUPPORTED
         if (vm.cgoto)
-            gas = dispatch_cgoto(cost_table, state, gas, code.data());
+            gas = dispatch_cgoto(cost_table, state, gas, position);
         else
 #endif
-            gas = dispatch<false>(cost_table, state, gas, code.data());
+            gas = dispatch<false>(cost_table, state, gas, code.data(), position);
     }
 
     const auto gas_left = (state.status == EVMC_SUCCESS || state.status == EVMC_REVERT) ? gas : 0;
@@ -360,15 +447,58 @@ evmc_result execute(
 
     return result;
 }
+}  // namespace
+
+evmc_result execute(
+    const VM& vm, int64_t gas, ExecutionState& state, const CodeAnalysis& analysis) noexcept
+{
+    state.analysis.baseline = &analysis;  // Assign code analysis for instruction implementations.
+
+    // Code iterator and stack top pointer for interpreter loop.
+    const Position start{analysis.executable_code.data(), state.stack_space.bottom()};
+    return execute_from(vm, gas, state, analysis, start);
+}
+
+evmc_result resume(const VM& vm, ExecutionState& state, const CodeAnalysis& analysis,
+    const ExecutionCheckpoint& checkpoint) noexcept
+{
+    state.analysis.baseline = &analysis;  // Assign code analysis for instruction implementations.
+
+    const auto code = analysis.executable_code.data();
+
+    state.gas_refund = checkpoint.gas_refund;
+    state.return_data = checkpoint.return_data;
+    state.call_stack.clear();
+    for (const auto offset : checkpoint.call_stack)
+        state.call_stack.push_back(code + offset);
+
+    state.memory.clear();
+    if (const auto& memory = checkpoint.memory; memory.size != 0)
+    {
+        state.memory.grow(memory.size);
+        memory.copy_to(&state.memory[0]);
+    }
+
+    const auto stack_bottom = state.stack_space.bottom();
+    std::copy(checkpoint.stack.begin(), checkpoint.stack.end(), stack_bottom + 1);
+
+    const Position start{code + checkpoint.pc, stack_bottom + checkpoint.stack.size()};
+    return execute_from(vm, checkpoint.gas_left, state, analysis, start);
+}
 
 evmc_result execute(evmc_vm* c_vm, const evmc_host_interface* host, evmc_host_context* ctx,
     evmc_revision rev, const evmc_message* msg, const uint8_t* code, size_t code_size) noexcept
 {
     auto vm = static_cast<VM*>(c_vm);
     const bytes_view container{code, code_size};
-    const auto code_analysis = analyze(rev, container);
+    // The initcode is executed once so the JUMPDEST analysis is done lazily.
+    const auto is_initcode = msg->kind == EVMC_CREATE || msg->kind == EVMC_CREATE2;
+    // Pre-decoding PUSH values does not pay off for the initcode either.
+    const auto code_analysis =
+        analyze(rev, container, is_initcode, vm->predecode_push && !is_initcode);
     const auto data = code_analysis.eof_header.get_data(container);
     auto state = std::make_unique<ExecutionState>(*msg, rev, *host, ctx, container, data);
+    state->host_ext = vm->get_host_ext(host);
     return execute(*vm, msg->gas, *state, code_analysis);
 }
 }  // namespace evmone::baseline
@@ -6,6 +6,7 @@
 #include "eof.hpp"
 #include <evmc/evmc.h>
 #include <evmc/utils.h>
+#include <intx/intx.hpp>
 #include <memory>
 #include <string_view>
 #include <vector>
@@ -16,6 +17,7 @@ using bytes_view = std::basic_string_view<uint8_t>;
 
 class ExecutionState;
 class VM;
+struct ExecutionCheckpoint;
 
 namespace baseline
 {
@@ -24,25 +26,68 @@ class CodeAnalysis
 public:
     using JumpdestMap = std::vector<bool>;
 
+    /// The type of the push_value_index entries. The code having more wide PUSH instructions
+    /// is not pre-decoded. This is not limiting: the code size is limited by EIP-170.
+    using PushValueIndex = uint16_t;
+
+    /// The minimal number of PUSH data bytes for which the pre-decoded values are used.
+    /// Shorter PUSH data is loaded from the code with a single word load anyway.
+    static constexpr size_t min_predecoded_push_size = 9;
+
     bytes_view executable_code;  ///< Executable code section.
-    JumpdestMap jumpdest_map;    ///< Map of valid jump destinations.
-    EOF1Header eof_header;       ///< The EOF header.
+
+    EOF1Header eof_header;  ///< The EOF header.
+
+    /// The pre-decoded values of the PUSH instructions having at least min_predecoded_push_size
+    /// data bytes, in the code order. Empty if the pre-decoding is not enabled
+    /// or there are no such instructions in the code (or too many, see PushValueIndex).
+    std::vector<intx::uint256> push_values;
+
+    /// The index in push_values of the value of the PUSH instruction at the given code offset.
+    /// The entries for other code offsets are unspecified.
+    std::vector<PushValueIndex> push_value_index;
 
 private:
     /// Padded code for faster legacy code execution.
     /// If not nullptr the executable_code must point to it.
     std::unique_ptr<uint8_t[]> m_padded_code;
 
+    /// Map of valid jump destinations.
+    /// In the lazy analysis mode it is only complete up to the analyzed code prefix
+    /// and is extended by is_jumpdest().
+    mutable JumpdestMap m_jumpdest_map;
+
+    /// The end of the code prefix already analyzed for JUMPDESTs.
+    /// This is always an instruction boundary (it may be after the code end).
+    mutable size_t m_jumpdests_analyzed_end = 0;
+
+    /// Extends the lazy JUMPDEST analysis to cover the given code offset.
+    void analyze_jumpdests_until(size_t offset) const noexcept;
+
 public:
-    CodeAnalysis(std::unique_ptr<uint8_t[]> padded_code, size_t code_size, JumpdestMap map)
+    CodeAnalysis(std::unique_ptr<uint8_t[]> padded_code, size_t code_size, JumpdestMap map,
+        size_t jumpdests_analyzed_end)
       : executable_code{padded_code.get(), code_size},
-        jumpdest_map{std::move(map)},
-        m_padded_code{std::move(padded_code)}
+        m_padded_code{std::move(padded_code)},
+        m_jumpdest_map{std::move(map)},
+        m_jumpdests_analyzed_end{jumpdests_analyzed_end}
     {}
 
     CodeAnalysis(bytes_view code, EOF1Header header)
       : executable_code{code}, eof_header{std::move(header)}
     {}
+
+    /// Checks if the code offset is a valid jump destination.
+    /// The offset must be less than the code size.
+    ///
+    /// In the lazy analysis mode this extends the analysis so the lazy analysis must not be
+    /// shared by threads executing concurrently.
+    [[nodiscard]] bool is_jumpdest(size_t offset) const noexcept
+    {
+        if (offset >= m_jumpdests_analyzed_end)
+            analyze_jumpdests_until(offset);
+        return m_jumpdest_map[offset];
+    }
 };
 static_assert(std::is_move_constructible_v<CodeAnalysis>);
 static_assert(std::is_move_assignable_v<CodeAnalysis>);
@@ -50,7 +95,17 @@ static_assert(!std::is_copy_constructible_v<CodeAnalysis>);
 static_assert(!std::is_copy_assignable_v<CodeAnalysis>);
 
 /// Analyze the code to build the bitmap of valid JUMPDEST locations.
-EVMC_EXPORT CodeAnalysis analyze(evmc_revision rev, bytes_view code);
+///
+/// In the lazy mode the legacy code JUMPDEST analysis is deferred until jumps are executed
+/// and then only covers the code up to the jump destination (rounded up to a chunk).
+/// This is beneficial for the code executed once and mostly linearly, e.g. initcode.
+/// The lazy analysis is completed by the execution so it must not be shared across threads.
+///
+/// With predecode_push the values of the wide legacy PUSH instructions are decoded
+/// to the native representation upfront (see CodeAnalysis::push_values).
+/// This is beneficial for the code executed many times, e.g. in loops.
+EVMC_EXPORT CodeAnalysis analyze(
+    evmc_revision rev, bytes_view code, bool lazy = false, bool predecode_push = false);
 
 /// Executes in Baseline interpreter using EVMC-compatible parameters.
 evmc_result execute(evmc_vm* vm, const evmc_host_interface* host, evmc_host_context* ctx,
@@ -60,5 +115,12 @@ evmc_result execute(evmc_vm* vm, const evmc_host_interface* host, evmc_host_cont
 EVMC_EXPORT evmc_result execute(
     const VM&, int64_t gas_limit, ExecutionState& state, const CodeAnalysis& analysis) noexcept;
 
+/// Resumes the execution in Baseline interpreter from the checkpoint.
+///
+/// The state must be initialized for the same message and code as the checkpointed execution
+/// and the host must be in the state it was at the checkpoint.
+EVMC_EXPORT evmc_result resume(const VM&, ExecutionState& state, const CodeAnalysis& analysis,
+    const ExecutionCheckpoint& checkpoint) noexcept;
+
 }  // namespace baseline
 }  // namespace evmone
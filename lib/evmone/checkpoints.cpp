@@ -0,0 +1,120 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "checkpoints.hpp"
+#include "baseline.hpp"
+#include "execution_state.hpp"
+#include <algorithm>
+
+namespace evmone
+{
+namespace
+{
+/// Takes the snapshot of the memory sharing the pages not modified with the previous snapshot.
+MemorySnapshot snapshot_memory(bytes_view memory, const MemorySnapshot* prev)
+{
+    constexpr auto page_size = MemorySnapshot::page_size;
+
+    MemorySnapshot s;
+    s.size = memory.size();
+    s.pages.reserve((memory.size() + page_size - 1) / page_size);
+    for (size_t offset = 0; offset < memory.size(); offset += page_size)
+    {
+        const auto page = memory.substr(offset, page_size);
+        if (const auto i = s.pages.size();
+            prev != nullptr && i < prev->pages.size() && *prev->pages[i] == page)
+            s.pages.push_back(prev->pages[i]);
+        else
+            s.pages.push_back(std::make_shared<const bytes>(page));
+    }
+    return s;
+}
+
+/// @see create_checkpoint_tracer()
+class CheckpointTracer : public Tracer
+{
+    CheckpointIndex& m_index;
+
+    /// The number of the frames being executed. The top-level frame is 1.
+    int m_frames = 0;
+
+    uint64_t m_step = 0;
+
+    /// The gas left at the last checkpoint (or at the start of the execution).
+    int64_t m_last_gas = 0;
+
+    void on_execution_start(
+        evmc_revision /*rev*/, const evmc_message& msg, bytes_view /*code*/) noexcept override
+    {
+        if (m_frames++ != 0)
+            return;
+
+        m_index.checkpoints.clear();
+        m_step = 0;
+        m_last_gas = msg.gas;
+    }
+
+    void on_instruction_start(uint32_t pc, const intx::uint256* stack_top, int stack_height,
+        int64_t gas, const ExecutionState& state) noexcept override
+    {
+        if (m_frames != 1)
+            return;
+
+        if (m_last_gas - gas >= m_index.gas_interval)
+        {
+            m_last_gas = gas;
+            snapshot(pc, stack_top, stack_height, gas, state);
+        }
+        ++m_step;
+    }
+
+    void on_execution_end(const evmc_result& /*result*/) noexcept override { --m_frames; }
+
+    void snapshot(uint32_t pc, const intx::uint256* stack_top, int stack_height, int64_t gas,
+        const ExecutionState& state)
+    {
+        auto& cp = m_index.checkpoints.emplace_back();
+        cp.step = m_step;
+        cp.pc = pc;
+        cp.gas_left = gas;
+        cp.gas_refund = state.gas_refund;
+        cp.stack.assign(stack_top + 1 - stack_height, stack_top + 1);
+        cp.return_data = state.return_data;
+
+        const auto code = state.analysis.baseline->executable_code.data();
+        cp.call_stack.reserve(state.call_stack.size());
+        for (const auto* ret : state.call_stack)
+            cp.call_stack.push_back(static_cast<uint32_t>(ret - code));
+
+        const auto& checkpoints = m_index.checkpoints;
+        cp.memory = snapshot_memory({state.memory.data(), state.memory.size()},
+            checkpoints.size() >= 2 ? &checkpoints[checkpoints.size() - 2].memory : nullptr);
+
+        if (m_index.journal_position)
+            cp.journal_position = m_index.journal_position();
+    }
+
+public:
+    explicit CheckpointTracer(CheckpointIndex& index) noexcept : m_index{index} {}
+};
+}  // namespace
+
+void MemorySnapshot::copy_to(uint8_t* out) const noexcept
+{
+    for (const auto& page : pages)
+        out = std::copy(page->begin(), page->end(), out);
+}
+
+const ExecutionCheckpoint* CheckpointIndex::find(uint64_t step) const noexcept
+{
+    const auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), step,
+        [](uint64_t s, const ExecutionCheckpoint& cp) noexcept { return s < cp.step; });
+    return it != checkpoints.begin() ? &*std::prev(it) : nullptr;
+}
+
+std::unique_ptr<Tracer> create_checkpoint_tracer(CheckpointIndex& index)
+{
+    return std::make_unique<CheckpointTracer>(index);
+}
+}  // namespace evmone
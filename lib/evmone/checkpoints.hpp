@@ -0,0 +1,87 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "tracing.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace evmone
+{
+using bytes = std::basic_string<uint8_t>;
+
+/// The snapshot of the memory split into pages shared between the consecutive checkpoints.
+///
+/// Only the pages modified since the previous snapshot are copied. The modified pages are found
+/// by comparing the memory with the previous snapshot, so taking the snapshot is still linear
+/// in the memory size. This is a deliberate trade-off: the comparison is much cheaper than
+/// the copy and does not require tracking of the memory writes in the interpreter.
+struct MemorySnapshot
+{
+    static constexpr size_t page_size = 4 * 1024;
+
+    /// The memory size.
+    size_t size = 0;
+
+    /// The memory pages. The last page may be shorter than page_size.
+    std::vector<std::shared_ptr<const bytes>> pages;
+
+    /// Copies the memory contents to the output buffer of the memory size.
+    void copy_to(uint8_t* out) const noexcept;
+};
+
+/// The snapshot of the top-level execution frame taken before executing the instruction.
+struct ExecutionCheckpoint
+{
+    /// The number of instructions of the top-level frame executed before the checkpoint.
+    uint64_t step = 0;
+
+    /// The offset of the instruction in the executable code.
+    uint32_t pc = 0;
+
+    int64_t gas_left = 0;
+    int64_t gas_refund = 0;
+
+    /// The stack items from the bottom to the top.
+    std::vector<intx::uint256> stack;
+
+    /// The memory contents. The pages not modified are shared with the previous checkpoint.
+    MemorySnapshot memory;
+
+    bytes return_data;
+
+    /// The EOF return stack as the offsets in the executable code.
+    std::vector<uint32_t> call_stack;
+
+    /// The host state journal position reported by CheckpointIndex::journal_position.
+    size_t journal_position = 0;
+};
+
+/// The index of checkpoints of a single message execution ordered by the step number.
+///
+/// The checkpoints are taken every gas_interval of gas used by the top-level frame
+/// (including the gas passed to nested calls). Nested frames are not checkpointed.
+struct CheckpointIndex
+{
+    /// The minimal amount of gas used between two consecutive checkpoints.
+    int64_t gas_interval = 0;
+
+    /// The optional callback reporting the position of the host state journal
+    /// the host must be rewound to before resuming from a checkpoint.
+    std::function<size_t()> journal_position;
+
+    std::vector<ExecutionCheckpoint> checkpoints;
+
+    /// Returns the nearest checkpoint at or before the step.
+    /// Returns null if there is none, i.e. the execution must be started from the beginning.
+    [[nodiscard]] EVMC_EXPORT const ExecutionCheckpoint* find(uint64_t step) const noexcept;
+};
+
+/// Creates the tracer collecting the checkpoints of the traced execution to the index.
+///
+/// The index is cleared when the next top-level execution starts.
+/// The checkpoints can be resumed from with baseline::resume().
+EVMC_EXPORT std::unique_ptr<Tracer> create_checkpoint_tracer(CheckpointIndex& index);
+}  // namespace evmone
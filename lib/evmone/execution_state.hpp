@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma once
 
+#include "host_ext.hpp"
 #include <evmc/evmc.hpp>
 #include <intx/intx.hpp>
 #include <string>
@@ -156,6 +157,12 @@ public:
 
     std::vector<const uint8_t*> call_stack;
 
+    /// The evmone host interface extension. Null if not used.
+    const ExtendedHostInterface* host_ext = nullptr;
+
+    /// The host context to be used with the host_ext functions.
+    evmc_host_context* host_context = nullptr;
+
     /// Stack space allocation.
     ///
     /// This is the last field to make other fields' offsets of reasonable values.
@@ -170,7 +177,8 @@ public:
         host{host_interface, host_ctx},
         rev{revision},
         original_code{_code},
-        data{_data}
+        data{_data},
+        host_context{host_ctx}
     {}
 
     /// Resets the contents of the ExecutionState so that it could be reused.
@@ -190,6 +198,8 @@ public:
         output_offset = 0;
         output_size = 0;
         m_tx = {};
+        host_ext = nullptr;
+        host_context = host_ctx;
     }
 
     [[nodiscard]] bool in_static_mode() const { return (msg->flags & EVMC_STATIC) != 0; }
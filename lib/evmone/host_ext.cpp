@@ -0,0 +1,58 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "host_ext.hpp"
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace evmone
+{
+namespace
+{
+/// The max number of the registered extended host interfaces.
+/// These are the static interfaces of the host implementations so only a few are expected.
+constexpr size_t max_registered_host_exts = 16;
+
+/// The registered extended host interfaces. The slots are filled in order and never cleared,
+/// so they are read without the lock.
+std::array<std::atomic<const ExtendedHostInterface*>, max_registered_host_exts>
+    registered_host_exts{};
+
+/// The number of the filled slots of the registered_host_exts.
+std::atomic<size_t> num_registered_host_exts = 0;
+
+/// The mutex serializing the registrations.
+std::mutex registration_mutex;
+}  // namespace
+
+bool register_host_ext(const ExtendedHostInterface& ext) noexcept
+{
+    if (ext.magic != ExtendedHostInterface::magic_value)
+        return false;
+
+    const std::lock_guard lock{registration_mutex};
+    if (find_host_ext(&ext.evmc) != nullptr)
+        return true;
+
+    const auto n = num_registered_host_exts.load(std::memory_order_relaxed);
+    if (n == max_registered_host_exts)
+        return false;
+    registered_host_exts[n].store(&ext, std::memory_order_relaxed);
+    num_registered_host_exts.store(n + 1, std::memory_order_release);
+    return true;
+}
+
+const ExtendedHostInterface* find_host_ext(const evmc_host_interface* host) noexcept
+{
+    const auto n = num_registered_host_exts.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto* const ext = registered_host_exts[i].load(std::memory_order_relaxed);
+        if (&ext->evmc == host)
+            return ext;
+    }
+    return nullptr;
+}
+}  // namespace evmone
@@ -0,0 +1,80 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <evmc/evmc.h>
+#include <evmc/utils.h>
+
+namespace evmone
+{
+/// The result of the combined storage load host operation.
+struct StorageLoadResult
+{
+    evmc_bytes32 value;                 ///< The current value of the storage slot.
+    evmc_access_status access_status;  ///< The access status of the slot before the access.
+};
+
+/// The result of the combined storage store host operation.
+struct StorageStoreResult
+{
+    evmc_storage_status status;         ///< The storage update status.
+    evmc_access_status access_status;  ///< The access status of the slot before the access.
+};
+
+/// The result of the combined account query host operation.
+struct AccountQueryResult
+{
+    evmc_access_status access_status;  ///< The access status of the account before the access.
+    bool exists;                        ///< The account existence as in account_exists().
+    size_t code_size;                   ///< The size of the account code.
+    uint8_t code_prefix[2];             ///< The first bytes of the code (enough to detect EOF).
+};
+
+/// The evmone extension of the EVMC host interface.
+///
+/// The combined storage operations access the storage slot once instead of separate
+/// access_storage() and get_storage()/set_storage() calls. They also mark the slot as warm.
+/// The account query replaces the access_account(), account_exists() and copy_code() calls
+/// needed to prepare a call. The host may keep the queried account
+/// to execute the following call message with it.
+/// The extended interface is used by evmone only when enabled with the "host_ext" option
+/// and the host interface passed to execute() is the evmc member of the extended interface
+/// registered with register_host_ext(). The plain EVMC host interfaces can be used
+/// with the option too: they are never read past the EVMC struct.
+struct ExtendedHostInterface
+{
+    /// The magic identifying the extension: "evmone" followed by the 2-byte version.
+    /// The version is bumped on any incompatible change of this struct.
+    static constexpr uint64_t magic_value = 0x65766d6f6e65'0001;
+
+    /// The EVMC host interface. This must be the first member.
+    evmc_host_interface evmc;
+
+    /// The magic of the extension. Must be magic_value to be registered.
+    uint64_t magic;
+
+    /// The combined access_storage() and get_storage().
+    StorageLoadResult (*load_storage)(evmc_host_context* context, const evmc_address* address,
+        const evmc_bytes32* key) noexcept;
+
+    /// The combined access_storage() and set_storage().
+    StorageStoreResult (*store_storage)(evmc_host_context* context, const evmc_address* address,
+        const evmc_bytes32* key, const evmc_bytes32* value) noexcept;
+
+    /// The combined access_account(), account_exists() and copy_code() prefix.
+    AccountQueryResult (*query_account)(
+        evmc_host_context* context, const evmc_address* address) noexcept;
+};
+
+/// Registers the extended host interface so evmone recognizes its evmc member
+/// passed to execute(). The interface must outlive all the executions using it.
+/// @return  False if the magic does not match magic_value or too many interfaces
+///          have been registered.
+EVMC_EXPORT bool register_host_ext(const ExtendedHostInterface& ext) noexcept;
+
+/// Returns the registered extended host interface having the given host interface
+/// as its evmc member or null if there is no such interface.
+/// Only the addresses are compared so any host interface can be checked safely.
+EVMC_EXPORT const ExtendedHostInterface* find_host_ext(const evmc_host_interface* host) noexcept;
+}  // namespace evmone
@@ -699,8 +699,9 @@ Result sstore(StackTop stack, int64_t gas_left, ExecutionState& state) noexcept;
 /// Internal jump implementation for JUMP/JUMPI instructions.
 inline code_iterator jump_impl(ExecutionState& state, const uint256& dst) noexcept
 {
-    const auto& jumpdest_map = state.analysis.baseline->jumpdest_map;
-    if (dst >= jumpdest_map.size() || !jumpdest_map[static_cast<size_t>(dst)])
+    const auto& analysis = *state.analysis.baseline;
+    if (dst >= analysis.executable_code.size() ||
+        !analysis.is_jumpdest(static_cast<size_t>(dst)))
     {
         state.status = EVMC_BAD_JUMP_DESTINATION;
         return nullptr;
@@ -864,6 +865,20 @@ inline code_iterator push(StackTop stack, ExecutionState& /*state*/, code_iterat
     return pos + (Len + 1);
 }
 
+/// PUSH instruction implementation taking the value pre-decoded by the code analysis
+/// (see baseline::CodeAnalysis::push_values). Used only for the code analysed with
+/// the pre-decoding (by the separate dispatch loop so the push<Len> is not affected).
+template <size_t Len>
+inline code_iterator push_predecoded(
+    StackTop stack, ExecutionState& state, code_iterator pos) noexcept
+{
+    static_assert(Len >= baseline::CodeAnalysis::min_predecoded_push_size);
+    const auto& analysis = *state.analysis.baseline;
+    const auto pc = static_cast<size_t>(pos - analysis.executable_code.data());
+    stack.push(analysis.push_values[analysis.push_value_index[pc]]);
+    return pos + (Len + 1);
+}
+
 /// DUP instruction implementation.
 /// @tparam N  The number as in the instruction definition, e.g. DUP3 is dup<3>.
 template <int N>
@@ -15,7 +15,7 @@ auto is_precompile(const evmc::address& addr) -> bool {
 }
 
 template <evmc_opcode Op>
-evmc_status_code call_impl(StackTop stack, ExecutionState& state) noexcept
+Result call_impl(StackTop stack, int64_t gas_left, ExecutionState& state) noexcept
 {
     static_assert(
         Op == OP_CALL || Op == OP_CALLCODE || Op == OP_DELEGATECALL || Op == OP_STATICCALL);
@@ -32,7 +32,15 @@ evmc_status_code call_impl(StackTop stack, ExecutionState& state) noexcept
     stack.push(0);  // Assume failure.
     state.return_data.clear();
 
-    if (state.rev >= EVMC_BERLIN && state.host.access_account(dst) == EVMC_ACCESS_COLD)
+    // With the host extension all the information about the destination account
+    // is fetched with a single query. Otherwise, it is fetched lazily with EVMC methods.
+    AccountQueryResult dst_query{};
+    if (state.host_ext != nullptr)
+        dst_query = state.host_ext->query_account(state.host_context, &dst);
+
+    if (state.rev >= EVMC_BERLIN &&
+        (state.host_ext != nullptr ? dst_query.access_status : state.host.access_account(dst)) ==
+            EVMC_ACCESS_COLD)
     {
         if ((gas_left -= instr::additional_cold_account_access_cost) < 0)
             return {EVMC_OUT_OF_GAS, gas_left};
@@ -75,7 +83,8 @@ evmc_status_code call_impl(StackTop stack, ExecutionState& state) noexcept
         if (has_value && state.in_static_mode())
             return {EVMC_STATIC_MODE_VIOLATION, gas_left};
 
-        if ((has_value || state.rev < EVMC_SPURIOUS_DRAGON) && !state.host.account_exists(dst))
+        if ((has_value || state.rev < EVMC_SPURIOUS_DRAGON) &&
+            !(state.host_ext != nullptr ? dst_query.exists : state.host.account_exists(dst)))
             cost += 25000;
     }
 
@@ -110,9 +119,13 @@ evmc_status_code call_impl(StackTop stack, ExecutionState& state) noexcept
             // The code targeted by DELEGATECALL must also be an EOF.
             // This restriction has been added to EIP-3540 in
             // https://github.com/ethereum/EIPs/pull/7131
-            uint8_t target_code_prefix[2];
-            const auto s = state.host.copy_code(
-                msg.code_address, 0, target_code_prefix, std::size(target_code_prefix));
+            uint8_t target_code_prefix[std::size(dst_query.code_prefix)];
+            const auto s = state.host_ext != nullptr ?
+                               std::min(dst_query.code_size, std::size(target_code_prefix)) :
+                               state.host.copy_code(msg.code_address, 0, target_code_prefix,
+                                   std::size(target_code_prefix));
+            if (state.host_ext != nullptr)
+                std::copy_n(dst_query.code_prefix, s, target_code_prefix);
             if (!is_eof_container({target_code_prefix, s}))
                 return {EVMC_SUCCESS, gas_left};
         }
@@ -120,7 +133,7 @@ evmc_status_code call_impl(StackTop stack, ExecutionState& state) noexcept
 
     if(is_precompile(dst)) {
         if(Op != OP_STATICCALL) {
-            return EVMC_STATIC_MODE_VIOLATION;
+            return {EVMC_STATIC_MODE_VIOLATION, gas_left};
         }
 
         auto contract_id = static_cast<uint16_t>(intx::be::load<uint256>(dst));
@@ -128,15 +141,15 @@ evmc_status_code call_impl(StackTop stack, ExecutionState& state) noexcept
         auto retval = std::pair<bool, bytevec>();
         switch(contract_id) {
             case 6: {
-                if((state.gas_left -= 150) < 0) {
-                    return EVMC_OUT_OF_GAS;
+                if((gas_left -= 150) < 0) {
+                    return {EVMC_OUT_OF_GAS, gas_left};
                 }
                 retval = alt_bn128_G1_add(inp);
                 break;
             }
             case 7: {
-                if((state.gas_left -= 6000) < 0) {
-                    return EVMC_OUT_OF_GAS;
+                if((gas_left -= 6000) < 0) {
+                    return {EVMC_OUT_OF_GAS, gas_left};
                 }
                 retval = alt_bn128_G1_mul(inp);
                 break;
@@ -144,8 +157,8 @@ evmc_status_code call_impl(StackTop stack, ExecutionState& state) noexcept
             case 8: {
                 auto k = msg.input_size / (32 * 6);
                 auto gas_used = 34000 * k + 45000;
-                if((state.gas_left -= gas_used) < 0) {
-                    return EVMC_OUT_OF_GAS;
+                if((gas_left -= static_cast<int64_t>(gas_used)) < 0) {
+                    return {EVMC_OUT_OF_GAS, gas_left};
                 }
                 retval = alt_bn128_pairing_product(inp);
                 break;
@@ -153,14 +166,14 @@ evmc_status_code call_impl(StackTop stack, ExecutionState& state) noexcept
             default: {
                 // Not implemented
                 stack.top() = false;
-                return EVMC_SUCCESS;
+                return {EVMC_SUCCESS, gas_left};
             }
         }
 
         stack.top() = retval.first;
         if (const auto copy_size = std::min(size_t(output_size), retval.second.size()); copy_size > 0)
             std::memcpy(&state.memory[size_t(output_offset)], retval.second.data(), copy_size);
-        return EVMC_SUCCESS;
+        return {EVMC_SUCCESS, gas_left};
     }
 
     const auto result = state.host.call(msg);
@@ -97,13 +97,26 @@ Result sload(StackTop stack, int64_t gas_left, ExecutionState& state) noexcept
     auto& x = stack.top();
     const auto key = intx::be::store<evmc::bytes32>(x);
 
+    // The warm storage access cost is already applied (from the cost table).
+    // For the cold access we need to apply additional cold storage access cost.
+    constexpr auto additional_cold_sload_cost =
+        instr::cold_sload_cost - instr::warm_storage_read_cost;
+
+    if (state.host_ext != nullptr)
+    {
+        // Single storage lookup in the host.
+        const auto r =
+            state.host_ext->load_storage(state.host_context, &state.msg->recipient, &key);
+        if (state.rev >= EVMC_BERLIN && r.access_status == EVMC_ACCESS_COLD &&
+            (gas_left -= additional_cold_sload_cost) < 0)
+            return {EVMC_OUT_OF_GAS, gas_left};
+        x = intx::be::load<uint256>(r.value);
+        return {EVMC_SUCCESS, gas_left};
+    }
+
     if (state.rev >= EVMC_BERLIN &&
         state.host.access_storage(state.msg->recipient, key) == EVMC_ACCESS_COLD)
     {
-        // The warm storage access cost is already applied (from the cost table).
-        // Here we need to apply additional cold storage access cost.
-        constexpr auto additional_cold_sload_cost =
-            instr::cold_sload_cost - instr::warm_storage_read_cost;
         if ((gas_left -= additional_cold_sload_cost) < 0)
             return {EVMC_OUT_OF_GAS, gas_left};
     }
@@ -124,12 +137,26 @@ Result sstore(StackTop stack, int64_t gas_left, ExecutionState& state) noexcept
     const auto key = intx::be::store<evmc::bytes32>(stack.pop());
     const auto value = intx::be::store<evmc::bytes32>(stack.pop());
 
+    evmc_storage_status status = {};
+    evmc_access_status access_status = EVMC_ACCESS_WARM;
+    if (state.host_ext != nullptr)
+    {
+        // Single storage lookup in the host.
+        const auto r = state.host_ext->store_storage(
+            state.host_context, &state.msg->recipient, &key, &value);
+        status = r.status;
+        access_status = r.access_status;
+    }
+    else
+    {
+        if (state.rev >= EVMC_BERLIN)
+            access_status = state.host.access_storage(state.msg->recipient, key);
+        status = state.host.set_storage(state.msg->recipient, key, value);
+    }
+
     const auto gas_cost_cold =
-        (state.rev >= EVMC_BERLIN &&
-            state.host.access_storage(state.msg->recipient, key) == EVMC_ACCESS_COLD) ?
-            instr::cold_sload_cost :
-            0;
-    const auto status = state.host.set_storage(state.msg->recipient, key, value);
+        (state.rev >= EVMC_BERLIN && access_status == EVMC_ACCESS_COLD) ? instr::cold_sload_cost :
+                                                                          0;
 
     const auto [gas_cost_warm, gas_refund] = sstore_costs[state.rev][status];
     const auto gas_cost = gas_cost_warm + gas_cost_cold;
@@ -0,0 +1,137 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "tiered_execution.hpp"
+#include "advanced_analysis.hpp"
+#include "advanced_execution.hpp"
+#include "baseline.hpp"
+#include "eof.hpp"
+#include "vm.hpp"
+#include <algorithm>
+#include <string_view>
+
+namespace evmone::tiered
+{
+namespace
+{
+/// Computes the cheap (non-cryptographic) hash of the code.
+size_t hash_code(bytes_view code) noexcept
+{
+    return std::hash<std::string_view>{}(
+        {reinterpret_cast<const char*>(code.data()), code.size()});
+}
+}  // namespace
+
+CodeCache::Entry& CodeCache::get_entry(bytes_view code)
+{
+    const auto hash = hash_code(code);
+    const auto [it, inserted] = m_entries.try_emplace(hash);
+    auto& e = it->second;
+    if (inserted)
+    {
+        m_lru.push_front(hash);
+        e.lru_it = m_lru.begin();
+        if (m_entries.size() > std::max(config.max_tracked_codes, size_t{1}))
+        {
+            m_entries.erase(m_lru.back());
+            m_lru.pop_back();
+            ++m_stats.evictions;
+        }
+        return e;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, e.lru_it);
+    if (!e.code.empty() && !std::ranges::equal(e.code, code))
+    {
+        // The hash collision: the code is tracked from scratch.
+        const auto lru_it = e.lru_it;
+        e = Entry{};
+        e.lru_it = lru_it;
+    }
+    return e;
+}
+
+CodeCache::AnalysisPtr CodeCache::find(bytes_view code, evmc_revision rev) noexcept
+{
+    const auto hash = hash_code(code);
+    const std::lock_guard lock{m_mutex};
+    const auto it = m_entries.find(hash);
+    if (it == m_entries.end())
+        return nullptr;
+    auto& e = it->second;
+    if (e.analyses[rev] == nullptr || !std::ranges::equal(e.code, code))
+        return nullptr;
+
+    m_lru.splice(m_lru.begin(), m_lru, e.lru_it);
+    ++m_stats.advanced_executions;
+    return e.analyses[rev];
+}
+
+bool CodeCache::record_execution(bytes_view code, evmc_revision rev, int64_t gas_used) noexcept
+{
+    const std::lock_guard lock{m_mutex};
+    ++m_stats.baseline_executions;
+
+    auto& e = get_entry(code);
+    ++e.executions;
+    e.gas_used += gas_used;
+    const auto is_hot =
+        e.executions >= config.execution_threshold || e.gas_used >= config.gas_threshold;
+    return is_hot && e.analyses[rev] == nullptr;
+}
+
+void CodeCache::promote(bytes_view code, evmc_revision rev, AnalysisPtr analysis) noexcept
+{
+    const std::lock_guard lock{m_mutex};
+    auto& e = get_entry(code);
+    if (e.analyses[rev] != nullptr)
+        return;  // Promoted concurrently by another thread.
+    if (e.code.empty())
+        e.code.assign(code.begin(), code.end());
+    e.analyses[rev] = std::move(analysis);
+    ++m_stats.promotions;
+}
+
+Stats CodeCache::get_stats() const noexcept
+{
+    const std::lock_guard lock{m_mutex};
+    return m_stats;
+}
+
+evmc_result execute(evmc_vm* c_vm, const evmc_host_interface* host, evmc_host_context* ctx,
+    evmc_revision rev, const evmc_message* msg, const uint8_t* code, size_t code_size) noexcept
+{
+    const auto& vm = *static_cast<VM*>(c_vm);
+    auto* const cache = vm.get_code_cache();
+
+    const bytes_view container{code, code_size};
+
+    // Advanced does not support tracing. The initcode is executed once so it is not tracked.
+    if (cache == nullptr || msg->kind == EVMC_CREATE || msg->kind == EVMC_CREATE2 ||
+        vm.get_tracer(*msg, container) != nullptr)
+        return baseline::execute(c_vm, host, ctx, rev, msg, code, code_size);
+
+    if (const auto analysis = cache->find(container, rev); analysis != nullptr)
+    {
+        const auto data = analysis->eof_header.get_data(container);
+        auto state = std::make_unique<advanced::AdvancedExecutionState>(
+            *msg, rev, *host, ctx, container, data);
+        state->host_ext = vm.get_host_ext(host);
+        return advanced::execute(*state, *analysis);
+    }
+
+    const auto result = baseline::execute(c_vm, host, ctx, rev, msg, code, code_size);
+
+    // EOF code is not valid before Prague and is not worth promoting.
+    if (cache->record_execution(container, rev, msg->gas - result.gas_left) &&
+        (rev >= EVMC_PRAGUE || !is_eof_container(container)))
+    {
+        // The analysis is done without holding the cache lock.
+        cache->promote(container, rev,
+            std::make_shared<const advanced::AdvancedCodeAnalysis>(advanced::analyze(rev, container)));
+    }
+
+    return result;
+}
+}  // namespace evmone::tiered
@@ -0,0 +1,124 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <evmc/evmc.hpp>
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace evmone
+{
+using bytes_view = std::basic_string_view<uint8_t>;
+
+namespace advanced
+{
+struct AdvancedCodeAnalysis;
+}
+
+namespace tiered
+{
+/// The thresholds of the adaptive tier selection.
+///
+/// The code is executed in Baseline until any of the thresholds is reached.
+/// Then the code is promoted to Advanced and its analysis is cached.
+struct Config
+{
+    /// The number of executions of the code after which the code is promoted.
+    uint64_t execution_threshold = 64;
+
+    /// The total gas used by the executions of the code after which the code is promoted.
+    int64_t gas_threshold = 10'000'000;
+
+    /// The max number of distinct codes being tracked.
+    /// When reached, the least recently executed code is evicted (with its analyses).
+    /// At least one code is always tracked.
+    size_t max_tracked_codes = 4096;
+};
+
+/// The statistics of the adaptive tier selection.
+struct Stats
+{
+    /// The number of executions in the Baseline tier.
+    uint64_t baseline_executions = 0;
+
+    /// The number of executions in the Advanced tier, i.e. of promoted codes.
+    uint64_t advanced_executions = 0;
+
+    /// The number of the Advanced analyses created (one per code and revision).
+    uint64_t promotions = 0;
+
+    /// The number of codes evicted because the tracking limit was reached.
+    uint64_t evictions = 0;
+};
+
+/// The per code execution counters and the cache of the promoted code analyses.
+///
+/// The codes are identified by the hash of their content. This is a cheap
+/// non-cryptographic hash so the code of the promoted entry is compared with the copy stored
+/// with its analyses: in case of the hash collision the entry is reset for the new code.
+/// The executions are counted for the code in all revisions, but the analysis is done
+/// per revision.
+///
+/// It is safe to use it from multiple threads executing with the same VM instance.
+class CodeCache
+{
+public:
+    using AnalysisPtr = std::shared_ptr<const advanced::AdvancedCodeAnalysis>;
+
+    Config config;
+
+    /// Returns the cached Advanced analysis of the code for the revision
+    /// or null if not promoted yet.
+    [[nodiscard]] AnalysisPtr find(bytes_view code, evmc_revision rev) noexcept;
+
+    /// Records the Baseline execution of the code in the revision.
+    /// @return  True if the code should be promoted to Advanced for the revision,
+    ///          i.e. it has reached the thresholds and has no analysis for the revision.
+    bool record_execution(bytes_view code, evmc_revision rev, int64_t gas_used) noexcept;
+
+    /// Stores the Advanced analysis of the promoted code for the revision.
+    void promote(bytes_view code, evmc_revision rev, AnalysisPtr analysis) noexcept;
+
+    /// Returns the snapshot of the statistics.
+    [[nodiscard]] Stats get_stats() const noexcept;
+
+private:
+    struct Entry
+    {
+        uint64_t executions = 0;
+        int64_t gas_used = 0;
+
+        /// The copy of the code. Only stored when promoted: to detect the hash collisions.
+        std::vector<uint8_t> code;
+
+        /// The analyses of the promoted code per revision (the analysis depends on it).
+        std::array<AnalysisPtr, EVMC_MAX_REVISION + 1> analyses;
+
+        /// The position in the list of the recently used codes.
+        std::list<size_t>::iterator lru_it;
+    };
+
+    /// Returns the entry of the code (inserting it if missing) and marks it recently used.
+    /// The entry of the different code with the same hash is reset.
+    Entry& get_entry(bytes_view code);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<size_t, Entry> m_entries;
+
+    /// The hashes of the tracked codes, the most recently used first.
+    std::list<size_t> m_lru;
+
+    Stats m_stats;
+};
+
+/// Executes the code in Baseline or in Advanced depending on the code "hotness".
+evmc_result execute(evmc_vm* vm, const evmc_host_interface* host, evmc_host_context* ctx,
+    evmc_revision rev, const evmc_message* msg, const uint8_t* code, size_t code_size) noexcept;
+}  // namespace tiered
+}  // namespace evmone
@@ -4,8 +4,13 @@
 
 #include "tracing.hpp"
 #include "execution_state.hpp"
+#include "instructions_opcodes.hpp"
 #include "instructions_traits.hpp"
+#include <ethash/keccak.hpp>
 #include <evmc/hex.hpp>
+#include <algorithm>
+#include <bit>
+#include <limits>
 #include <stack>
 
 namespace evmone
@@ -66,6 +71,37 @@ public:
 };
 
 
+/// Returns the memory range written by the instruction (the memory offset and size operands).
+/// The stack_top points to the top item and the stack must have enough items.
+std::pair<intx::uint256, intx::uint256> get_memory_write(
+    uint8_t opcode, const intx::uint256* stack_top) noexcept
+{
+    switch (opcode)
+    {
+    case OP_MSTORE:
+        return {stack_top[0], 32};
+    case OP_MSTORE8:
+        return {stack_top[0], 1};
+    case OP_CALLDATACOPY:
+    case OP_CODECOPY:
+    case OP_RETURNDATACOPY:
+    case OP_MCOPY:
+    case OP_DATACOPY:
+        return {stack_top[0], stack_top[-2]};
+    case OP_EXTCODECOPY:
+        return {stack_top[-1], stack_top[-3]};
+    case OP_CALL:
+    case OP_CALLCODE:
+        return {stack_top[-5], stack_top[-6]};
+    case OP_DELEGATECALL:
+    case OP_STATICCALL:
+        return {stack_top[-4], stack_top[-5]};
+    default:
+        return {};
+    }
+}
+
+/// @see create_instruction_tracer()
 class InstructionTracer : public Tracer
 {
     struct Context
@@ -74,12 +110,65 @@ class InstructionTracer : public Tracer
         const uint8_t* const code;  ///< Reference to the code being executed.
         const int64_t start_gas;
 
+        /// The memory range written by the previous instruction. Empty if none.
+        uint64_t mem_write_offset = 0;
+        uint64_t mem_write_size = 0;
+
+        /// The storage slot written by the previous instruction.
+        std::optional<std::pair<intx::uint256, intx::uint256>> storage_write;
+
         Context(int32_t d, const uint8_t* c, int64_t g) noexcept : depth{d}, code{c}, start_gas{g}
         {}
     };
 
     std::stack<Context> m_contexts;
     std::ostream& m_out;  ///< Output stream.
+    const InstructionTraceOptions m_options;
+
+    /// Outputs the memory written by the previous instruction
+    /// and remembers the range to be written by the current one.
+    void output_memory_write(Context& ctx, uint8_t opcode, const intx::uint256* stack_top,
+        int stack_height, const ExecutionState& state)
+    {
+        // The range may be outside the memory if the instruction has failed.
+        if (ctx.mem_write_size != 0 && ctx.mem_write_offset <= state.memory.size() &&
+            ctx.mem_write_size <= state.memory.size() - ctx.mem_write_offset)
+        {
+            m_out << R"(,"memWrite":{"offset":)" << std::dec << ctx.mem_write_offset;
+            m_out << R"(,"data":"0x)"
+                  << evmc::hex({state.memory.data() + ctx.mem_write_offset, ctx.mem_write_size})
+                  << "\"}";
+        }
+        ctx.mem_write_size = 0;
+
+        // Stack underflow is checked before anything is written.
+        if (stack_height < instr::traits[opcode].stack_height_required)
+            return;
+        const auto [offset, size] = get_memory_write(opcode, stack_top);
+        if (size != 0 && offset <= std::numeric_limits<uint64_t>::max() &&
+            size <= std::numeric_limits<uint64_t>::max())
+        {
+            ctx.mem_write_offset = static_cast<uint64_t>(offset);
+            ctx.mem_write_size = static_cast<uint64_t>(size);
+        }
+    }
+
+    /// Outputs the storage slot written by the previous instruction
+    /// and remembers the slot to be written by the current one.
+    void output_storage_write(
+        Context& ctx, uint8_t opcode, const intx::uint256* stack_top, int stack_height)
+    {
+        if (ctx.storage_write.has_value())
+        {
+            const auto& [key, value] = *ctx.storage_write;
+            m_out << R"(,"storage":{"0x)" << to_string(key, 16) << R"(":"0x)"
+                  << to_string(value, 16) << "\"}";
+            ctx.storage_write.reset();
+        }
+
+        if (opcode == OP_SSTORE && stack_height >= 2)
+            ctx.storage_write.emplace(stack_top[0], stack_top[-1]);
+    }
 
     void output_stack(const intx::uint256* stack_top, int stack_height)
     {
@@ -104,7 +193,7 @@ class InstructionTracer : public Tracer
     void on_instruction_start(uint32_t pc, const intx::uint256* stack_top, int stack_height,
         int64_t gas, const ExecutionState& state) noexcept override
     {
-        const auto& ctx = m_contexts.top();
+        auto& ctx = m_contexts.top();
 
         const auto opcode = ctx.code[pc];
         m_out << "{";
@@ -113,9 +202,13 @@ class InstructionTracer : public Tracer
         m_out << R"(,"gas":"0x)" << std::hex << gas << '"';
         m_out << R"(,"gasCost":"0x)" << std::hex << instr::gas_costs[state.rev][opcode] << '"';
 
-        // Full memory can be dumped as evmc::hex({state.memory.data(), state.memory.size()}),
-        // but this should not be done by default. Adding --tracing=+memory option would be nice.
+        // Full memory is not dumped because this is O(memory size) per instruction.
+        // With the memory option only the memory writes are reported.
         m_out << R"(,"memSize":)" << std::dec << state.memory.size();
+        if (m_options.memory)
+            output_memory_write(ctx, opcode, stack_top, stack_height, state);
+        if (m_options.storage)
+            output_storage_write(ctx, opcode, stack_top, stack_height);
 
         output_stack(stack_top, stack_height);
         if (!state.return_data.empty())
@@ -130,20 +223,65 @@ class InstructionTracer : public Tracer
     void on_execution_end(const evmc_result& /*result*/) noexcept override { m_contexts.pop(); }
 
 public:
-    explicit InstructionTracer(std::ostream& out) noexcept : m_out{out}
+    InstructionTracer(std::ostream& out, InstructionTraceOptions options) noexcept
+      : m_out{out}, m_options{options}
     {
         m_out << std::dec;  // Set number formatting to dec, JSON does not support other forms.
     }
 };
 }  // namespace
 
+bool TraceFilter::matches(const evmc_message& msg, bytes_view code) const noexcept
+{
+    if (msg.depth < min_depth || msg.depth > max_depth)
+        return false;
+
+    if (code_address.has_value() && msg.code_address != *code_address)
+        return false;
+
+    if (selector.has_value() &&
+        (msg.input_size < selector->size() ||
+            !std::equal(selector->begin(), selector->end(), msg.input_data)))
+        return false;
+
+    // The code hash is checked last because it is the most expensive.
+    return !code_hash.has_value() || matches_code_hash(code);
+}
+
+bool TraceFilter::matches_code_hash(bytes_view code) const noexcept
+{
+    auto& checked = m_checked_codes;
+    const std::lock_guard lock{checked.mutex};
+    if (checked.code_hash != *code_hash)
+    {
+        checked.code_hash = *code_hash;
+        checked.matching.reset();
+        checked.last_mismatching.reset();
+    }
+
+    // No other code can have the same hash as the matching one.
+    if (checked.matching.has_value())
+        return code == *checked.matching;
+    if (checked.last_mismatching.has_value() && code == *checked.last_mismatching)
+        return false;
+
+    if (std::bit_cast<evmc::bytes32>(ethash::keccak256(code.data(), code.size())) == *code_hash)
+    {
+        checked.matching.emplace(code);
+        return true;
+    }
+    checked.last_mismatching.emplace(code);
+    return false;
+}
+
 std::unique_ptr<Tracer> create_histogram_tracer(std::ostream& out)
 {
     return std::make_unique<HistogramTracer>(out);
 }
 
-std::unique_ptr<Tracer> create_instruction_tracer(std::ostream& out)
+std::unique_ptr<Tracer> create_instruction_tracer(
+    std::ostream& out, InstructionTraceOptions options)
 {
-    return std::make_unique<InstructionTracer>(out);
+    return std::make_unique<InstructionTracer>(out, options);
 }
 }  // namespace evmone
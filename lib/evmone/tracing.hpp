@@ -3,19 +3,66 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma once
 
-#include <evmc/evmc.h>
+#include <evmc/evmc.hpp>
 #include <evmc/utils.h>
 #include <intx/intx.hpp>
+#include <array>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <ostream>
+#include <string>
 #include <string_view>
 
 namespace evmone
 {
+using bytes = std::basic_string<uint8_t>;
 using bytes_view = std::basic_string_view<uint8_t>;
 
 class ExecutionState;
 
+/// The filter selecting the execution frames to be traced. The default filter matches all frames.
+///
+/// The frames not matching the filter are executed without tracing (the tracers are not
+/// notified about them at all), so the cost of tracing is only paid for the selected frames.
+struct TraceFilter
+{
+    /// The code address of the frame (evmc_message::code_address).
+    std::optional<evmc::address> code_address;
+
+    /// The Keccak-256 hash of the code of the frame.
+    std::optional<evmc::bytes32> code_hash;
+
+    /// The depth range of the frame (inclusive).
+    int32_t min_depth = 0;
+    int32_t max_depth = std::numeric_limits<int32_t>::max();
+
+    /// The function selector: the first 4 bytes of the input of the frame.
+    std::optional<std::array<uint8_t, 4>> selector;
+
+    /// Checks if the execution frame of the message and the code is selected for tracing.
+    [[nodiscard]] EVMC_EXPORT bool matches(
+        const evmc_message& msg, bytes_view code) const noexcept;
+
+private:
+    /// The codes already checked against the code_hash so the code of every frame
+    /// is not hashed again: the code having the code_hash (only this one can match)
+    /// and the last code not having it.
+    struct CheckedCodes
+    {
+        std::mutex mutex;
+        evmc::bytes32 code_hash;  ///< The code_hash the codes have been checked against.
+        std::optional<bytes> matching;
+        std::optional<bytes> last_mismatching;
+    };
+
+    mutable CheckedCodes m_checked_codes;
+
+    /// Checks if the code has the code_hash.
+    [[nodiscard]] bool matches_code_hash(bytes_view code) const noexcept;
+};
+
 class Tracer
 {
     friend class VM;  // Has access the m_next_tracer to traverse the list forward.
@@ -63,6 +110,23 @@ private:
 /// @return     Histogram tracer object.
 EVMC_EXPORT std::unique_ptr<Tracer> create_histogram_tracer(std::ostream& out);
 
-EVMC_EXPORT std::unique_ptr<Tracer> create_instruction_tracer(std::ostream& out);
+/// The optional parts of the instruction trace.
+struct InstructionTraceOptions
+{
+    /// Output the memory written by the previous instruction ("memWrite").
+    bool memory = false;
+
+    /// Output the storage slot written by the previous instruction ("storage").
+    bool storage = false;
+};
+
+/// Creates the instruction tracer which outputs the execution trace in the JSON Lines format
+/// (EIP-3155).
+///
+/// The optional memory and storage outputs are the deltas: only the memory range
+/// and the storage slot written by the previous instruction of the frame are reported.
+/// This keeps the trace size proportional to the writes instead of the memory size.
+EVMC_EXPORT std::unique_ptr<Tracer> create_instruction_tracer(
+    std::ostream& out, InstructionTraceOptions options = {});
 
 }  // namespace evmone
@@ -8,14 +8,27 @@
 #include "vm.hpp"
 #include "advanced_execution.hpp"
 #include "baseline.hpp"
+#include "tiered_execution.hpp"
+#include <evmc/hex.hpp>
 #include <evmone/evmone.h>
+#include <algorithm>
 #include <cassert>
+#include <charconv>
 #include <iostream>
 
 namespace evmone
 {
 namespace
 {
+/// Parses the decimal option value.
+template <typename T>
+bool parse_option_value(std::string_view value, T& out) noexcept
+{
+    const auto end = value.data() + value.size();
+    const auto [ptr, ec] = std::from_chars(value.data(), end, out);
+    return ec == std::errc{} && ptr == end;
+}
+
 void destroy(evmc_vm* vm) noexcept
 {
     assert(vm != nullptr);
@@ -51,9 +64,44 @@ evmc_set_option_result set_option(evmc_vm* c_vm, char const* c_name, char const*
         return EVMC_SET_OPTION_INVALID_NAME;
 #endif
     }
+    else if (name == "adaptive")
+    {
+        // The optional value is the execution threshold of promoting the code to Advanced.
+        auto threshold = tiered::Config{}.execution_threshold;
+        if (!value.empty() && !parse_option_value(value, threshold))
+            return EVMC_SET_OPTION_INVALID_VALUE;
+        vm.enable_tiering().config.execution_threshold = threshold;
+        c_vm->execute = evmone::tiered::execute;
+        return EVMC_SET_OPTION_SUCCESS;
+    }
+    else if (name == "adaptive_gas")
+    {
+        auto* const cache = vm.get_code_cache();
+        if (cache == nullptr)
+            return EVMC_SET_OPTION_INVALID_NAME;
+        int64_t threshold = 0;
+        if (!parse_option_value(value, threshold) || threshold < 0)
+            return EVMC_SET_OPTION_INVALID_VALUE;
+        cache->config.gas_threshold = threshold;
+        return EVMC_SET_OPTION_SUCCESS;
+    }
+    else if (name == "host_ext")
+    {
+        vm.host_ext = true;
+        return EVMC_SET_OPTION_SUCCESS;
+    }
+    else if (name == "predecode_push")
+    {
+        vm.predecode_push = true;
+        return EVMC_SET_OPTION_SUCCESS;
+    }
     else if (name == "trace")
     {
-        vm.add_tracer(create_instruction_tracer(std::clog));
+        // The value may enable the optional trace outputs, e.g. "+memory+storage".
+        InstructionTraceOptions options;
+        options.memory = value.find("+memory") != std::string_view::npos;
+        options.storage = value.find("+storage") != std::string_view::npos;
+        vm.add_tracer(create_instruction_tracer(std::clog, options));
         return EVMC_SET_OPTION_SUCCESS;
     }
     else if (name == "histogram")
@@ -61,6 +109,46 @@ evmc_set_option_result set_option(evmc_vm* c_vm, char const* c_name, char const*
         vm.add_tracer(create_histogram_tracer(std::clog));
         return EVMC_SET_OPTION_SUCCESS;
     }
+    else if (name == "trace_address")
+    {
+        const auto addr = evmc::from_hex<evmc::address>(value);
+        if (!addr.has_value())
+            return EVMC_SET_OPTION_INVALID_VALUE;
+        vm.trace_filter.code_address = *addr;
+        return EVMC_SET_OPTION_SUCCESS;
+    }
+    else if (name == "trace_code_hash")
+    {
+        const auto hash = evmc::from_hex<evmc::bytes32>(value);
+        if (!hash.has_value())
+            return EVMC_SET_OPTION_INVALID_VALUE;
+        vm.trace_filter.code_hash = *hash;
+        return EVMC_SET_OPTION_SUCCESS;
+    }
+    else if (name == "trace_depth")
+    {
+        // The value is the depth or the inclusive range of depths "min:max".
+        const auto sep = value.find(':');
+        int32_t min_depth = 0;
+        int32_t max_depth = 0;
+        if (!parse_option_value(value.substr(0, sep), min_depth) ||
+            !parse_option_value(
+                sep != std::string_view::npos ? value.substr(sep + 1) : value, max_depth) ||
+            min_depth < 0 || min_depth > max_depth)
+            return EVMC_SET_OPTION_INVALID_VALUE;
+        vm.trace_filter.min_depth = min_depth;
+        vm.trace_filter.max_depth = max_depth;
+        return EVMC_SET_OPTION_SUCCESS;
+    }
+    else if (name == "trace_selector")
+    {
+        const auto selector = evmc::from_hex(value);
+        if (!selector.has_value() || selector->size() != 4)
+            return EVMC_SET_OPTION_INVALID_VALUE;
+        vm.trace_filter.selector.emplace();
+        std::copy_n(selector->data(), 4, vm.trace_filter.selector->data());
+        return EVMC_SET_OPTION_SUCCESS;
+    }
     return EVMC_SET_OPTION_INVALID_NAME;
 }
 
@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma once
 
+#include "host_ext.hpp"
+#include "tiered_execution.hpp"
 #include "tracing.hpp"
 #include <evmc/evmc.h>
 
@@ -20,9 +22,21 @@ class VM : public evmc_vm
 public:
     bool cgoto = EVMONE_CGOTO_SUPPORTED;
 
+    /// The host interface may be evmone::ExtendedHostInterface (see register_host_ext()).
+    bool host_ext = false;
+
+    /// Pre-decode the wide PUSH values in the Baseline code analysis.
+    bool predecode_push = false;
+
+    /// The filter selecting the execution frames to be traced.
+    TraceFilter trace_filter;
+
 private:
     std::unique_ptr<Tracer> m_first_tracer;
 
+    /// The code cache of the adaptive tier selection. Null if not enabled.
+    std::unique_ptr<tiered::CodeCache> m_code_cache;
+
 public:
     inline constexpr VM() noexcept;
 
@@ -36,5 +50,30 @@ public:
     }
 
     [[nodiscard]] Tracer* get_tracer() const noexcept { return m_first_tracer.get(); }
+
+    /// Returns the tracer if the execution frame is selected for tracing by the trace filter.
+    [[nodiscard]] Tracer* get_tracer(const evmc_message& msg, bytes_view code) const noexcept
+    {
+        return (m_first_tracer && trace_filter.matches(msg, code)) ? m_first_tracer.get() :
+                                                                     nullptr;
+    }
+
+    /// Returns the extended host interface if enabled by the "host_ext" option
+    /// and the host interface is the evmc member of a registered extended interface.
+    [[nodiscard]] const ExtendedHostInterface* get_host_ext(
+        const evmc_host_interface* host) const noexcept
+    {
+        return host_ext ? find_host_ext(host) : nullptr;
+    }
+
+    /// Enables the adaptive tier selection (if not enabled yet) and returns its code cache.
+    tiered::CodeCache& enable_tiering() noexcept
+    {
+        if (!m_code_cache)
+            m_code_cache = std::make_unique<tiered::CodeCache>();
+        return *m_code_cache;
+    }
+
+    [[nodiscard]] tiered::CodeCache* get_code_cache() const noexcept { return m_code_cache.get(); }
 };
 }  // namespace evmone
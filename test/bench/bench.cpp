@@ -21,6 +21,7 @@ using namespace benchmark;
 namespace evmone::test
 {
 std::map<std::string_view, evmc::VM> registered_vms;
+BenchHostKind bench_host_kind = BenchHostKind::mocked;
 
 namespace
 {
@@ -61,7 +62,7 @@ BenchmarkCase load_benchmark(const fs::path& path, const std::string& name_prefi
     auto state_test = evmone::test::load_state_test(f);
 
     const auto name = name_prefix + path.stem().string();
-    const auto code = state_test.pre_state.get(state_test.multi_tx.to.value()).code;
+    const auto code = *state_test.pre_state.get(state_test.multi_tx.to.value()).code.load();
     const auto inputs = load_inputs(state_test);
 
     return BenchmarkCase{name, code, inputs};
@@ -119,7 +120,7 @@ void register_benchmarks(std::span<const BenchmarkCase> benchmark_cases)
         {
             RegisterBenchmark(("advanced/analyse/" + b.name).c_str(), [&b](State& state) {
                 bench_analyse<advanced::AdvancedCodeAnalysis, advanced_analyse>(
-                    state, default_revision, b.code);
+                    state, get_benchmark_revision(b.code), b.code);
             })->Unit(kMicrosecond);
         }
 
@@ -127,7 +128,7 @@ void register_benchmarks(std::span<const BenchmarkCase> benchmark_cases)
         {
             RegisterBenchmark(("baseline/analyse/" + b.name).c_str(), [&b](State& state) {
                 bench_analyse<baseline::CodeAnalysis, baseline_analyse>(
-                    state, default_revision, b.code);
+                    state, get_benchmark_revision(b.code), b.code);
             })->Unit(kMicrosecond);
         }
 
@@ -175,6 +176,91 @@ void register_benchmarks(std::span<const BenchmarkCase> benchmark_cases)
 /// The number tries to be different from EVMC loading error codes.
 constexpr auto cli_parsing_error = -3;
 
+/// Parses and removes the evmone-bench specific options from the CLI arguments:
+/// --host=mocked|light|light-cold and --replay=<file> (may be repeated).
+/// @return  False if the option value is invalid.
+bool parse_options(int& argc, char** argv, std::vector<fs::path>& replay_files)
+{
+    static constexpr std::string_view host_prefix = "--host=";
+    static constexpr std::string_view replay_prefix = "--replay=";
+    int j = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg.starts_with(replay_prefix))
+        {
+            replay_files.emplace_back(arg.substr(replay_prefix.size()));
+            continue;
+        }
+        if (!arg.starts_with(host_prefix))
+        {
+            argv[j++] = argv[i];
+            continue;
+        }
+
+        const auto value = arg.substr(host_prefix.size());
+        if (value == "mocked")
+            bench_host_kind = BenchHostKind::mocked;
+        else if (value == "light")
+            bench_host_kind = BenchHostKind::light;
+        else if (value == "light-cold")
+            bench_host_kind = BenchHostKind::light_cold;
+        else
+        {
+            std::cerr << "Invalid host: " << value << "\n";
+            return false;
+        }
+    }
+    argc = j;
+    return true;
+}
+
+/// The recordings loaded from the --replay files and the VMs to replay them with.
+std::vector<state::HostRecording> replay_recordings;
+std::vector<std::pair<std::string, evmc::VM>> replay_vms;
+
+/// Loads the host recordings (as produced by evmone-t8n --record) and registers
+/// the benchmarks replaying them in Advanced and Baseline.
+/// @return  False if any recording cannot be loaded.
+bool register_replay_benchmarks(std::span<const fs::path> replay_files)
+{
+    for (const auto& path : replay_files)
+    {
+        std::ifstream file{path, std::ios::binary};
+        const bytes data(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        auto recording = state::HostRecording::deserialize(data);
+        if (!recording.has_value())
+        {
+            std::cerr << "Invalid host recording: " << path << "\n";
+            return false;
+        }
+        replay_recordings.emplace_back(std::move(*recording));
+    }
+
+    replay_vms.reserve(replay_recordings.size() * 2);
+    for (size_t i = 0; i < replay_recordings.size(); ++i)
+    {
+        const auto& recording = replay_recordings[i];
+        const auto name = replay_files[i].stem().string();
+        for (const auto advanced : {true, false})
+        {
+            // The VM must use the host interface extension iff it was used when recording.
+            evmc::VM vm{evmc_create_evmone()};
+            if (advanced)
+                vm.set_option("advanced", "");
+            if (recording.host_ext)
+                vm.set_option("host_ext", "");
+            auto& [vm_name, replay_vm] = replay_vms.emplace_back(
+                std::string{advanced ? "advanced" : "baseline"} + "/replay/" + name, std::move(vm));
+
+            RegisterBenchmark(vm_name.c_str(), [&vm_ = replay_vm, &recording](State& state) {
+                bench_replay(state, vm_, recording);
+            })->Unit(kMicrosecond);
+        }
+    }
+    return true;
+}
+
 /// Parses evmone-bench CLI arguments and registers benchmark cases.
 ///
 /// The following variants of number arguments are supported (including argv[0]):
@@ -189,6 +275,11 @@ constexpr auto cli_parsing_error = -3;
 ///    Uses evmone VMs, registers custom benchmark with the code from the given file,
 ///    and the given input. The benchmark will compare the output with the provided
 ///    expected one.
+///
+/// Additionally, the --host=mocked|light|light-cold option selects the host the benchmarks
+/// execute with: the evmc::MockedHost (default) or the lightweight BenchHost
+/// with all accesses warm or cold. The --replay=<file> option registers the benchmarks
+/// replaying the host recording from the file.
 std::tuple<int, std::vector<BenchmarkCase>> parseargs(int argc, char** argv)
 {
     // Arguments' placeholders:
@@ -264,6 +355,9 @@ int main(int argc, char** argv)
     try
     {
         Initialize(&argc, argv);  // Consumes --benchmark_ options.
+        std::vector<fs::path> replay_files;
+        if (!parse_options(argc, argv, replay_files))
+            return cli_parsing_error;
         const auto [ec, benchmark_cases] = parseargs(argc, argv);
         if (ec == cli_parsing_error && ReportUnrecognizedArguments(argc, argv))
             return ec;
@@ -274,8 +368,11 @@ int main(int argc, char** argv)
         registered_vms["advanced"] = evmc::VM{evmc_create_evmone(), {{"advanced", ""}}};
         registered_vms["baseline"] = evmc::VM{evmc_create_evmone()};
         registered_vms["bnocgoto"] = evmc::VM{evmc_create_evmone(), {{"cgoto", "no"}}};
+        registered_vms["bpredecode"] = evmc::VM{evmc_create_evmone(), {{"predecode_push", ""}}};
         register_benchmarks(benchmark_cases);
         register_synthetic_benchmarks();
+        if (!register_replay_benchmarks(replay_files))
+            return cli_parsing_error;
         RunSpecifiedBenchmarks();
         return 0;
     }
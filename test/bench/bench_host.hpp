@@ -0,0 +1,173 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <evmc/evmc.hpp>
+#include <array>
+
+namespace evmone::test
+{
+/// The lightweight host for benchmarking.
+///
+/// Unlike evmc::MockedHost it does not record calls, logs and accesses so it does not allocate
+/// memory during execution. The storage is a fixed-size open addressing hash table shared
+/// by all accounts (benchmarks execute single contracts). When the table is full, new slots
+/// are not stored and read as zero.
+class BenchHost : public evmc::Host
+{
+public:
+    /// The access status reported for all accounts and storage slots.
+    enum class AccessMode
+    {
+        warm,
+        cold
+    };
+
+private:
+    /// The fixed-size bytes32 -> bytes32 map with linear probing.
+    class FixedTable
+    {
+        static constexpr size_t capacity = 4096;  // Must be power of 2.
+
+        struct Entry
+        {
+            evmc::bytes32 key;
+            evmc::bytes32 value;
+            bool used = false;
+        };
+
+        std::array<Entry, capacity> m_entries{};
+
+        /// Returns the index of the entry for the key or of the empty entry to insert the key to.
+        /// Returns the capacity if the key is not present and the table is full.
+        [[nodiscard]] size_t find(const evmc::bytes32& key) const noexcept
+        {
+            const auto h = std::hash<evmc::bytes32>{}(key);
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                const auto index = (h + i) & (capacity - 1);
+                if (const auto& e = m_entries[index]; !e.used || e.key == key)
+                    return index;
+            }
+            return capacity;
+        }
+
+    public:
+        [[nodiscard]] evmc::bytes32 get(const evmc::bytes32& key) const noexcept
+        {
+            const auto index = find(key);
+            return (index != capacity && m_entries[index].used) ? m_entries[index].value :
+                                                                  evmc::bytes32{};
+        }
+
+        /// Stores the value and returns the previous one.
+        evmc::bytes32 set(const evmc::bytes32& key, const evmc::bytes32& value) noexcept
+        {
+            const auto index = find(key);
+            if (index == capacity)
+                return {};
+            auto& e = m_entries[index];
+            const auto prev = e.used ? e.value : evmc::bytes32{};
+            e = {key, value, true};
+            return prev;
+        }
+    };
+
+    AccessMode m_access_mode;
+    FixedTable m_storage;
+    FixedTable m_transient_storage;
+
+public:
+    evmc_tx_context tx_context{};
+
+    explicit BenchHost(AccessMode access_mode = AccessMode::warm) noexcept
+      : m_access_mode{access_mode}
+    {}
+
+    bool account_exists(const evmc::address& /*addr*/) const noexcept override { return true; }
+
+    evmc::bytes32 get_storage(
+        const evmc::address& /*addr*/, const evmc::bytes32& key) const noexcept override
+    {
+        return m_storage.get(key);
+    }
+
+    /// Sets the storage value. The original value of the slot is not tracked:
+    /// the status is computed as if the current value was the original one.
+    evmc_storage_status set_storage(const evmc::address& /*addr*/, const evmc::bytes32& key,
+        const evmc::bytes32& value) noexcept override
+    {
+        const auto prev = m_storage.set(key, value);
+        if (prev == value)
+            return EVMC_STORAGE_ASSIGNED;
+        if (evmc::is_zero(prev))
+            return EVMC_STORAGE_ADDED;
+        if (evmc::is_zero(value))
+            return EVMC_STORAGE_DELETED;
+        return EVMC_STORAGE_MODIFIED;
+    }
+
+    evmc::uint256be get_balance(const evmc::address& /*addr*/) const noexcept override
+    {
+        return {};
+    }
+
+    size_t get_code_size(const evmc::address& /*addr*/) const noexcept override { return 0; }
+
+    evmc::bytes32 get_code_hash(const evmc::address& /*addr*/) const noexcept override
+    {
+        return {};
+    }
+
+    size_t copy_code(const evmc::address& /*addr*/, size_t /*code_offset*/,
+        uint8_t* /*buffer_data*/, size_t /*buffer_size*/) const noexcept override
+    {
+        return 0;
+    }
+
+    bool selfdestruct(
+        const evmc::address& /*addr*/, const evmc::address& /*beneficiary*/) noexcept override
+    {
+        return false;
+    }
+
+    /// Calls always succeed without output and return all the gas.
+    evmc::Result call(const evmc_message& msg) noexcept override
+    {
+        return evmc::Result{EVMC_SUCCESS, msg.gas};
+    }
+
+    evmc_tx_context get_tx_context() const noexcept override { return tx_context; }
+
+    evmc::bytes32 get_block_hash(int64_t /*block_number*/) const noexcept override { return {}; }
+
+    /// Logs are discarded.
+    void emit_log(const evmc::address& /*addr*/, const uint8_t* /*data*/, size_t /*data_size*/,
+        const evmc::bytes32 /*topics*/[], size_t /*num_topics*/) noexcept override
+    {}
+
+    evmc_access_status access_account(const evmc::address& /*addr*/) noexcept override
+    {
+        return m_access_mode == AccessMode::cold ? EVMC_ACCESS_COLD : EVMC_ACCESS_WARM;
+    }
+
+    evmc_access_status access_storage(
+        const evmc::address& /*addr*/, const evmc::bytes32& /*key*/) noexcept override
+    {
+        return m_access_mode == AccessMode::cold ? EVMC_ACCESS_COLD : EVMC_ACCESS_WARM;
+    }
+
+    evmc::bytes32 get_transient_storage(
+        const evmc::address& /*addr*/, const evmc::bytes32& key) const noexcept override
+    {
+        return m_transient_storage.get(key);
+    }
+
+    void set_transient_storage(const evmc::address& /*addr*/, const evmc::bytes32& key,
+        const evmc::bytes32& value) noexcept override
+    {
+        m_transient_storage.set(key, value);
+    }
+};
+}  // namespace evmone::test
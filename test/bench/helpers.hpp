@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma once
 
+#include "bench_host.hpp"
+#include "test/state/host_recording.hpp"
 #include "test/utils/utils.hpp"
 #include <benchmark/benchmark.h>
 #include <evmc/evmc.hpp>
@@ -12,14 +14,46 @@
 #include <evmone/baseline.hpp>
 #include <evmone/eof.hpp>
 #include <evmone/vm.hpp>
+#include <memory>
 
 namespace evmone::test
 {
 extern std::map<std::string_view, evmc::VM> registered_vms;
 
+/// The kind of the host the benchmarks execute with.
+enum class BenchHostKind
+{
+    mocked,      ///< evmc::MockedHost recording all host calls.
+    light,       ///< BenchHost with all accesses warm.
+    light_cold,  ///< BenchHost with all accesses cold.
+};
+
+/// The host kind selected with the --host option.
+extern BenchHostKind bench_host_kind;
+
+/// Creates the host of the selected kind.
+inline std::unique_ptr<evmc::Host> create_bench_host()
+{
+    switch (bench_host_kind)
+    {
+    case BenchHostKind::light:
+        return std::make_unique<BenchHost>(BenchHost::AccessMode::warm);
+    case BenchHostKind::light_cold:
+        return std::make_unique<BenchHost>(BenchHost::AccessMode::cold);
+    default:
+        return std::make_unique<evmc::MockedHost>();
+    }
+}
+
 constexpr auto default_revision = EVMC_ISTANBUL;
 constexpr auto default_gas_limit = std::numeric_limits<int64_t>::max();
 
+/// Returns the revision to benchmark the code with: EOF containers require Prague.
+inline evmc_revision get_benchmark_revision(bytes_view code) noexcept
+{
+    return is_eof_container(code) ? EVMC_PRAGUE : default_revision;
+}
+
 
 template <typename ExecutionStateT, typename AnalysisT>
 using ExecuteFn = evmc::Result(evmc::VM& vm, ExecutionStateT& exec_state, const AnalysisT&,
@@ -45,6 +79,16 @@ inline baseline::CodeAnalysis baseline_analyse(evmc_revision rev, bytes_view cod
     return baseline::analyze(rev, code);
 }
 
+inline baseline::CodeAnalysis baseline_analyse_lazy(evmc_revision rev, bytes_view code)
+{
+    return baseline::analyze(rev, code, true);
+}
+
+inline baseline::CodeAnalysis baseline_analyse_predecode(evmc_revision rev, bytes_view code)
+{
+    return baseline::analyze(rev, code, false, true);
+}
+
 inline FakeCodeAnalysis evmc_analyse(evmc_revision /*rev*/, bytes_view /*code*/)
 {
     return {};
@@ -55,7 +99,8 @@ inline evmc::Result advanced_execute(evmc::VM& /*vm*/, advanced::AdvancedExecuti
     const advanced::AdvancedCodeAnalysis& analysis, const evmc_message& msg, evmc_revision rev,
     evmc::Host& host, bytes_view code)
 {
-    exec_state.reset(msg, rev, host.get_interface(), host.to_context(), code, {});
+    exec_state.reset(msg, rev, host.get_interface(), host.to_context(), code,
+        analysis.eof_header.get_data(code));
     return evmc::Result{execute(exec_state, analysis)};
 }
 
@@ -64,7 +109,8 @@ inline evmc::Result baseline_execute(evmc::VM& c_vm, ExecutionState& exec_state,
     evmc::Host& host, bytes_view code)
 {
     const auto& vm = *static_cast<evmone::VM*>(c_vm.get_raw_pointer());
-    exec_state.reset(msg, rev, host.get_interface(), host.to_context(), code, {});
+    exec_state.reset(msg, rev, host.get_interface(), host.to_context(), code,
+        analysis.eof_header.get_data(code));
     return evmc::Result{baseline::execute(vm, msg.gas, exec_state, analysis)};
 }
 
@@ -94,18 +140,20 @@ inline void bench_analyse(benchmark::State& state, evmc_revision rev, bytes_view
 
 
 template <typename ExecutionStateT, typename AnalysisT,
-    ExecuteFn<ExecutionStateT, AnalysisT> execute_fn, AnalyseFn<AnalysisT> analyse_fn>
+    ExecuteFn<ExecutionStateT, AnalysisT> execute_fn, AnalyseFn<AnalysisT> analyse_fn,
+    evmc_call_kind kind = EVMC_CALL>
 inline void bench_execute(benchmark::State& state, evmc::VM& vm, bytes_view code, bytes_view input,
     bytes_view expected_output) noexcept
 {
-    constexpr auto rev = default_revision;
+    const auto rev = get_benchmark_revision(code);
     constexpr auto gas_limit = default_gas_limit;
 
     const auto analysis = analyse_fn(rev, code);
-    evmc::MockedHost host;
+    const auto host_ptr = create_bench_host();  // Heap-allocated: BenchHost is big.
+    auto& host = *host_ptr;
     ExecutionStateT exec_state;
     evmc_message msg{};
-    msg.kind = EVMC_CALL;
+    msg.kind = kind;
     msg.gas = gas_limit;
     msg.input_data = input.data();
     msg.input_size = input.size();
@@ -152,6 +200,9 @@ constexpr auto bench_advanced_execute = bench_execute<advanced::AdvancedExecutio
 constexpr auto bench_baseline_execute =
     bench_execute<ExecutionState, baseline::CodeAnalysis, baseline_execute, baseline_analyse>;
 
+constexpr auto bench_baseline_predecode_execute = bench_execute<ExecutionState,
+    baseline::CodeAnalysis, baseline_execute, baseline_analyse_predecode>;
+
 inline void bench_evmc_execute(benchmark::State& state, evmc::VM& vm, bytes_view code,
     bytes_view input = {}, bytes_view expected_output = {})
 {
@@ -159,4 +210,46 @@ inline void bench_evmc_execute(benchmark::State& state, evmc::VM& vm, bytes_view
         state, vm, code, input, expected_output);
 }
 
+/// Benchmarks the execution of the recorded message with the host replaying the recording.
+inline void bench_replay(
+    benchmark::State& state, evmc::VM& vm, const evmone::state::HostRecording& recording)
+{
+    evmone::state::ReplayHost host{recording};
+    const auto& host_interface = evmone::state::ReplayHost::get_extended_interface().evmc;
+    const auto msg = recording.message();
+    const auto& code = recording.code;
+
+    {  // Test run.
+        const auto r =
+            vm.execute(host_interface, host.to_context(), recording.rev, msg, code.data(), code.size());
+        if (host.diverged() || !host.finished())
+        {
+            state.SkipWithError("replay diverged from the recording");
+            return;
+        }
+        benchmark::DoNotOptimize(r.gas_left);
+    }
+
+    auto total_gas_used = int64_t{0};
+    auto iteration_gas_used = int64_t{0};
+    for (auto _ : state)
+    {
+        host.reset();
+        const auto r =
+            vm.execute(host_interface, host.to_context(), recording.rev, msg, code.data(), code.size());
+        iteration_gas_used = msg.gas - r.gas_left;
+        total_gas_used += iteration_gas_used;
+    }
+
+    using benchmark::Counter;
+    state.counters["gas_used"] = Counter(static_cast<double>(iteration_gas_used));
+    state.counters["gas_rate"] = Counter(static_cast<double>(total_gas_used), Counter::kIsRate);
+}
+
+/// Benchmarks the execution of the initcode (the code of the creation message).
+inline void bench_evmc_create(benchmark::State& state, evmc::VM& vm, bytes_view initcode)
+{
+    bench_execute<FakeExecutionState, FakeCodeAnalysis, evmc_execute, evmc_analyse, EVMC_CREATE>(
+        state, vm, initcode, {}, {});
+}
 }  // namespace evmone::test
@@ -217,6 +217,28 @@ bytes_view generate_code(CodeParams params)
     code = generate_loop_v2(generate_loop_inner_code(params));  // Cache it.
     return code;
 }
+
+/// Generates the initcode of the max size allowed by EIP-3860 (48 KiB).
+///
+/// The initcode is executed linearly: it copies the runtime code (a long sequence of basic blocks)
+/// to memory and returns it. This represents a typical contract deployment.
+bytes_view generate_initcode()
+{
+    static bytecode code;
+    if (!code.empty())
+        return code;
+
+    constexpr auto runtime_size = uint64_t{48 * 1024 - 14};
+    const auto prefix = [](uint64_t runtime_offset) {
+        return push(runtime_size) + push(runtime_offset) + push(0) + OP_CODECOPY +
+               ret(0, runtime_size);
+    };
+    const auto runtime_offset = prefix(0).size();
+    code = prefix(runtime_offset) +
+           static_cast<int>(runtime_size / 4) * (OP_JUMPDEST + push(1) + OP_POP);
+    code.resize(runtime_offset + runtime_size, OP_JUMPDEST);  // Cache it.
+    return code;
+}
 }  // namespace
 
 void register_synthetic_benchmarks()
@@ -262,6 +284,21 @@ void register_synthetic_benchmarks()
             [&vm_ = vm](State& state) { bench_evmc_execute(state, vm_, generate_loop_v2({})); });
     }
 
+    RegisterBenchmark("baseline/analyse/synth/initcode", [](State& state) {
+        bench_analyse<baseline::CodeAnalysis, baseline_analyse>(
+            state, default_revision, generate_initcode());
+    })->Unit(kMicrosecond);
+    RegisterBenchmark("baseline/analyse_lazy/synth/initcode", [](State& state) {
+        bench_analyse<baseline::CodeAnalysis, baseline_analyse_lazy>(
+            state, default_revision, generate_initcode());
+    })->Unit(kMicrosecond);
+    for (auto& [vm_name, vm] : registered_vms)
+    {
+        RegisterBenchmark((std::string{vm_name} + "/total/synth/initcode").c_str(),
+            [&vm_ = vm](State& state) { bench_evmc_create(state, vm_, generate_initcode()); })
+            ->Unit(kMicrosecond);
+    }
+
     for (const auto params : params_list)
     {
         for (auto& [vm_name, vm] : registered_vms)
@@ -272,5 +309,26 @@ void register_synthetic_benchmarks()
                 ->Unit(kMicrosecond);
         }
     }
+
+    // PUSH with and without the pre-decoded values, excluding the code analysis.
+    if (const auto it = registered_vms.find("baseline"); it != registered_vms.end())
+    {
+        for (const auto params : params_list)
+        {
+            if (get_instruction_category(params.opcode) != InstructionCategory::push)
+                continue;
+
+            RegisterBenchmark(("baseline/execute/synth/" + to_string(params)).c_str(),
+                [&vm = it->second, params](State& state) {
+                    bench_baseline_execute(state, vm, generate_code(params), {}, {});
+                })
+                ->Unit(kMicrosecond);
+            RegisterBenchmark(("bpredecode/execute/synth/" + to_string(params)).c_str(),
+                [&vm = it->second, params](State& state) {
+                    bench_baseline_predecode_execute(state, vm, generate_code(params), {}, {});
+                })
+                ->Unit(kMicrosecond);
+        }
+    }
 }
 }  // namespace evmone::test
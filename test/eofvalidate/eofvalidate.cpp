@@ -0,0 +1,203 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+/// The batch EOF validator.
+///
+/// Validates the corpus of EOF containers (one hex-encoded container per line,
+/// empty lines and lines starting with # are skipped) in parallel and reports
+/// the throughput and the histogram of the validation errors.
+///
+/// Usage: evmone-eofvalidate [--fork <fork>] [--threads <n>] <corpus-file>
+
+#include <evmone/eof.hpp>
+#include <test/utils/utils.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using evmone::EOFValidationError;
+
+constexpr auto num_errors = static_cast<size_t>(EOFValidationError::impossible) + 1;
+
+/// The number of the corpus lines processed by a worker at once.
+constexpr size_t chunk_size = 64;
+
+struct Stats
+{
+    size_t num_containers = 0;
+    size_t num_bytes = 0;
+    size_t num_invalid_hex = 0;
+
+    /// The number of containers per validation result.
+    std::array<size_t, num_errors> results{};
+
+    Stats& operator+=(const Stats& other) noexcept
+    {
+        num_containers += other.num_containers;
+        num_bytes += other.num_bytes;
+        num_invalid_hex += other.num_invalid_hex;
+        for (size_t i = 0; i < num_errors; ++i)
+            results[i] += other.results[i];
+        return *this;
+    }
+};
+
+/// Runs the worker on the given number of threads (including the calling thread)
+/// and returns the sum of their statistics.
+template <typename WorkerFn>
+Stats run_workers(unsigned num_threads, WorkerFn worker)
+{
+    std::vector<std::future<Stats>> futures;
+    for (unsigned i = 1; i < num_threads; ++i)
+        futures.emplace_back(std::async(std::launch::async, worker));
+
+    auto stats = worker();
+    for (auto& f : futures)
+        stats += f.get();
+    return stats;
+}
+
+/// Returns the next chunk [begin, end) of n items to be processed.
+std::pair<size_t, size_t> next_chunk(std::atomic<size_t>& next, size_t n) noexcept
+{
+    const auto begin = std::min(next.fetch_add(chunk_size, std::memory_order_relaxed), n);
+    return {begin, std::min(begin + chunk_size, n)};
+}
+
+std::optional<bytes> decode(std::string_view line) noexcept
+{
+    if (line.starts_with("0x"))
+        line.remove_prefix(2);
+    return from_spaced_hex(line);
+}
+}  // namespace
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        evmc_revision rev = EVMC_PRAGUE;
+        unsigned num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        std::string corpus_file;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg{argv[i]};
+            if (arg == "--fork" && ++i < argc)
+                rev = evmone::test::to_rev(argv[i]);
+            else if (arg == "--threads" && ++i < argc)
+                num_threads = std::max(static_cast<unsigned>(std::stoul(argv[i])), 1u);
+            else
+                corpus_file = arg;
+        }
+
+        if (corpus_file.empty())
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--fork <fork>] [--threads <n>] <corpus-file>\n";
+            return 2;
+        }
+
+        std::ifstream in{corpus_file};
+        if (!in)
+            throw std::runtime_error{"cannot open " + corpus_file};
+
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);)
+        {
+            if (!line.empty() && !line.starts_with('#'))
+                lines.emplace_back(std::move(line));
+        }
+
+        // Decode the containers. The invalid hex lines remain empty and are skipped.
+        std::vector<std::optional<bytes>> containers(lines.size());
+        std::atomic<size_t> next_decode = 0;
+        const auto decode_stats = run_workers(num_threads, [&] {
+            Stats local;
+            while (true)
+            {
+                const auto [begin, end] = next_chunk(next_decode, lines.size());
+                if (begin == end)
+                    return local;
+                for (auto i = begin; i != end; ++i)
+                {
+                    containers[i] = decode(lines[i]);
+                    local.num_invalid_hex += !containers[i].has_value();
+                }
+            }
+        });
+        lines = {};
+
+        // Validate the containers. Only this phase is timed.
+        std::atomic<size_t> next_validate = 0;
+        const auto start_time = std::chrono::steady_clock::now();
+        auto stats = run_workers(num_threads, [&] {
+            Stats local;
+            while (true)
+            {
+                const auto [begin, end] = next_chunk(next_validate, containers.size());
+                if (begin == end)
+                    return local;
+                for (auto i = begin; i != end; ++i)
+                {
+                    if (!containers[i].has_value())
+                        continue;
+                    const auto& container = *containers[i];
+                    const auto err = evmone::validate_eof(rev, container);
+                    ++local.results[static_cast<size_t>(err)];
+                    ++local.num_containers;
+                    local.num_bytes += container.size();
+                }
+            }
+        });
+        const auto duration =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        stats.num_invalid_hex = decode_stats.num_invalid_hex;
+
+        const auto num_valid = stats.results[static_cast<size_t>(EOFValidationError::success)];
+        std::cout << "containers: " << stats.num_containers << "\n"
+                  << "valid: " << num_valid << "\n"
+                  << "invalid: " << stats.num_containers - num_valid << "\n"
+                  << "invalid hex: " << stats.num_invalid_hex << "\n"
+                  << "bytes: " << stats.num_bytes << "\n"
+                  << "threads: " << num_threads << "\n"
+                  << "time: " << duration * 1000 << " ms\n";
+        if (duration > 0)
+        {
+            std::cout << "throughput: " << static_cast<double>(stats.num_containers) / duration
+                      << " containers/s, "
+                      << static_cast<double>(stats.num_bytes) / duration / (1024 * 1024)
+                      << " MiB/s\n";
+        }
+
+        // The histogram of the validation errors ordered by the count.
+        std::vector<std::pair<size_t, EOFValidationError>> errors;
+        for (size_t i = 1; i < num_errors; ++i)
+        {
+            if (stats.results[i] != 0)
+                errors.emplace_back(stats.results[i], static_cast<EOFValidationError>(i));
+        }
+        std::ranges::sort(errors, std::greater{});
+
+        std::cout << "--- # EOF VALIDATION ERRORS\nerror,count\n";
+        for (const auto& [count, err] : errors)
+            std::cout << evmone::get_error_message(err) << "," << count << "\n";
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << "\n";
+        return 1;
+    }
+}
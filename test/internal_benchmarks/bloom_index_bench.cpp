@@ -0,0 +1,84 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <test/state/bloom_index.hpp>
+#include <test/state/state.hpp>
+
+namespace
+{
+using namespace evmone::state;
+using evmc::address;
+using evmc::bytes32;
+
+/// The number of logs in a block.
+constexpr uint64_t num_logs = 32;
+
+/// Creates the block bloom filters with the logs of pseudo-random addresses and topics.
+std::vector<BloomFilter> create_blooms(uint64_t num_blocks)
+{
+    std::vector<BloomFilter> blooms;
+    std::vector<Log> logs(num_logs);
+    for (uint64_t n = 0; n < num_blocks; ++n)
+    {
+        for (uint64_t i = 0; i < num_logs; ++i)
+        {
+            const auto x = (n * num_logs + i) * 0x9e3779b97f4a7c15;
+            logs[i].addr = address{x % 4096};
+            logs[i].topics = {bytes32{x % 1024}, bytes32{x}};
+        }
+        blooms.emplace_back(compute_bloom_filter(logs));
+    }
+    return blooms;
+}
+
+bool bloom_contains(const BloomFilter& bloom, const std::array<uint16_t, 3>& bits) noexcept
+{
+    for (const auto bit_index : bits)
+    {
+        if ((bloom.bytes[bit_index / 8] & (1 << (7 - bit_index % 8))) == 0)
+            return false;
+    }
+    return true;
+}
+
+/// Finds the candidate blocks by checking the bloom filter of every block.
+void match_scan(benchmark::State& bench_state)
+{
+    const auto blooms = create_blooms(static_cast<uint64_t>(bench_state.range(0)));
+    const auto addr_bits = bloom_bits(address{7});
+    const auto topic_bits = bloom_bits(bytes32{7});
+    for ([[maybe_unused]] auto _ : bench_state)
+    {
+        std::vector<int64_t> blocks;
+        for (size_t n = 0; n < blooms.size(); ++n)
+        {
+            if (bloom_contains(blooms[n], addr_bits) && bloom_contains(blooms[n], topic_bits))
+                blocks.push_back(static_cast<int64_t>(n));
+        }
+        benchmark::DoNotOptimize(blocks.data());
+    }
+}
+
+/// Finds the candidate blocks with the bit-sliced bloom index.
+void match_index(benchmark::State& bench_state)
+{
+    BloomIndex index;
+    for (const auto& bloom : create_blooms(static_cast<uint64_t>(bench_state.range(0))))
+        index.add(bloom);
+    const auto addr = address{7};
+    const auto topic = bytes32{7};
+    const std::vector<std::vector<bytes_view>> criteria{{addr}, {topic}};
+    for ([[maybe_unused]] auto _ : bench_state)
+    {
+        auto blocks = index.match(criteria, 0, index.next_block() - 1);
+        benchmark::DoNotOptimize(blocks.data());
+    }
+}
+
+#define ARGS ->RangeMultiplier(8)->Range(1 << 12, 1 << 18)->Unit(benchmark::kMicrosecond)
+BENCHMARK(match_scan) ARGS;
+BENCHMARK(match_index) ARGS;
+#undef ARGS
+}  // namespace
@@ -0,0 +1,63 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <evmc/mocked_host.hpp>
+#include <evmone/checkpoints.hpp>
+#include <evmone/evmone.h>
+#include <evmone/vm.hpp>
+#include <test/utils/bytecode.hpp>
+
+namespace
+{
+/// The number of the loop iterations, each modifying the beginning of the memory.
+constexpr uint64_t num_iterations = 1000;
+
+/// Executes the code expanding the memory to the range(0) bytes and then looping
+/// with the memory writes to the first memory page, optionally with the checkpoint tracer.
+void execute_memory_heavy(benchmark::State& bench_state, bool checkpoints)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    evmone::CheckpointIndex index{.gas_interval = 1000};
+    if (checkpoints)
+    {
+        static_cast<evmone::VM*>(vm.get_raw_pointer())
+            ->add_tracer(evmone::create_checkpoint_tracer(index));
+    }
+
+    const auto memory_size = static_cast<uint64_t>(bench_state.range(0));
+    const auto init = mstore(memory_size - 32, 1) + push(num_iterations);
+    const auto code = init + OP_JUMPDEST + OP_DUP1 + OP_DUP1 + OP_MSTORE + push(1) + OP_SWAP1 +
+                      OP_SUB + OP_DUP1 + push(init.size()) + OP_JUMPI;
+
+    evmc::MockedHost host;
+    evmc_message msg{};
+    msg.gas = 100'000'000;
+    for ([[maybe_unused]] auto _ : bench_state)
+    {
+        const auto r = vm.execute(host, EVMC_CANCUN, msg, code.data(), code.size());
+        if (r.status_code != EVMC_SUCCESS) [[unlikely]]
+        {
+            bench_state.SkipWithError("execution failed");
+            return;
+        }
+    }
+    bench_state.counters["checkpoints"] = static_cast<double>(index.checkpoints.size());
+}
+
+void memory_heavy_no_checkpoints(benchmark::State& bench_state)
+{
+    execute_memory_heavy(bench_state, false);
+}
+
+void memory_heavy_checkpoints(benchmark::State& bench_state)
+{
+    execute_memory_heavy(bench_state, true);
+}
+
+#define ARGS ->RangeMultiplier(8)->Range(4 * 1024, 2 * 1024 * 1024)->Unit(benchmark::kMicrosecond)
+BENCHMARK(memory_heavy_no_checkpoints) ARGS;
+BENCHMARK(memory_heavy_checkpoints) ARGS;
+#undef ARGS
+}  // namespace
@@ -0,0 +1,221 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <evmc/hex.hpp>
+#include <evmone/LibSnark.h>
+#include <test/state/precompiles_internal.hpp>
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#ifdef EVMONE_PRECOMPILES_SILKPRE
+#include <test/state/precompiles_silkpre.hpp>
+#endif
+
+namespace
+{
+using namespace evmone::state;
+using evmc::bytes;
+
+using AnalyzeFn = decltype(&identity_analyze);
+using ExecuteFn = decltype(&identity_execute);
+
+constexpr auto rev = EVMC_CANCUN;
+
+/// Adapts the libff based implementation of the BN254 precompiles from LibSnark.
+template <std::pair<bool, evmone::bytevec> (*Fn)(evmone::bytesConstRef)>
+ExecutionResult libff_execute(
+    const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size) noexcept
+{
+    const auto [success, out] = Fn({input, input_size});
+    if (!success)
+        return {EVMC_PRECOMPILE_FAILURE, 0};
+    const auto size = std::min(out.size(), output_size);
+    std::copy_n(out.data(), size, output);
+    return {EVMC_SUCCESS, size};
+}
+
+/// The implementation of the precompiles. Null execute function means not implemented.
+struct Backend
+{
+    const char* name;
+    std::array<ExecuteFn, NumPrecompiles> execute{};
+};
+
+const Backend backends[] = {
+    {"intree", {nullptr, nullptr, nullptr, nullptr, identity_execute}},
+    {"libff", {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                  libff_execute<evmone::alt_bn128_G1_add>, libff_execute<evmone::alt_bn128_G1_mul>,
+                  libff_execute<evmone::alt_bn128_pairing_product>}},
+#ifdef EVMONE_PRECOMPILES_SILKPRE
+    {"silkpre", {nullptr, silkpre_ecrecover_execute, silkpre_sha256_execute,
+                    silkpre_ripemd160_execute, nullptr, silkpre_expmod_execute,
+                    silkpre_ecadd_execute, silkpre_ecmul_execute, silkpre_ecpairing_execute,
+                    silkpre_blake2bf_execute}},
+#endif
+};
+
+struct Precompile
+{
+    const char* name;
+    PrecompileId id;
+    AnalyzeFn analyze;
+};
+
+constexpr Precompile precompiles[] = {
+    {"ecrecover", PrecompileId::ecrecover, ecrecover_analyze},
+    {"sha256", PrecompileId::sha256, sha256_analyze},
+    {"ripemd160", PrecompileId::ripemd160, ripemd160_analyze},
+    {"identity", PrecompileId::identity, identity_analyze},
+    {"expmod", PrecompileId::expmod, expmod_analyze},
+    {"ecadd", PrecompileId::ecadd, ecadd_analyze},
+    {"ecmul", PrecompileId::ecmul, ecmul_analyze},
+    {"ecpairing", PrecompileId::ecpairing, ecpairing_analyze},
+    {"blake2bf", PrecompileId::blake2bf, blake2bf_analyze},
+};
+
+/// The BN254 G1 generator (1, 2).
+constexpr auto bn254_g1 =
+    "0000000000000000000000000000000000000000000000000000000000000001"
+    "0000000000000000000000000000000000000000000000000000000000000002";
+
+/// The negated BN254 G1 generator (1, p - 2).
+constexpr auto bn254_g1_neg =
+    "0000000000000000000000000000000000000000000000000000000000000001"
+    "30644e72e131a029b85045b68181585d97816a916871ca8d3c208c16d87cfd45";
+
+/// The BN254 G2 generator in the EIP-197 encoding (imaginary parts first).
+constexpr auto bn254_g2 =
+    "198e9393920d483a7260bfb731fb5d25f1aa493335a9e71297e485b7aef312c2"
+    "1800deef121f1e76426a00665e5c4479674322d4f75edadd46debd5cd992f6ed"
+    "090689d0585ff075ec9e99ad690c3395bc4b313370b38ef355acdadcd122975b"
+    "12c85ea5db8c6deb4aab71808dcb408fe3d1e7690c43d37b4ce6cc0166fa7daa";
+
+/// The EIP-152 test vector 5: BLAKE2b compression of "abc" with 12 rounds.
+constexpr auto blake2bf_eip152 =
+    "0000000c48c9bdf267e6096a3ba7ca8485ae67bb2bf894fe72f36e3cf1361d5f3af54fa5d182e6ad7f520e511f"
+    "6c3e2b8c68059b6bbd41fbabd9831f79217e1319cde05b616263000000000000000000000000000000000000"
+    "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "0000000000000000000000000000000000000000000000000000000300000000000000000000000000000001";
+
+bytes operator""_hex(const char* s, size_t size)
+{
+    return evmc::from_hex({s, size}).value();
+}
+
+bytes hex(const char* s)
+{
+    return evmc::from_hex(s).value();
+}
+
+/// Returns the inputs to benchmark the precompile with: the EIP test vectors
+/// and the worst-case inputs (maximizing time per call or time per gas).
+std::vector<std::pair<std::string, bytes>> get_inputs(PrecompileId id)
+{
+    switch (id)
+    {
+    case PrecompileId::ecrecover:
+        return {{"valid",
+            "18c547e4f7b0f325ad1e56f57e26c745b09a3e503d86e00e5255ff7f715d3d1c"
+            "000000000000000000000000000000000000000000000000000000000000001c"
+            "73b1693892219d736caba55bdb67216e485557ea6b6af75f37096c9aa6a5a75f"
+            "eeb940b1d03b21e36b0e47e79769f095fe2ab855bd91e3a38756b7d75a9c4549"_hex}};
+    case PrecompileId::sha256:
+    case PrecompileId::ripemd160:
+    case PrecompileId::identity:
+        return {{"empty", {}}, {"32", bytes(32, 0xff)}, {"1024", bytes(1024, 0xff)}};
+    case PrecompileId::expmod:
+    {
+        // 2048-bit base and modulus with the 256-bit exponent as in RSA verification.
+        auto rsa2048 = bytes(3 * 32, 0);
+        rsa2048[30] = 0x01;  // base length: 256
+        rsa2048[63] = 0x20;  // exponent length: 32
+        rsa2048[94] = 0x01;  // modulus length: 256
+        rsa2048.append(256 + 32 + 256, 0xff);
+        return {{"eip198_example1",
+                    "0000000000000000000000000000000000000000000000000000000000000001"
+                    "0000000000000000000000000000000000000000000000000000000000000020"
+                    "0000000000000000000000000000000000000000000000000000000000000020"
+                    "03"
+                    "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e"
+                    "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f"_hex},
+            {"2048_256", std::move(rsa2048)}};
+    }
+    case PrecompileId::ecadd:
+        return {{"infinity", bytes(128, 0)}, {"g1_double", hex(bn254_g1) + hex(bn254_g1)}};
+    case PrecompileId::ecmul:
+        return {{"g1_by_2", hex(bn254_g1) + bytes(31, 0) + bytes{2}},
+            {"g1_by_max", hex(bn254_g1) + bytes(32, 0xff)}};
+    case PrecompileId::ecpairing:
+    {
+        const auto two_pairs = hex(bn254_g1) + hex(bn254_g2) + hex(bn254_g1_neg) + hex(bn254_g2);
+        auto ten_pairs = bytes{};
+        for (int i = 0; i < 5; ++i)
+            ten_pairs += two_pairs;
+        return {{"empty", {}}, {"2_pairs", two_pairs}, {"10_pairs", std::move(ten_pairs)}};
+    }
+    case PrecompileId::blake2bf:
+    {
+        auto rounds_1024 = hex(blake2bf_eip152);
+        rounds_1024[2] = 0x04;
+        rounds_1024[3] = 0x00;
+        return {{"eip152_12_rounds", hex(blake2bf_eip152)}, {"1024_rounds", std::move(rounds_1024)}};
+    }
+    default:
+        return {};
+    }
+}
+
+void precompile(benchmark::State& state, AnalyzeFn analyze, ExecuteFn execute, const bytes& input)
+{
+    const auto [gas_cost, max_output_size] = analyze(input, rev);
+    uint8_t output[4096];
+    if (max_output_size > std::size(output))
+        return state.SkipWithError("output too big");
+
+    {  // Test run.
+        const auto r = execute(input.data(), input.size(), output, std::size(output));
+        if (r.status_code != EVMC_SUCCESS)
+            return state.SkipWithError(("failure: " + std::to_string(r.status_code)).c_str());
+    }
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const auto r = execute(input.data(), input.size(), output, std::size(output));
+        benchmark::DoNotOptimize(r);
+        benchmark::DoNotOptimize(output);
+    }
+
+    using benchmark::Counter;
+    state.counters["gas_cost"] = Counter(static_cast<double>(gas_cost));
+    state.counters["gas_rate"] = Counter(
+        static_cast<double>(gas_cost) * static_cast<double>(state.iterations()), Counter::kIsRate);
+}
+
+/// Registers the benchmarks as precompile/backend/input for all implemented precompiles.
+[[maybe_unused]] const auto registered = [] {
+    for (const auto& p : precompiles)
+    {
+        for (const auto& [input_name, input] : get_inputs(p.id))
+        {
+            for (const auto& backend : backends)
+            {
+                const auto execute = backend.execute[static_cast<size_t>(p.id)];
+                if (execute == nullptr)
+                    continue;
+
+                const auto name = std::string{p.name} + '/' + backend.name + '/' + input_name;
+                benchmark::RegisterBenchmark(name.c_str(),
+                    [analyze = p.analyze, execute, input](benchmark::State& state) {
+                        precompile(state, analyze, execute, input);
+                    });
+            }
+        }
+    }
+    return true;
+}();
+}  // namespace
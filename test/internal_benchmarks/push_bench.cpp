@@ -0,0 +1,108 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <evmone/baseline.hpp>
+#include <evmone/instructions.hpp>
+#include <vector>
+
+namespace
+{
+using namespace evmone;
+
+/// The number of PUSH instructions in the benchmarked code.
+constexpr size_t num_pushes = 1000;
+
+using PushFn = code_iterator (*)(StackTop, ExecutionState&, code_iterator) noexcept;
+
+/// The PUSH implementation checking for the pre-decoded values at runtime.
+/// This is the reference of the single handler for both modes, replaced by the separate
+/// push<Len> and push_predecoded<Len> selected by the dispatch loop.
+template <size_t Len>
+inline code_iterator push_checked(
+    StackTop stack, ExecutionState& state, code_iterator pos) noexcept
+{
+    if constexpr (Len >= baseline::CodeAnalysis::min_predecoded_push_size)
+    {
+        if (const auto& analysis = *state.analysis.baseline; !analysis.push_values.empty())
+        {
+            const auto pc = static_cast<size_t>(pos - analysis.executable_code.data());
+            stack.push(analysis.push_values[analysis.push_value_index[pc]]);
+            return pos + (Len + 1);
+        }
+    }
+    return instr::core::push<Len>(stack, state, pos);
+}
+
+/// Executes the code of PUSH<Len> instructions by calling the PUSH implementation directly
+/// (without the interpreter loop and the gas and stack checks).
+template <size_t Len, PushFn Fn>
+void execute_pushes(benchmark::State& bench_state, bool predecode)
+{
+    bytes code;
+    for (size_t i = 0; i < num_pushes; ++i)
+    {
+        code.push_back(static_cast<uint8_t>(OP_PUSH0 + Len));
+        code.append(Len, static_cast<uint8_t>(i));
+    }
+    const auto analysis = baseline::analyze(EVMC_CANCUN, code, false, predecode);
+    ExecutionState state;
+    state.analysis.baseline = &analysis;
+    std::vector<intx::uint256> stack(num_pushes + 1);
+
+    for ([[maybe_unused]] auto _ : bench_state)
+    {
+        auto pos = analysis.executable_code.data();
+        for (size_t i = 0; i < num_pushes; ++i)
+            pos = Fn(&stack[i], state, pos);
+        benchmark::DoNotOptimize(pos);
+        benchmark::ClobberMemory();
+    }
+    bench_state.counters["pushes"] = benchmark::Counter(
+        static_cast<double>(num_pushes), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+/// The default PUSH implementation (the pre-decoding is disabled).
+template <size_t Len>
+void push_default(benchmark::State& bench_state)
+{
+    execute_pushes<Len, instr::core::push<Len>>(bench_state, false);
+}
+
+/// The reference PUSH implementation checking for the pre-decoded values
+/// with the pre-decoding disabled.
+template <size_t Len>
+void push_checked_default(benchmark::State& bench_state)
+{
+    execute_pushes<Len, push_checked<Len>>(bench_state, false);
+}
+
+/// The PUSH implementation taking the pre-decoded values.
+template <size_t Len>
+void push_predecoded(benchmark::State& bench_state)
+{
+    execute_pushes<Len, instr::core::push_predecoded<Len>>(bench_state, true);
+}
+
+/// The reference PUSH implementation checking for the pre-decoded values
+/// with the pre-decoding enabled.
+template <size_t Len>
+void push_checked_predecoded(benchmark::State& bench_state)
+{
+    execute_pushes<Len, push_checked<Len>>(bench_state, true);
+}
+
+#define ARGS ->Unit(benchmark::kMicrosecond)
+BENCHMARK_TEMPLATE(push_default, 1) ARGS;
+BENCHMARK_TEMPLATE(push_checked_default, 1) ARGS;
+BENCHMARK_TEMPLATE(push_default, 9) ARGS;
+BENCHMARK_TEMPLATE(push_checked_default, 9) ARGS;
+BENCHMARK_TEMPLATE(push_predecoded, 9) ARGS;
+BENCHMARK_TEMPLATE(push_checked_predecoded, 9) ARGS;
+BENCHMARK_TEMPLATE(push_default, 32) ARGS;
+BENCHMARK_TEMPLATE(push_checked_default, 32) ARGS;
+BENCHMARK_TEMPLATE(push_predecoded, 32) ARGS;
+BENCHMARK_TEMPLATE(push_checked_predecoded, 32) ARGS;
+#undef ARGS
+}  // namespace
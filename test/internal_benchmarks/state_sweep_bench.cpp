@@ -0,0 +1,91 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <test/state/state.hpp>
+
+namespace
+{
+using namespace evmone::state;
+using evmc::address;
+using evmc::bytes32;
+
+/// The number of accounts accessed by a single transaction.
+constexpr uint64_t num_accessed = 64;
+
+/// Creates the state of the given number of accounts. Every 16th account has storage.
+State create_state(uint64_t num_accounts)
+{
+    State state;
+    for (uint64_t i = 0; i < num_accounts; ++i)
+    {
+        auto& acc = state.insert(address{i + 1}, {.nonce = 1, .balance = i});
+        if (i % 16 == 0)
+            acc.storage[bytes32{i}] = {.current = bytes32{i}, .original = bytes32{i}};
+    }
+    state.clean([](Account&) noexcept {});
+    return state;
+}
+
+/// Accesses the accounts spread over the state as a transaction would.
+void access_accounts(State& state, uint64_t num_accounts, uint64_t seed)
+{
+    for (uint64_t i = 0; i < num_accessed; ++i)
+    {
+        const auto n = (seed + i * 0x9e3779b97f4a7c15) % num_accounts;
+        auto& acc = state.get(address{n + 1});
+        acc.access_status = EVMC_ACCESS_WARM;
+        acc.balance += 1;
+    }
+}
+
+void reset_account(Account& acc) noexcept
+{
+    acc.access_status = EVMC_ACCESS_COLD;
+    for (auto& [_, val] : acc.storage)
+    {
+        val.access_status = EVMC_ACCESS_COLD;
+        val.original = val.current;
+    }
+}
+
+/// The end-of-transaction processing visiting all accounts (as in the previous implementation).
+void sweep_all(benchmark::State& bench_state)
+{
+    const auto num_accounts = static_cast<uint64_t>(bench_state.range(0));
+    auto state = create_state(num_accounts);
+    uint64_t seed = 0;
+    for ([[maybe_unused]] auto _ : bench_state)
+    {
+        access_accounts(state, num_accounts, seed++);
+        state.erase_if([](const auto& p) noexcept { return p.second.destructed; });
+        state.erase_if(
+            [](const auto& p) noexcept { return p.second.erasable && p.second.is_empty(); });
+        for (auto& [_, acc] : state.get_accounts())
+            reset_account(acc);
+        state.clean([](Account&) noexcept {});
+    }
+}
+
+/// The end-of-transaction processing visiting only the dirty accounts.
+void sweep_dirty(benchmark::State& bench_state)
+{
+    const auto num_accounts = static_cast<uint64_t>(bench_state.range(0));
+    auto state = create_state(num_accounts);
+    uint64_t seed = 0;
+    for ([[maybe_unused]] auto _ : bench_state)
+    {
+        access_accounts(state, num_accounts, seed++);
+        state.erase_dirty_if([](const auto& p) noexcept { return p.second.destructed; });
+        state.erase_dirty_if(
+            [](const auto& p) noexcept { return p.second.erasable && p.second.is_empty(); });
+        state.clean(reset_account);
+    }
+}
+
+#define ARGS ->RangeMultiplier(32)->Range(1 << 10, 1 << 20)->Unit(benchmark::kMicrosecond)
+BENCHMARK(sweep_all) ARGS;
+BENCHMARK(sweep_dirty) ARGS;
+#undef ARGS
+}  // namespace
@@ -0,0 +1,77 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <evmone/evmone.h>
+#include <test/state/host.hpp>
+#include <test/utils/bytecode.hpp>
+
+namespace
+{
+using namespace evmone::state;
+using namespace evmc::literals;
+
+constexpr auto Sender = 0x5e_address;
+constexpr auto Caller = 0xca11_address;
+constexpr auto Callee = 0xc0de_address;
+
+/// The number of calls to the callee in a single execution of the caller.
+constexpr uint64_t num_calls = 1000;
+
+/// Executes the code calling the small contract many times. The range(0) is the size of
+/// the callee code: the code is padded with the unreachable bytes so the per-call costs
+/// proportional to the code size (e.g. the code analysis or hashing) are visible.
+void call_heavy(benchmark::State& bench_state, evmc::VM& vm)
+{
+    // The loop with the counter on the stack: the JUMPDEST is right after the counter push.
+    const auto init = push(num_calls);
+    const auto caller_code = init + OP_JUMPDEST + call(Callee).gas(OP_GAS) + OP_POP + push(1) +
+                             OP_SWAP1 + OP_SUB + OP_DUP1 + push(init.size()) + OP_JUMPI;
+    auto callee_code = mstore(0, OP_CALLER) + ret(0, 32);
+    callee_code.resize(static_cast<size_t>(bench_state.range(0)));
+
+    State state;
+    state.insert(Sender, {.nonce = 1, .balance = 1});
+    state.insert(Caller, {.code = caller_code});
+    state.insert(Callee, {.code = callee_code});
+
+    const BlockInfo block{};
+    const Transaction tx{};
+    Host host{EVMC_CANCUN, vm, state, block, tx};
+
+    evmc_message msg{};
+    msg.gas = 1'000'000'000;
+    msg.sender = Sender;
+    msg.recipient = Caller;
+    msg.code_address = Caller;
+    for ([[maybe_unused]] auto _ : bench_state)
+    {
+        const auto r = host.call(msg);
+        if (r.status_code != EVMC_SUCCESS) [[unlikely]]
+        {
+            bench_state.SkipWithError("execution failed");
+            return;
+        }
+    }
+    bench_state.counters["calls"] = benchmark::Counter(
+        static_cast<double>(num_calls), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void call_heavy_baseline(benchmark::State& bench_state)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    call_heavy(bench_state, vm);
+}
+
+void call_heavy_adaptive(benchmark::State& bench_state)
+{
+    evmc::VM vm{evmc_create_evmone(), {{"adaptive", ""}}};
+    call_heavy(bench_state, vm);
+}
+
+#define ARGS ->RangeMultiplier(8)->Range(64, 1 << 15)->Unit(benchmark::kMicrosecond)
+BENCHMARK(call_heavy_baseline) ARGS;
+BENCHMARK(call_heavy_adaptive) ARGS;
+#undef ARGS
+}  // namespace
@@ -0,0 +1,100 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <test/state/transient_storage.hpp>
+#include <unordered_map>
+
+namespace
+{
+using evmone::state::TransientStorage;
+using evmc::address;
+using evmc::bytes32;
+
+/// The transient storage kept in the per-account maps (as in the previous implementation).
+/// Clearing it requires visiting every account.
+class PerAccountMaps
+{
+    std::unordered_map<address, std::unordered_map<bytes32, bytes32>> m_accounts;
+
+public:
+    bytes32 get(const address& addr, const bytes32& key) const noexcept
+    {
+        const auto acc = m_accounts.find(addr);
+        if (acc == m_accounts.end())
+            return {};
+        const auto it = acc->second.find(key);
+        return it != acc->second.end() ? it->second : bytes32{};
+    }
+
+    void set(const address& addr, const bytes32& key, const bytes32& value)
+    {
+        m_accounts[addr][key] = value;
+    }
+
+    void clear() noexcept
+    {
+        for (auto& [_, storage] : m_accounts)
+            storage.clear();
+    }
+};
+
+/// The number of accounts the transient storage slots are spread over.
+constexpr uint64_t num_accounts = 4;
+
+/// TSTORE of the given number of slots followed by the clear at the transaction end.
+template <typename StorageT>
+void tstore(benchmark::State& state)
+{
+    const auto num_slots = static_cast<uint64_t>(state.range(0));
+    StorageT storage;
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (uint64_t i = 0; i < num_slots; ++i)
+            storage.set(address{i % num_accounts}, bytes32{i}, bytes32{i + 1});
+        storage.clear();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(num_slots) * state.iterations());
+}
+
+/// TLOAD of the given number of slots, half of them not set.
+template <typename StorageT>
+void tload(benchmark::State& state)
+{
+    const auto num_slots = static_cast<uint64_t>(state.range(0));
+    StorageT storage;
+    for (uint64_t i = 0; i < num_slots; i += 2)
+        storage.set(address{i % num_accounts}, bytes32{i}, bytes32{i + 1});
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (uint64_t i = 0; i < num_slots; ++i)
+            benchmark::DoNotOptimize(storage.get(address{i % num_accounts}, bytes32{i}));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(num_slots) * state.iterations());
+}
+
+/// TSTORE of the given number of slots in the call frame being reverted.
+void tstore_rollback(benchmark::State& state)
+{
+    const auto num_slots = static_cast<uint64_t>(state.range(0));
+    TransientStorage storage;
+    for ([[maybe_unused]] auto _ : state)
+    {
+        const auto checkpoint = storage.checkpoint();
+        for (uint64_t i = 0; i < num_slots; ++i)
+            storage.set(address{i % num_accounts}, bytes32{i}, bytes32{i + 1});
+        storage.rollback(checkpoint);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(num_slots) * state.iterations());
+}
+
+#define ARGS ->RangeMultiplier(8)->Range(8, 4096)
+BENCHMARK_TEMPLATE(tstore, TransientStorage) ARGS;
+BENCHMARK_TEMPLATE(tstore, PerAccountMaps) ARGS;
+BENCHMARK_TEMPLATE(tload, TransientStorage) ARGS;
+BENCHMARK_TEMPLATE(tload, PerAccountMaps) ARGS;
+BENCHMARK(tstore_rollback) ARGS;
+#undef ARGS
+}  // namespace
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma once
 
+#include "code.hpp"
 #include <evmc/evmc.hpp>
 #include <intx/intx.hpp>
 #include <unordered_map>
@@ -40,10 +41,8 @@ struct Account
     /// The account storage map.
     std::unordered_map<bytes32, StorageValue> storage = {};
 
-    std::unordered_map<bytes32, bytes32> transient_storage = {};
-
     /// The account code.
-    bytes code = {};
+    Code code = {};
 
     /// The account has been destructed and should be erased at the end of of a transaction.
     bool destructed = false;
@@ -55,6 +54,10 @@ struct Account
 
     evmc_access_status access_status = EVMC_ACCESS_COLD;
 
+    /// The account has been accessed for modification since the state has been cleaned
+    /// and it is on the state's list of dirty accounts (see State::clean()).
+    bool dirty = false;
+
     [[nodiscard]] bool is_empty() const noexcept
     {
         return code.empty() && nonce == 0 && balance == 0;
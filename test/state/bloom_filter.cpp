@@ -11,17 +11,10 @@ namespace evmone::state
 namespace
 {
 /// Adds an entry to the bloom filter.
-/// based on
-/// https://ethereum.github.io/execution-specs/autoapi/ethereum/shanghai/bloom/index.html#add-to-bloom
 inline void add_to(BloomFilter& bf, const bytes_view& entry)
 {
-    const auto hash = keccak256(entry);
-
-    // take the least significant 11-bits of the first three 16-bit values
-    for (const auto i : {0, 2, 4})
+    for (const auto bit_index : bloom_bits(entry))
     {
-        const auto bit_to_set = ((hash.bytes[i] & 0x07) << 8) | hash.bytes[i + 1];
-        const auto bit_index = 0x07FF - bit_to_set;
         const auto byte_index = bit_index / 8;
         const auto bit_pos = static_cast<uint8_t>(1 << (7 - (bit_index % 8)));
         bf.bytes[byte_index] |= bit_pos;
@@ -30,6 +23,23 @@ inline void add_to(BloomFilter& bf, const bytes_view& entry)
 
 }  // namespace
 
+/// Based on
+/// https://ethereum.github.io/execution-specs/autoapi/ethereum/shanghai/bloom/index.html#add-to-bloom
+std::array<uint16_t, 3> bloom_bits(bytes_view entry) noexcept
+{
+    const auto hash = keccak256(entry);
+
+    // take the least significant 11-bits of the first three 16-bit values
+    std::array<uint16_t, 3> bits{};
+    for (size_t k = 0; k < bits.size(); ++k)
+    {
+        const auto i = 2 * k;
+        const auto bit_to_set = ((hash.bytes[i] & 0x07) << 8) | hash.bytes[i + 1];
+        bits[k] = static_cast<uint16_t>(0x07FF - bit_to_set);
+    }
+    return bits;
+}
+
 BloomFilter compute_bloom_filter(std::span<const Log> logs) noexcept
 {
     BloomFilter res;
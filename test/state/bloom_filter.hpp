@@ -4,6 +4,7 @@
 
 #pragma once
 #include "hash_utils.hpp"
+#include <array>
 #include <span>
 
 namespace evmone::state
@@ -21,6 +22,10 @@ struct BloomFilter
     inline constexpr operator bytes_view() const noexcept { return {bytes, sizeof(bytes)}; }
 };
 
+/// Returns the indexes of the 3 bloom filter bits set for the entry (log address or topic).
+/// The bit index i is the bit (7 - i % 8) of the byte i / 8 of the BloomFilter::bytes.
+[[nodiscard]] std::array<uint16_t, 3> bloom_bits(bytes_view entry) noexcept;
+
 /// Computes combined bloom fitter for set of logs.
 /// It's used to compute bloom filter for single transaction.
 [[nodiscard]] BloomFilter compute_bloom_filter(std::span<const Log> logs) noexcept;
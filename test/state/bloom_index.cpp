@@ -0,0 +1,86 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "bloom_index.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace evmone::state
+{
+void BloomIndex::add(const BloomFilter& block_bloom)
+{
+    const auto pos = static_cast<size_t>(m_next_block - m_first_block);
+    const auto offset = pos % section_size;
+    if (offset == 0)
+        m_sections.emplace_back(std::make_unique<Row[]>(num_rows));
+
+    auto* const rows = m_sections.back().get();
+    const auto word = offset / 64;
+    const auto mask = uint64_t{1} << (offset % 64);
+    for (size_t i = 0; i < std::size(block_bloom.bytes); ++i)
+    {
+        for (unsigned b = block_bloom.bytes[i]; b != 0; b &= b - 1)
+            rows[i * 8 + 7 - static_cast<size_t>(std::countr_zero(b))][word] |= mask;
+    }
+    ++m_next_block;
+}
+
+std::vector<int64_t> BloomIndex::match(
+    std::span<const std::vector<bytes_view>> criteria, int64_t from, int64_t to) const
+{
+    std::vector<int64_t> blocks;
+    from = std::max(from, m_first_block);
+    to = std::min(to, m_next_block - 1);
+    if (from > to)
+        return blocks;
+
+    // The bloom filter bits of the entries, grouped by the criteria.
+    std::vector<std::vector<std::array<uint16_t, 3>>> groups;
+    for (const auto& criterion : criteria)
+    {
+        if (criterion.empty())
+            continue;
+        auto& group = groups.emplace_back();
+        for (const auto& entry : criterion)
+            group.push_back(bloom_bits(entry));
+    }
+
+    const auto first_pos = static_cast<size_t>(from - m_first_block);
+    const auto last_pos = static_cast<size_t>(to - m_first_block);
+    for (auto section = first_pos / section_size; section <= last_pos / section_size; ++section)
+    {
+        const auto* const rows = m_sections[section].get();
+
+        // The word loops over the whole rows are vectorized by the compiler.
+        Row matched;
+        matched.fill(~uint64_t{0});
+        for (const auto& group : groups)
+        {
+            Row any{};
+            for (const auto& bits : group)
+            {
+                const auto& r0 = rows[bits[0]];
+                const auto& r1 = rows[bits[1]];
+                const auto& r2 = rows[bits[2]];
+                for (size_t w = 0; w < words_per_row; ++w)
+                    any[w] |= r0[w] & r1[w] & r2[w];
+            }
+            for (size_t w = 0; w < words_per_row; ++w)
+                matched[w] &= any[w];
+        }
+
+        const auto section_begin = section * section_size;
+        for (size_t w = 0; w < words_per_row; ++w)
+        {
+            for (auto m = matched[w]; m != 0; m &= m - 1)
+            {
+                const auto pos = section_begin + w * 64 + static_cast<size_t>(std::countr_zero(m));
+                if (pos >= first_pos && pos <= last_pos)
+                    blocks.push_back(m_first_block + static_cast<int64_t>(pos));
+            }
+        }
+    }
+    return blocks;
+}
+}  // namespace evmone::state
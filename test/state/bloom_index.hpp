@@ -0,0 +1,59 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "bloom_filter.hpp"
+#include <memory>
+#include <vector>
+
+namespace evmone::state
+{
+/// The bit-sliced index of the block bloom filters for the log queries over many blocks.
+///
+/// The blocks are grouped in sections of section_size consecutive blocks. For every section
+/// and every bloom filter bit the index keeps the row of the section_size bits: the bit j
+/// of the row is set if the bloom filter of the j-th block in the section has the bit set.
+/// A query for an entry (address or topic) combines 3 rows with bitwise AND, instead of
+/// checking the bloom filter of every block.
+class BloomIndex
+{
+public:
+    /// The number of blocks in a section.
+    static constexpr size_t section_size = 4096;
+
+private:
+    static constexpr size_t words_per_row = section_size / 64;
+    static constexpr size_t num_rows = sizeof(BloomFilter::bytes) * 8;
+
+    using Row = std::array<uint64_t, words_per_row>;
+
+    int64_t m_first_block = 0;
+    int64_t m_next_block = 0;
+
+    /// The sections of num_rows rows each.
+    std::vector<std::unique_ptr<Row[]>> m_sections;
+
+public:
+    /// Creates the empty index starting at the given block number.
+    explicit BloomIndex(int64_t first_block = 0) noexcept
+      : m_first_block{first_block}, m_next_block{first_block}
+    {}
+
+    /// Returns the number of the first indexed block.
+    [[nodiscard]] int64_t first_block() const noexcept { return m_first_block; }
+
+    /// Returns the number of the block to be added next.
+    [[nodiscard]] int64_t next_block() const noexcept { return m_next_block; }
+
+    /// Adds the bloom filter of the next block (see compute_bloom_filter()).
+    void add(const BloomFilter& block_bloom);
+
+    /// Returns the numbers of the indexed blocks in the range [from, to] which may contain logs
+    /// matching the criteria. The block matches if for every criterion its bloom filter
+    /// contains at least one of the criterion entries (log addresses or topics).
+    /// The empty criterion matches any block.
+    [[nodiscard]] std::vector<int64_t> match(
+        std::span<const std::vector<bytes_view>> criteria, int64_t from, int64_t to) const;
+};
+}  // namespace evmone::state
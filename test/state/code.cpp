@@ -0,0 +1,246 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "code.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <tuple>
+#include <vector>
+
+namespace evmone::state
+{
+namespace
+{
+// The compressed code format is the sequence of tokens starting with the token byte t:
+// - t < 0x80: the literal run of t + 1 bytes following the token byte,
+// - t >= 0x80: the copy of (t & 0x7f) + 4 bytes from the distance (1-65535) back
+//   in the decompressed code, encoded in the following 2 bytes (little-endian).
+constexpr size_t max_literals = 0x80;
+constexpr size_t min_match = 4;
+constexpr size_t max_match = 0x7f + min_match;
+constexpr size_t max_distance = 0xffff;
+
+/// Compresses the code with the greedy LZ77 matching of the 4-byte sequences.
+bytes compress(bytes_view code)
+{
+    constexpr unsigned hash_bits = 12;
+    constexpr auto no_pos = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> last_pos(size_t{1} << hash_bits, no_pos);
+
+    bytes out;
+    out.reserve(code.size());
+
+    size_t literals_begin = 0;
+    const auto flush_literals = [&](size_t end) {
+        while (literals_begin != end)
+        {
+            const auto n = std::min(end - literals_begin, max_literals);
+            out.push_back(static_cast<uint8_t>(n - 1));
+            out.append(code.substr(literals_begin, n));
+            literals_begin += n;
+        }
+    };
+
+    for (size_t i = 0; i + min_match <= code.size();)
+    {
+        uint32_t seq = 0;
+        std::memcpy(&seq, &code[i], sizeof(seq));
+        const auto h = (seq * 2654435761u) >> (32 - hash_bits);
+        const auto candidate = std::exchange(last_pos[h], static_cast<uint32_t>(i));
+        if (candidate == no_pos || i - candidate > max_distance ||
+            std::memcmp(&code[candidate], &code[i], min_match) != 0)
+        {
+            ++i;
+            continue;
+        }
+
+        auto len = min_match;
+        while (len < max_match && i + len < code.size() && code[candidate + len] == code[i + len])
+            ++len;
+
+        flush_literals(i);
+        const auto distance = i - candidate;
+        out.push_back(static_cast<uint8_t>(0x80 | (len - min_match)));
+        out.push_back(static_cast<uint8_t>(distance));
+        out.push_back(static_cast<uint8_t>(distance >> 8));
+        i += len;
+        literals_begin = i;
+    }
+    flush_literals(code.size());
+    return out;
+}
+
+bytes decompress(bytes_view data, size_t code_size)
+{
+    bytes code;
+    code.reserve(code_size);
+    for (size_t i = 0; i < data.size();)
+    {
+        const auto t = data[i++];
+        if (t < 0x80)
+        {
+            const size_t n = t + size_t{1};
+            code.append(data.substr(i, n));
+            i += n;
+        }
+        else
+        {
+            const size_t len = (t & 0x7f) + min_match;
+            const size_t distance = data[i] | (size_t{data[i + 1]} << 8);
+            i += 2;
+            // The ranges may overlap so the bytes are copied one by one.
+            const auto from = code.size() - distance;
+            for (size_t k = 0; k < len; ++k)
+                code.push_back(code[from + k]);
+        }
+    }
+    assert(code.size() == code_size);
+    return code;
+}
+}  // namespace
+
+/// The cache of the decompressed code with the least recently used eviction.
+class HotCodeCache
+{
+    using Entry = std::pair<bytes32, std::shared_ptr<const bytes>>;
+
+    size_t m_capacity;
+
+    std::mutex m_mutex;
+
+    /// The cached code from the most recently used.
+    std::list<Entry> m_lru;
+
+    std::unordered_map<bytes32, std::list<Entry>::iterator> m_index;
+
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+
+public:
+    explicit HotCodeCache(size_t capacity) noexcept : m_capacity{capacity} {}
+
+    std::shared_ptr<const bytes> get(const Code::Blob& blob)
+    {
+        const std::lock_guard lock{m_mutex};
+        if (const auto it = m_index.find(blob.hash); it != m_index.end())
+        {
+            ++m_hits;
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            return it->second->second;
+        }
+
+        ++m_misses;
+        auto code = std::make_shared<const bytes>(decompress(blob.compressed, blob.size));
+        if (m_capacity == 0)
+            return code;
+        if (m_lru.size() == m_capacity)
+        {
+            m_index.erase(m_lru.back().first);
+            m_lru.pop_back();
+        }
+        m_lru.emplace_front(blob.hash, code);
+        m_index.emplace(blob.hash, m_lru.begin());
+        return code;
+    }
+
+    std::pair<uint64_t, uint64_t> get_stats()
+    {
+        const std::lock_guard lock{m_mutex};
+        return {m_hits, m_misses};
+    }
+};
+
+Code::Code(bytes code)
+{
+    if (code.empty())
+        return;
+    auto blob = std::make_shared<Blob>();
+    blob->hash = keccak256(code);
+    blob->size = code.size();
+    std::copy_n(code.begin(), std::min(code.size(), prefix_size), blob->prefix.begin());
+    blob->raw = std::make_shared<const bytes>(std::move(code));
+    m_blob = std::move(blob);
+}
+
+Code::Code(bytes_view code) : Code{bytes{code}} {}
+
+std::shared_ptr<const bytes> Code::load_compressed() const
+{
+    return m_blob->cache->get(*m_blob);
+}
+
+CodeStore::CodeStore(Config config)
+  : m_config{config}, m_hot_cache{std::make_shared<HotCodeCache>(config.hot_cache_size)}
+{}
+
+Code CodeStore::intern(const bytes32& hash, bytes_view code)
+{
+    const std::lock_guard lock{m_mutex};
+
+    if (m_codes.size() >= m_sweep_size)
+    {
+        std::erase_if(m_codes, [](const auto& entry) { return entry.second.expired(); });
+        m_sweep_size = std::max(m_codes.size() * 2, m_sweep_size);
+    }
+
+    auto& entry = m_codes[hash];
+    if (auto blob = entry.lock(); blob != nullptr)
+        return Code{std::move(blob)};
+
+    auto blob = std::make_shared<Code::Blob>();
+    blob->hash = hash;
+    blob->size = code.size();
+    std::copy_n(code.begin(), std::min(code.size(), Code::prefix_size), blob->prefix.begin());
+    if (m_config.compression_threshold != 0 && code.size() >= m_config.compression_threshold)
+    {
+        if (auto compressed = compress(code); compressed.size() < code.size())
+        {
+            compressed.shrink_to_fit();
+            blob->compressed = std::move(compressed);
+            blob->cache = m_hot_cache;
+        }
+    }
+    if (blob->cache == nullptr)
+        blob->raw = std::make_shared<const bytes>(code);
+
+    entry = blob;
+    return Code{std::move(blob)};
+}
+
+Code CodeStore::intern(bytes_view code)
+{
+    if (code.empty())
+        return {};
+    return intern(keccak256(code), code);
+}
+
+Code CodeStore::intern(const Code& code)
+{
+    if (code.empty())
+        return {};
+    return intern(code.hash(), *code.load());
+}
+
+CodeStore::Stats CodeStore::get_stats() const
+{
+    Stats stats;
+    {
+        const std::lock_guard lock{m_mutex};
+        for (const auto& [_, entry] : m_codes)
+        {
+            if (const auto blob = entry.lock(); blob != nullptr)
+            {
+                ++stats.num_codes;
+                stats.code_size += blob->size;
+                stats.stored_size += blob->raw != nullptr ? blob->size : blob->compressed.size();
+            }
+        }
+    }
+    std::tie(stats.hot_cache_hits, stats.hot_cache_misses) = m_hot_cache->get_stats();
+    return stats;
+}
+}  // namespace evmone::state
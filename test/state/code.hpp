@@ -0,0 +1,161 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "hash_utils.hpp"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace evmone::state
+{
+class CodeStore;
+class HotCodeCache;
+
+/// The immutable account code.
+///
+/// The code is shared between copies of the handle so copying accounts does not copy the code.
+/// The code interned in the CodeStore is also shared by all accounts having the same code
+/// and may be stored compressed.
+class Code
+{
+public:
+    /// The number of the first code bytes available without loading the code (to detect EOF).
+    static constexpr size_t prefix_size = 2;
+
+    /// The shared code storage.
+    struct Blob
+    {
+        bytes32 hash;     ///< The code hash.
+        size_t size = 0;  ///< The (uncompressed) code size.
+
+        /// The first bytes of the code, zero-padded if the code is shorter.
+        std::array<uint8_t, prefix_size> prefix{};
+
+        /// The code. Null if the code is compressed.
+        std::shared_ptr<const bytes> raw;
+
+        /// The compressed code. Empty if the code is not compressed.
+        bytes compressed;
+
+        /// The cache of the decompressed code. Null if the code is not compressed.
+        std::shared_ptr<HotCodeCache> cache;
+    };
+
+private:
+    /// The code storage. Null for the empty code.
+    std::shared_ptr<const Blob> m_blob;
+
+    explicit Code(std::shared_ptr<const Blob> blob) noexcept : m_blob{std::move(blob)} {}
+
+    /// Returns the compressed code decompressed with the use of the hot-code cache.
+    [[nodiscard]] std::shared_ptr<const bytes> load_compressed() const;
+
+    friend class CodeStore;
+
+public:
+    Code() noexcept = default;
+
+    /// Creates the code not interned in any CodeStore.
+    Code(bytes code);
+    Code(bytes_view code);
+
+    [[nodiscard]] size_t size() const noexcept { return m_blob != nullptr ? m_blob->size : 0; }
+
+    [[nodiscard]] bool empty() const noexcept { return m_blob == nullptr; }
+
+    /// Returns the first (at most prefix_size) bytes of the code.
+    /// Unlike load() this never decompresses the code.
+    [[nodiscard]] bytes_view prefix() const noexcept
+    {
+        if (m_blob == nullptr)
+            return {};
+        return {m_blob->prefix.data(), std::min(m_blob->size, prefix_size)};
+    }
+
+    /// Returns the code hash (the keccak256 of the code).
+    [[nodiscard]] const bytes32& hash() const noexcept
+    {
+        return m_blob != nullptr ? m_blob->hash : EmptyCodeHash;
+    }
+
+    /// Returns true if the code is stored compressed and must be decompressed on load().
+    [[nodiscard]] bool is_compressed() const noexcept
+    {
+        return m_blob != nullptr && m_blob->raw == nullptr;
+    }
+
+    /// Returns the code bytes.
+    ///
+    /// The returned pointer keeps the code alive, also when the handle is destroyed
+    /// or the decompressed code is evicted from the hot-code cache.
+    [[nodiscard]] std::shared_ptr<const bytes> load() const
+    {
+        static const auto empty_code = std::make_shared<const bytes>();
+        if (m_blob == nullptr)
+            return empty_code;
+        if (m_blob->raw != nullptr) [[likely]]
+            return m_blob->raw;
+        return load_compressed();
+    }
+
+    friend bool operator==(const Code& a, bytes_view b) { return bytes_view{*a.load()} == b; }
+};
+
+/// The content-addressed store of the account code.
+///
+/// The same code is stored once and shared by all accounts having it (deduplicated by the
+/// code hash). The store only references the code: the code not used by any account is freed.
+///
+/// Optionally, the code of at least Config::compression_threshold bytes is stored compressed.
+/// The compressed code is decompressed on access into the small cache of the most recently
+/// used code, so the code being executed repeatedly is decompressed once.
+class CodeStore
+{
+public:
+    struct Config
+    {
+        /// The minimal code size to store the code compressed. Zero disables the compression.
+        size_t compression_threshold = 0;
+
+        /// The number of the decompressed codes kept in the hot-code cache.
+        size_t hot_cache_size = 64;
+    };
+
+    struct Stats
+    {
+        size_t num_codes = 0;    ///< The number of the distinct codes stored.
+        size_t code_size = 0;    ///< The total size of the distinct codes.
+        size_t stored_size = 0;  ///< The total size of the codes as stored (compressed or not).
+
+        uint64_t hot_cache_hits = 0;
+        uint64_t hot_cache_misses = 0;
+    };
+
+private:
+    Config m_config;
+    std::shared_ptr<HotCodeCache> m_hot_cache;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<bytes32, std::weak_ptr<const Code::Blob>> m_codes;
+
+    /// The number of the map entries at which the entries of freed codes are erased.
+    size_t m_sweep_size = 1024;
+
+    [[nodiscard]] Code intern(const bytes32& hash, bytes_view code);
+
+public:
+    explicit CodeStore(Config config = {});
+
+    /// Returns the handle to the stored code, inserting the code if not stored yet.
+    [[nodiscard]] Code intern(bytes_view code);
+
+    /// Returns the handle to the stored copy of the code, inserting the code if not stored yet.
+    [[nodiscard]] Code intern(const Code& code);
+
+    [[nodiscard]] Stats get_stats() const;
+};
+}  // namespace evmone::state
@@ -0,0 +1,151 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "hash_utils.hpp"
+#include <evmc/evmc.hpp>
+#include <evmone/host_ext.hpp>
+
+namespace evmone::state
+{
+/// Builds the extended host interface of the evmc::Host subclass
+/// implementing also the load_storage(), store_storage() and query_account() methods.
+/// The interface is registered with evmone on the first use.
+template <typename HostT>
+const ExtendedHostInterface& extended_interface() noexcept
+{
+    static constexpr auto get_host = [](evmc_host_context* ctx) noexcept {
+        return static_cast<HostT*>(reinterpret_cast<evmc::Host*>(ctx));
+    };
+    static const ExtendedHostInterface ext_interface{
+        evmc::Host::get_interface(),
+        ExtendedHostInterface::magic_value,
+        [](evmc_host_context* ctx, const evmc_address* addr, const evmc_bytes32* key) noexcept {
+            return get_host(ctx)->load_storage(*addr, *key);
+        },
+        [](evmc_host_context* ctx, const evmc_address* addr, const evmc_bytes32* key,
+            const evmc_bytes32* value) noexcept {
+            return get_host(ctx)->store_storage(*addr, *key, *value);
+        },
+        [](evmc_host_context* ctx, const evmc_address* addr) noexcept {
+            return get_host(ctx)->query_account(*addr);
+        },
+    };
+    [[maybe_unused]] static const bool registered = register_host_ext(ext_interface);
+    return ext_interface;
+}
+
+/// The host wrapper forwarding all queries to the wrapped host.
+///
+/// It wraps the host at the EVMC level and requires the wrapped host interface to be
+/// the ExtendedHostInterface (as the state::Host provides). The subclasses override
+/// the methods of the queries to observe and are executed with extended_interface<HostT>().
+class ForwardingHost : public evmc::Host
+{
+protected:
+    const ExtendedHostInterface& m_ext;
+    evmc_host_context* m_context;
+    evmc::HostContext m_host;
+
+public:
+    ForwardingHost(const ExtendedHostInterface& host_interface,
+        evmc_host_context* host_context) noexcept
+      : m_ext{host_interface}, m_context{host_context}, m_host{host_interface.evmc, host_context}
+    {}
+
+    bool account_exists(const address& addr) const noexcept override
+    {
+        return m_host.account_exists(addr);
+    }
+
+    bytes32 get_storage(const address& addr, const bytes32& key) const noexcept override
+    {
+        return m_host.get_storage(addr, key);
+    }
+
+    evmc_storage_status set_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept override
+    {
+        return m_host.set_storage(addr, key, value);
+    }
+
+    evmc::uint256be get_balance(const address& addr) const noexcept override
+    {
+        return m_host.get_balance(addr);
+    }
+
+    size_t get_code_size(const address& addr) const noexcept override
+    {
+        return m_host.get_code_size(addr);
+    }
+
+    bytes32 get_code_hash(const address& addr) const noexcept override
+    {
+        return m_host.get_code_hash(addr);
+    }
+
+    size_t copy_code(const address& addr, size_t code_offset, uint8_t* buffer_data,
+        size_t buffer_size) const noexcept override
+    {
+        return m_host.copy_code(addr, code_offset, buffer_data, buffer_size);
+    }
+
+    bool selfdestruct(const address& addr, const address& beneficiary) noexcept override
+    {
+        return m_host.selfdestruct(addr, beneficiary);
+    }
+
+    evmc::Result call(const evmc_message& msg) noexcept override { return m_host.call(msg); }
+
+    evmc_tx_context get_tx_context() const noexcept override { return m_host.get_tx_context(); }
+
+    bytes32 get_block_hash(int64_t block_number) const noexcept override
+    {
+        return m_host.get_block_hash(block_number);
+    }
+
+    void emit_log(const address& addr, const uint8_t* data, size_t data_size,
+        const bytes32 topics[], size_t num_topics) noexcept override
+    {
+        m_host.emit_log(addr, data, data_size, topics, num_topics);
+    }
+
+    evmc_access_status access_account(const address& addr) noexcept override
+    {
+        return m_host.access_account(addr);
+    }
+
+    evmc_access_status access_storage(const address& addr, const bytes32& key) noexcept override
+    {
+        return m_host.access_storage(addr, key);
+    }
+
+    bytes32 get_transient_storage(const address& addr, const bytes32& key) const noexcept override
+    {
+        return m_host.get_transient_storage(addr, key);
+    }
+
+    void set_transient_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept override
+    {
+        m_host.set_transient_storage(addr, key, value);
+    }
+
+    StorageLoadResult load_storage(const address& addr, const bytes32& key) noexcept
+    {
+        return m_ext.load_storage(m_context, &addr, &key);
+    }
+
+    StorageStoreResult store_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept
+    {
+        return m_ext.store_storage(m_context, &addr, &key, &value);
+    }
+
+    AccountQueryResult query_account(const address& addr) noexcept
+    {
+        return m_ext.query_account(m_context, &addr);
+    }
+};
+}  // namespace evmone::state
@@ -26,6 +26,10 @@ using hash256 = bytes32;
 static constexpr auto EmptyListHash =
     0x1dcc4de8dec75d7aab85b567b6ccd41ad312451b948a7413f0a142fd40d49347_bytes32;
 
+/// The hash of the empty code, i.e. keccak256({}).
+static constexpr auto EmptyCodeHash =
+    0xc5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470_bytes32;
+
 /// Computes Keccak hash out of input bytes (wrapper of ethash::keccak256).
 inline hash256 keccak256(bytes_view data) noexcept
 {
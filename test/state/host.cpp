@@ -3,12 +3,42 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "host.hpp"
+#include "extended_host.hpp"
 #include "precompiles.hpp"
 #include "rlp.hpp"
 #include <evmone/eof.hpp>
 
 namespace evmone::state
 {
+void StaticCallMemo::sync(uint64_t epoch) noexcept
+{
+    if (epoch != m_epoch)
+    {
+        m_entries.clear();
+        m_epoch = epoch;
+    }
+}
+
+const StaticCallMemo::Entry* StaticCallMemo::find(const Key& key, uint64_t epoch) noexcept
+{
+    sync(epoch);
+    const auto it = m_entries.find(key);
+    return it != m_entries.end() ? &it->second : nullptr;
+}
+
+void StaticCallMemo::insert(const Key& key, const evmc_result& result, uint64_t epoch)
+{
+    sync(epoch);
+    m_entries.insert_or_assign(
+        key, Entry{result.status_code, result.gas_left, {result.output_data, result.output_size}});
+}
+
+void StaticCallMemo::clear() noexcept
+{
+    m_entries.clear();
+    m_epoch = 0;
+}
+
 bool Host::account_exists(const address& addr) const noexcept
 {
     const auto* const acc = m_state.find(addr);
@@ -17,19 +47,19 @@ bool Host::account_exists(const address& addr) const noexcept
 
 bytes32 Host::get_storage(const address& addr, const bytes32& key) const noexcept
 {
-    const auto& acc = m_state.get(addr);
-    if (const auto it = acc.storage.find(key); it != acc.storage.end())
-        return it->second.current;
+    if (const auto* const slot = m_state.find_storage(addr, key); slot != nullptr)
+        return slot->current;
     return {};
 }
 
-evmc_storage_status Host::set_storage(
-    const address& addr, const bytes32& key, const bytes32& value) noexcept
+namespace
+{
+/// Updates the current value of the storage slot and returns the update status.
+evmc_storage_status update_storage(StorageValue& storage_slot, const bytes32& value) noexcept
 {
     // Follow EVMC documentation https://evmc.ethereum.org/storagestatus.html#autotoc_md3
     // and EIP-2200 specification https://eips.ethereum.org/EIPS/eip-2200.
 
-    auto& storage_slot = m_state.get(addr).storage[key];
     const auto& [current, original, _] = storage_slot;
 
     const auto dirty = original != current;
@@ -67,6 +97,58 @@ evmc_storage_status Host::set_storage(
     storage_slot.current = value;  // Update current value.
     return status;
 }
+}  // namespace
+
+evmc_storage_status Host::set_storage(
+    const address& addr, const bytes32& key, const bytes32& value) noexcept
+{
+    ++m_state_epoch;
+    return update_storage(m_state.get_storage(addr, key), value);
+}
+
+StorageLoadResult Host::load_storage(const address& addr, const bytes32& key) noexcept
+{
+    auto& storage_slot = m_state.get_storage(addr, key);
+    const auto access_status = std::exchange(storage_slot.access_status, EVMC_ACCESS_WARM);
+    if (access_status == EVMC_ACCESS_COLD)
+        ++m_state_epoch;
+    return {storage_slot.current, access_status};
+}
+
+StorageStoreResult Host::store_storage(
+    const address& addr, const bytes32& key, const bytes32& value) noexcept
+{
+    auto& storage_slot = m_state.get_storage(addr, key);
+    const auto access_status = std::exchange(storage_slot.access_status, EVMC_ACCESS_WARM);
+    ++m_state_epoch;
+    return {update_storage(storage_slot, value), access_status};
+}
+
+AccountQueryResult Host::query_account(const address& addr) noexcept
+{
+    AccountQueryResult r{};
+    r.access_status = access_account(addr);  // Inserts the account since Berlin.
+    auto* const acc = m_state.find(addr);
+    r.exists = acc != nullptr && (m_rev < EVMC_SPURIOUS_DRAGON || !acc->is_empty());
+    if (acc != nullptr)
+    {
+        // The code prefix is copied without loading the code, which may be compressed.
+        static_assert(sizeof(AccountQueryResult::code_prefix) <= Code::prefix_size);
+        r.code_size = acc->code.size();
+        const auto prefix = acc->code.prefix();
+        std::copy_n(prefix.begin(), std::min(prefix.size(), std::size(r.code_prefix)),
+            r.code_prefix);
+    }
+
+    m_queried_account = acc;
+    m_queried_address = addr;
+    return r;
+}
+
+const ExtendedHostInterface& Host::get_extended_interface() noexcept
+{
+    return extended_interface<Host>();
+}
 
 uint256be Host::get_balance(const address& addr) const noexcept
 {
@@ -82,16 +164,18 @@ size_t Host::get_code_size(const address& addr) const noexcept
 
 bytes32 Host::get_code_hash(const address& addr) const noexcept
 {
-    // TODO: Cache code hash. It will be needed also to compute the MPT hash.
     const auto* const acc = m_state.find(addr);
-    return (acc != nullptr && !acc->is_empty()) ? keccak256(acc->code) : bytes32{};
+    return (acc != nullptr && !acc->is_empty()) ? acc->code.hash() : bytes32{};
 }
 
 size_t Host::copy_code(const address& addr, size_t code_offset, uint8_t* buffer_data,
     size_t buffer_size) const noexcept
 {
     const auto* const acc = m_state.find(addr);
-    const auto code = (acc != nullptr) ? bytes_view{acc->code} : bytes_view{};
+    if (acc == nullptr)
+        return 0;
+    const auto code_ptr = acc->code.load();
+    const bytes_view code{*code_ptr};
     const auto code_slice = code.substr(std::min(code_offset, code.size()));
     const auto num_bytes = std::min(buffer_size, code_slice.size());
     std::copy_n(code_slice.begin(), num_bytes, buffer_data);
@@ -103,6 +187,7 @@ bool Host::selfdestruct(const address& addr, const address& beneficiary) noexcep
     // Touch beneficiary and transfer all balance to it.
     // This may happen multiple times per single account as account's balance
     // can be increased with a call following previous selfdestruct.
+    ++m_state_epoch;
     auto& acc = m_state.get(addr);
     m_state.touch(beneficiary).balance += acc.balance;
     acc.balance = 0;  // Zero balance (this can be the beneficiary).
@@ -149,6 +234,7 @@ std::optional<evmc_message> Host::prepare_message(evmc_message msg)
         if (sender_nonce == Account::NonceMax)
             return {};  // Light early exception, cannot happen for depth == 0.
         ++sender_acc.nonce;
+        ++m_state_epoch;
     }
 
     if (msg.kind == EVMC_CREATE || msg.kind == EVMC_CREATE2)
@@ -187,6 +273,7 @@ evmc::Result Host::create(const evmc_message& msg) noexcept
     // This is only needed for tests and cannot happen in real networks.
     for (auto& [_, v] : new_acc.storage) [[unlikely]]
         v = StorageValue{.access_status = v.access_status};
+    m_state.discard_parent_storage(msg.recipient);
 
     auto& sender_acc = m_state.get(msg.sender);  // TODO: Duplicated account lookup.
     const auto value = intx::be::load<intx::uint256>(msg.value);
@@ -199,13 +286,15 @@ evmc::Result Host::create(const evmc_message& msg) noexcept
     create_msg.input_data = nullptr;
     create_msg.input_size = 0;
 
-    if (m_rev >= EVMC_PRAGUE && (is_eof_container(initcode) || is_eof_container(sender_acc.code)))
+    if (m_rev >= EVMC_PRAGUE &&
+        (is_eof_container(initcode) || is_eof_container(*sender_acc.code.load())))
     {
         if (validate_eof(m_rev, initcode) != EOFValidationError::success)
             return evmc::Result{EVMC_CONTRACT_VALIDATION_FAILURE};
     }
 
-    auto result = m_vm.execute(*this, m_rev, create_msg, msg.input_data, msg.input_size);
+    auto result = m_vm.execute(get_extended_interface().evmc, to_context(), m_rev, create_msg,
+        msg.input_data, msg.input_size);
     if (result.status_code != EVMC_SUCCESS)
     {
         result.create_address = msg.recipient;
@@ -238,7 +327,7 @@ evmc::Result Host::create(const evmc_message& msg) noexcept
 
     // TODO: The new_acc pointer is invalid because of the state revert implementation,
     //       but this should change if state journal is implemented.
-    m_state.get(msg.recipient).code = code;
+    m_state.get(msg.recipient).code = m_state.make_code(code);
 
     return evmc::Result{result.status_code, gas_left, result.gas_refund, msg.recipient};
 }
@@ -249,13 +338,26 @@ evmc::Result Host::execute_message(const evmc_message& msg) noexcept
         return create(msg);
 
     assert(msg.kind != EVMC_CALL || evmc::address{msg.recipient} == msg.code_address);
-    auto* const dst_acc =
-        (msg.kind == EVMC_CALL) ? &m_state.touch(msg.recipient) : m_state.find(msg.code_address);
+
+    // Reuse the account found by the query preparing this call.
+    auto* dst_acc = std::exchange(m_queried_account, nullptr);
+    if (dst_acc == nullptr || m_queried_address != msg.code_address)
+        dst_acc = m_state.find(msg.code_address);
 
     if (msg.kind == EVMC_CALL)
     {
+        // Touch.
+        if (dst_acc == nullptr || !std::exchange(dst_acc->erasable, true))
+        {
+            ++m_state_epoch;
+            if (dst_acc == nullptr)
+                dst_acc = &m_state.touch(msg.recipient);
+        }
+
         // Transfer value.
         const auto value = intx::be::load<intx::uint256>(msg.value);
+        if (value != 0)
+            ++m_state_epoch;
         assert(m_state.get(msg.sender).balance >= value);
         m_state.get(msg.sender).balance -= value;
         dst_acc->balance += value;
@@ -264,19 +366,40 @@ evmc::Result Host::execute_message(const evmc_message& msg) noexcept
     if (auto precompiled_result = call_precompile(m_rev, msg); precompiled_result.has_value())
         return std::move(*precompiled_result);
 
-    // Copy of the code. Revert will invalidate the account.
-    const auto code = dst_acc != nullptr ? dst_acc->code : bytes{};
-    return m_vm.execute(*this, m_rev, msg, code.data(), code.size());
+    // Shared reference to the code. Revert will invalidate the account.
+    const auto code = dst_acc != nullptr ? dst_acc->code.load() : Code{}.load();
+    return m_vm.execute(
+        get_extended_interface().evmc, to_context(), m_rev, msg, code->data(), code->size());
 }
 
 evmc::Result Host::call(const evmc_message& orig_msg) noexcept
 {
+    const auto memoize = m_static_call_memo != nullptr && orig_msg.kind == EVMC_CALL &&
+                         (orig_msg.flags & EVMC_STATIC) != 0;
+    StaticCallMemo::Key memo_key;
+    if (memoize)
+    {
+        memo_key = {orig_msg.code_address, orig_msg.sender, orig_msg.gas, orig_msg.depth,
+            keccak256({orig_msg.input_data, orig_msg.input_size})};
+        if (const auto* const entry = m_static_call_memo->find(memo_key, m_state_epoch))
+        {
+            ++m_static_call_memo->hits;
+            m_queried_account = nullptr;
+            return evmc::Result{
+                entry->status_code, entry->gas_left, 0, entry->output.data(), entry->output.size()};
+        }
+        ++m_static_call_memo->misses;
+    }
+    const auto call_epoch = m_state_epoch;
+
     const auto msg = prepare_message(orig_msg);
     if (!msg.has_value())
         return evmc::Result{EVMC_FAILURE, orig_msg.gas};  // Light exception.
 
     auto state_snapshot = m_state;
+    const auto epoch_snapshot = m_state_epoch;
     const auto logs_snapshot = m_logs.size();
+    const auto transient_storage_snapshot = m_transient_storage.checkpoint();
 
     auto result = execute_message(*msg);
 
@@ -286,14 +409,23 @@ evmc::Result Host::call(const evmc_message& orig_msg) noexcept
         auto* const acc_03 = m_state.find(addr_03);
         const auto is_03_touched = acc_03 != nullptr && acc_03->erasable;
 
-        // Revert.
+        // Revert. The epoch is never moved back because the memoized results
+        // of the reverted epochs would become valid again.
         m_state = std::move(state_snapshot);
+        m_queried_account = nullptr;
         m_logs.resize(logs_snapshot);
+        m_transient_storage.rollback(transient_storage_snapshot);
+        if (m_state_epoch != epoch_snapshot)
+            ++m_state_epoch;
 
         // The 0x03 quirk: the touch on this address is never reverted.
         if (is_03_touched && m_rev >= EVMC_SPURIOUS_DRAGON)
             m_state.touch(addr_03);
     }
+
+    // Memoize only the executions which have not modified the state.
+    if (memoize && m_state_epoch == call_epoch)
+        m_static_call_memo->insert(memo_key, result, m_state_epoch);
     return result;
 }
 
@@ -346,6 +478,8 @@ evmc_access_status Host::access_account(const address& addr) noexcept
 
     auto& acc = m_state.get_or_insert(addr, {.erasable = true});
     const auto status = std::exchange(acc.access_status, EVMC_ACCESS_WARM);
+    if (status == EVMC_ACCESS_COLD)
+        ++m_state_epoch;
 
     // Overwrite status for precompiled contracts: they are always warm.
     if (status == EVMC_ACCESS_COLD && addr >= 0x01_address && addr <= 0x09_address)
@@ -356,20 +490,23 @@ evmc_access_status Host::access_account(const address& addr) noexcept
 
 evmc_access_status Host::access_storage(const address& addr, const bytes32& key) noexcept
 {
-    return std::exchange(m_state.get(addr).storage[key].access_status, EVMC_ACCESS_WARM);
+    const auto status =
+        std::exchange(m_state.get_storage(addr, key).access_status, EVMC_ACCESS_WARM);
+    if (status == EVMC_ACCESS_COLD)
+        ++m_state_epoch;
+    return status;
 }
 
 
 evmc::bytes32 Host::get_transient_storage(const address& addr, const bytes32& key) const noexcept
 {
-    const auto& acc = m_state.get(addr);
-    const auto it = acc.transient_storage.find(key);
-    return it != acc.transient_storage.end() ? it->second : bytes32{};
+    return m_transient_storage.get(addr, key);
 }
 
 void Host::set_transient_storage(
     const address& addr, const bytes32& key, const bytes32& value) noexcept
 {
-    m_state.get(addr).transient_storage[key] = value;
+    ++m_state_epoch;
+    m_transient_storage.set(addr, key, value);
 }
 }  // namespace evmone::state
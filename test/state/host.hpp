@@ -5,7 +5,10 @@
 #pragma once
 
 #include "state.hpp"
+#include "transient_storage.hpp"
+#include <evmone/host_ext.hpp>
 #include <optional>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace evmone::state
@@ -28,6 +31,67 @@ inline constexpr size_t max_initcode_size = 2 * max_code_size;
 address compute_new_account_address(const address& sender, uint64_t sender_nonce,
     const std::optional<bytes32>& salt, bytes_view init_code) noexcept;
 
+/// The memo table of the STATICCALL results within a single transaction.
+///
+/// The results are valid only for the state epoch they were recorded at:
+/// the Host advances the epoch on every state modification (including the changes of
+/// the EIP-2929 access status) and the table is cleared when the epoch changes.
+/// Only the executions not modifying the state are recorded so the repeated call
+/// produces the same output and uses the same amount of gas.
+class StaticCallMemo
+{
+public:
+    struct Key
+    {
+        address code_address;
+        address sender;
+        int64_t gas = 0;
+        int32_t depth = 0;
+        hash256 input_hash;
+
+        bool operator==(const Key&) const noexcept = default;
+    };
+
+    struct Entry
+    {
+        evmc_status_code status_code = EVMC_SUCCESS;
+        int64_t gas_left = 0;
+        bytes output;
+    };
+
+    /// The number of calls served from the memo table.
+    size_t hits = 0;
+
+    /// The number of the memoizable calls executed.
+    size_t misses = 0;
+
+    /// Returns the memoized result of the call in the state epoch or null.
+    [[nodiscard]] const Entry* find(const Key& key, uint64_t epoch) noexcept;
+
+    /// Memoizes the result of the call executed in the state epoch.
+    void insert(const Key& key, const evmc_result& result, uint64_t epoch);
+
+    /// Removes all the results. The state epoch is reset.
+    void clear() noexcept;
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const noexcept
+        {
+            return std::hash<hash256>{}(key.input_hash) ^ std::hash<address>{}(key.code_address) ^
+                   std::hash<address>{}(key.sender) ^ static_cast<size_t>(key.gas) ^
+                   static_cast<size_t>(key.depth);
+        }
+    };
+
+    uint64_t m_epoch = 0;
+    std::unordered_map<Key, Entry, KeyHash> m_entries;
+
+    /// Clears the table if the state epoch has changed.
+    void sync(uint64_t epoch) noexcept;
+};
+
 class Host : public evmc::Host
 {
     evmc_revision m_rev;
@@ -37,11 +101,42 @@ class Host : public evmc::Host
     const Transaction& m_tx;
     std::vector<Log> m_logs;
 
+    /// The transient storage owned by the host if not provided by the caller.
+    TransientStorage m_own_transient_storage;
+
+    /// The transient storage of the transaction (EIP-1153).
+    TransientStorage& m_transient_storage;
+
+    /// The account found by the last query_account() and its address.
+    /// The account is reused to execute the call message to this address.
+    /// The pointer is invalidated by the state revert.
+    Account* m_queried_account = nullptr;
+    address m_queried_address;
+
+    /// The optional memo table of the STATICCALL results.
+    StaticCallMemo* m_static_call_memo = nullptr;
+
+    /// The counter of the state modifications. Identifies the state for the StaticCallMemo.
+    uint64_t m_state_epoch = 0;
+
 public:
     Host(evmc_revision rev, evmc::VM& vm, State& state, const BlockInfo& block,
-        const Transaction& tx) noexcept
-      : m_rev{rev}, m_vm{vm}, m_state{state}, m_block{block}, m_tx{tx}
-    {}
+        const Transaction& tx, StaticCallMemo* static_call_memo = nullptr,
+        TransientStorage* transient_storage = nullptr) noexcept
+      : m_rev{rev},
+        m_vm{vm},
+        m_state{state},
+        m_block{block},
+        m_tx{tx},
+        m_transient_storage{
+            transient_storage != nullptr ? *transient_storage : m_own_transient_storage},
+        m_static_call_memo{static_call_memo}
+    {
+        if (m_static_call_memo != nullptr)
+            m_static_call_memo->clear();
+        if (transient_storage != nullptr)
+            transient_storage->clear();
+    }
 
     [[nodiscard]] std::vector<Log>&& take_logs() noexcept { return std::move(m_logs); }
 
@@ -88,6 +183,23 @@ public:
 private:
     evmc_access_status access_storage(const address& addr, const bytes32& key) noexcept override;
 
+public:
+    /// The combined access_storage() and get_storage() of the evmone host interface extension.
+    StorageLoadResult load_storage(const address& addr, const bytes32& key) noexcept;
+
+    /// The combined access_storage() and set_storage() of the evmone host interface extension.
+    StorageStoreResult store_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept;
+
+    /// The combined access_account(), account_exists() and copy_code() of
+    /// the evmone host interface extension.
+    AccountQueryResult query_account(const address& addr) noexcept;
+
+private:
+    /// Returns the host interface with the evmone extension to execute messages with.
+    /// The VM must have the "host_ext" option enabled to use the extension.
+    static const ExtendedHostInterface& get_extended_interface() noexcept;
+
     /// Prepares message for execution.
     ///
     /// This contains mostly checks and logic related to the sender
@@ -0,0 +1,672 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "host_recording.hpp"
+#include <algorithm>
+
+namespace evmone::state
+{
+namespace
+{
+/// The kinds of the host queries in the log.
+enum class QueryKind : uint8_t
+{
+    account_exists = 1,
+    get_storage,
+    set_storage,
+    get_balance,
+    get_code_size,
+    get_code_hash,
+    copy_code,
+    selfdestruct,
+    call,
+    get_tx_context,
+    get_block_hash,
+    emit_log,
+    access_account,
+    access_storage,
+    get_transient_storage,
+    set_transient_storage,
+    load_storage,
+    store_storage,
+    query_account,
+};
+
+constexpr uint8_t magic[] = {'E', 'V', 'M', 'R'};
+constexpr uint8_t format_version = 1;
+
+/// Appends values in the recording binary format:
+/// integers are encoded as LEB128, byte arrays are prefixed with their size.
+class Writer
+{
+    bytes& m_out;
+
+public:
+    explicit Writer(bytes& out) noexcept : m_out{out} {}
+
+    Writer& uint(uint64_t v)
+    {
+        for (; v >= 0x80; v >>= 7)
+            m_out.push_back(static_cast<uint8_t>(v | 0x80));
+        m_out.push_back(static_cast<uint8_t>(v));
+        return *this;
+    }
+
+    Writer& fixed(const evmc_address& a)
+    {
+        m_out.append(a.bytes, std::size(a.bytes));
+        return *this;
+    }
+
+    Writer& fixed(const evmc_bytes32& b)
+    {
+        m_out.append(b.bytes, std::size(b.bytes));
+        return *this;
+    }
+
+    Writer& data(bytes_view d)
+    {
+        uint(d.size());
+        m_out.append(d);
+        return *this;
+    }
+
+    Writer& message(const evmc_message& msg)
+    {
+        return uint(static_cast<uint64_t>(msg.kind))
+            .uint(msg.flags)
+            .uint(static_cast<uint64_t>(msg.depth))
+            .uint(static_cast<uint64_t>(msg.gas))
+            .fixed(msg.recipient)
+            .fixed(msg.sender)
+            .data({msg.input_data, msg.input_size})
+            .fixed(msg.value)
+            .fixed(msg.create2_salt)
+            .fixed(msg.code_address);
+    }
+};
+
+/// Reads values in the recording binary format.
+/// On reading past the end of input the error flag is set and zero values are returned.
+class Reader
+{
+    bytes_view m_in;
+    size_t& m_pos;
+    bool& m_error;
+
+    [[nodiscard]] bool fail() noexcept
+    {
+        m_error = true;
+        m_pos = m_in.size();
+        return false;
+    }
+
+    [[nodiscard]] bool has(size_t n) noexcept { return m_in.size() - m_pos >= n || fail(); }
+
+public:
+    Reader(bytes_view in, size_t& pos, bool& error) noexcept : m_in{in}, m_pos{pos}, m_error{error}
+    {}
+
+    uint64_t uint() noexcept
+    {
+        uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64 && has(1); shift += 7)
+        {
+            const auto b = m_in[m_pos++];
+            v |= uint64_t{b & 0x7fu} << shift;
+            if ((b & 0x80) == 0)
+                return v;
+        }
+        (void)fail();
+        return 0;
+    }
+
+    template <typename T>
+    T fixed() noexcept
+    {
+        T v{};
+        if (has(sizeof(v.bytes)))
+        {
+            std::copy_n(&m_in[m_pos], sizeof(v.bytes), v.bytes);
+            m_pos += sizeof(v.bytes);
+        }
+        return v;
+    }
+
+    bytes_view data() noexcept
+    {
+        const auto size = uint();
+        if (!has(size))
+            return {};
+        const auto d = m_in.substr(m_pos, size);
+        m_pos += size;
+        return d;
+    }
+};
+
+/// Starts the new log entry of the given kind.
+Writer entry(bytes& log, QueryKind kind)
+{
+    Writer w{log};
+    w.uint(static_cast<uint64_t>(kind));
+    return w;
+}
+}  // namespace
+
+evmc_message HostRecording::message() const noexcept
+{
+    evmc_message msg{};
+    msg.kind = kind;
+    msg.flags = flags;
+    msg.gas = gas;
+    msg.recipient = recipient;
+    msg.sender = sender;
+    msg.input_data = input.data();
+    msg.input_size = input.size();
+    msg.value = value;
+    msg.create2_salt = create2_salt;
+    msg.code_address = code_address;
+    return msg;
+}
+
+bytes HostRecording::serialize() const
+{
+    bytes out{magic, std::size(magic)};
+    Writer{out}
+        .uint(format_version)
+        .uint(static_cast<uint64_t>(rev))
+        .uint(host_ext)
+        .message(message())
+        .data(code)
+        .data(log);
+    return out;
+}
+
+std::optional<HostRecording> HostRecording::deserialize(bytes_view data)
+{
+    if (!data.starts_with(bytes_view{magic, std::size(magic)}))
+        return {};
+
+    size_t pos = std::size(magic);
+    bool error = false;
+    Reader r{data, pos, error};
+    if (r.uint() != format_version)
+        return {};
+
+    HostRecording rec;
+    rec.rev = static_cast<evmc_revision>(r.uint());
+    rec.host_ext = r.uint() != 0;
+    rec.kind = static_cast<evmc_call_kind>(r.uint());
+    rec.flags = static_cast<uint32_t>(r.uint());
+    r.uint();  // Depth is always 0.
+    rec.gas = static_cast<int64_t>(r.uint());
+    rec.recipient = r.fixed<address>();
+    rec.sender = r.fixed<address>();
+    rec.input = r.data();
+    rec.value = r.fixed<bytes32>();
+    rec.create2_salt = r.fixed<bytes32>();
+    rec.code_address = r.fixed<address>();
+    rec.code = r.data();
+    rec.log = r.data();
+
+    if (error || pos != data.size() || rec.rev > EVMC_MAX_REVISION)
+        return {};
+    return rec;
+}
+
+
+const ExtendedHostInterface& RecordingHost::get_extended_interface() noexcept
+{
+    return extended_interface<RecordingHost>();
+}
+
+bool RecordingHost::account_exists(const address& addr) const noexcept
+{
+    const auto r = m_host.account_exists(addr);
+    entry(m_recording.log, QueryKind::account_exists).fixed(addr).uint(r);
+    return r;
+}
+
+bytes32 RecordingHost::get_storage(const address& addr, const bytes32& key) const noexcept
+{
+    const auto r = m_host.get_storage(addr, key);
+    entry(m_recording.log, QueryKind::get_storage).fixed(addr).fixed(key).fixed(r);
+    return r;
+}
+
+evmc_storage_status RecordingHost::set_storage(
+    const address& addr, const bytes32& key, const bytes32& value) noexcept
+{
+    const auto r = m_host.set_storage(addr, key, value);
+    entry(m_recording.log, QueryKind::set_storage).fixed(addr).fixed(key).fixed(value).uint(r);
+    return r;
+}
+
+evmc::uint256be RecordingHost::get_balance(const address& addr) const noexcept
+{
+    const auto r = m_host.get_balance(addr);
+    entry(m_recording.log, QueryKind::get_balance).fixed(addr).fixed(r);
+    return r;
+}
+
+size_t RecordingHost::get_code_size(const address& addr) const noexcept
+{
+    const auto r = m_host.get_code_size(addr);
+    entry(m_recording.log, QueryKind::get_code_size).fixed(addr).uint(r);
+    return r;
+}
+
+bytes32 RecordingHost::get_code_hash(const address& addr) const noexcept
+{
+    const auto r = m_host.get_code_hash(addr);
+    entry(m_recording.log, QueryKind::get_code_hash).fixed(addr).fixed(r);
+    return r;
+}
+
+size_t RecordingHost::copy_code(const address& addr, size_t code_offset, uint8_t* buffer_data,
+    size_t buffer_size) const noexcept
+{
+    const auto r = m_host.copy_code(addr, code_offset, buffer_data, buffer_size);
+    entry(m_recording.log, QueryKind::copy_code)
+        .fixed(addr)
+        .uint(code_offset)
+        .uint(buffer_size)
+        .data({buffer_data, r});
+    return r;
+}
+
+bool RecordingHost::selfdestruct(const address& addr, const address& beneficiary) noexcept
+{
+    const auto r = m_host.selfdestruct(addr, beneficiary);
+    entry(m_recording.log, QueryKind::selfdestruct).fixed(addr).fixed(beneficiary).uint(r);
+    return r;
+}
+
+evmc::Result RecordingHost::call(const evmc_message& msg) noexcept
+{
+    auto r = m_host.call(msg);
+    entry(m_recording.log, QueryKind::call)
+        .message(msg)
+        .uint(static_cast<uint32_t>(r.status_code))
+        .uint(static_cast<uint64_t>(r.gas_left))
+        .uint(static_cast<uint64_t>(r.gas_refund))
+        .data({r.output_data, r.output_size})
+        .fixed(r.create_address);
+    return r;
+}
+
+evmc_tx_context RecordingHost::get_tx_context() const noexcept
+{
+    const auto r = m_host.get_tx_context();
+    auto w = entry(m_recording.log, QueryKind::get_tx_context);
+    w.fixed(r.tx_gas_price)
+        .fixed(r.tx_origin)
+        .fixed(r.block_coinbase)
+        .uint(static_cast<uint64_t>(r.block_number))
+        .uint(static_cast<uint64_t>(r.block_timestamp))
+        .uint(static_cast<uint64_t>(r.block_gas_limit))
+        .fixed(r.block_prev_randao)
+        .fixed(r.chain_id)
+        .fixed(r.block_base_fee)
+        .fixed(r.blob_base_fee)
+        .uint(r.blob_hashes_count);
+    for (size_t i = 0; i < r.blob_hashes_count; ++i)
+        w.fixed(r.blob_hashes[i]);
+    return r;
+}
+
+bytes32 RecordingHost::get_block_hash(int64_t block_number) const noexcept
+{
+    const auto r = m_host.get_block_hash(block_number);
+    entry(m_recording.log, QueryKind::get_block_hash)
+        .uint(static_cast<uint64_t>(block_number))
+        .fixed(r);
+    return r;
+}
+
+void RecordingHost::emit_log(const address& addr, const uint8_t* data, size_t data_size,
+    const bytes32 topics[], size_t num_topics) noexcept
+{
+    m_host.emit_log(addr, data, data_size, topics, num_topics);
+    auto w = entry(m_recording.log, QueryKind::emit_log);
+    w.fixed(addr).data({data, data_size}).uint(num_topics);
+    for (size_t i = 0; i < num_topics; ++i)
+        w.fixed(topics[i]);
+}
+
+evmc_access_status RecordingHost::access_account(const address& addr) noexcept
+{
+    const auto r = m_host.access_account(addr);
+    entry(m_recording.log, QueryKind::access_account).fixed(addr).uint(r);
+    return r;
+}
+
+evmc_access_status RecordingHost::access_storage(const address& addr, const bytes32& key) noexcept
+{
+    const auto r = m_host.access_storage(addr, key);
+    entry(m_recording.log, QueryKind::access_storage).fixed(addr).fixed(key).uint(r);
+    return r;
+}
+
+bytes32 RecordingHost::get_transient_storage(const address& addr, const bytes32& key) const noexcept
+{
+    const auto r = m_host.get_transient_storage(addr, key);
+    entry(m_recording.log, QueryKind::get_transient_storage).fixed(addr).fixed(key).fixed(r);
+    return r;
+}
+
+void RecordingHost::set_transient_storage(
+    const address& addr, const bytes32& key, const bytes32& value) noexcept
+{
+    m_host.set_transient_storage(addr, key, value);
+    entry(m_recording.log, QueryKind::set_transient_storage).fixed(addr).fixed(key).fixed(value);
+}
+
+StorageLoadResult RecordingHost::load_storage(const address& addr, const bytes32& key) noexcept
+{
+    const auto r = m_ext.load_storage(m_context, &addr, &key);
+    m_recording.host_ext = true;
+    entry(m_recording.log, QueryKind::load_storage)
+        .fixed(addr)
+        .fixed(key)
+        .fixed(r.value)
+        .uint(r.access_status);
+    return r;
+}
+
+StorageStoreResult RecordingHost::store_storage(
+    const address& addr, const bytes32& key, const bytes32& value) noexcept
+{
+    const auto r = m_ext.store_storage(m_context, &addr, &key, &value);
+    m_recording.host_ext = true;
+    entry(m_recording.log, QueryKind::store_storage)
+        .fixed(addr)
+        .fixed(key)
+        .fixed(value)
+        .uint(r.status)
+        .uint(r.access_status);
+    return r;
+}
+
+AccountQueryResult RecordingHost::query_account(const address& addr) noexcept
+{
+    const auto r = m_ext.query_account(m_context, &addr);
+    m_recording.host_ext = true;
+    entry(m_recording.log, QueryKind::query_account)
+        .fixed(addr)
+        .uint(r.access_status)
+        .uint(r.exists)
+        .uint(r.code_size)
+        .data({r.code_prefix, std::min(r.code_size, std::size(r.code_prefix))});
+    return r;
+}
+
+
+const ExtendedHostInterface& ReplayHost::get_extended_interface() noexcept
+{
+    return extended_interface<ReplayHost>();
+}
+
+bool ReplayHost::match_query() const noexcept
+{
+    const auto& log = m_recording.log;
+    if (m_diverged || bytes_view{log}.substr(m_pos, m_query.size()) != m_query)
+    {
+        m_query.clear();
+        m_diverged = true;
+        m_pos = log.size();
+        return false;
+    }
+    m_pos += m_query.size();
+    m_query.clear();
+    return true;
+}
+
+// The replay methods encode the query the same way as the recording ones into m_query,
+// check it matches the log and then read the recorded response.
+
+bool ReplayHost::account_exists(const address& addr) const noexcept
+{
+    entry(m_query, QueryKind::account_exists).fixed(addr);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() && r.uint() != 0;
+}
+
+bytes32 ReplayHost::get_storage(const address& addr, const bytes32& key) const noexcept
+{
+    entry(m_query, QueryKind::get_storage).fixed(addr).fixed(key);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() ? r.fixed<bytes32>() : bytes32{};
+}
+
+evmc_storage_status ReplayHost::set_storage(
+    const address& addr, const bytes32& key, const bytes32& value) noexcept
+{
+    entry(m_query, QueryKind::set_storage).fixed(addr).fixed(key).fixed(value);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() ? static_cast<evmc_storage_status>(r.uint()) : EVMC_STORAGE_ASSIGNED;
+}
+
+evmc::uint256be ReplayHost::get_balance(const address& addr) const noexcept
+{
+    entry(m_query, QueryKind::get_balance).fixed(addr);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() ? r.fixed<evmc::uint256be>() : evmc::uint256be{};
+}
+
+size_t ReplayHost::get_code_size(const address& addr) const noexcept
+{
+    entry(m_query, QueryKind::get_code_size).fixed(addr);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() ? static_cast<size_t>(r.uint()) : 0;
+}
+
+bytes32 ReplayHost::get_code_hash(const address& addr) const noexcept
+{
+    entry(m_query, QueryKind::get_code_hash).fixed(addr);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() ? r.fixed<bytes32>() : bytes32{};
+}
+
+size_t ReplayHost::copy_code(const address& addr, size_t code_offset, uint8_t* buffer_data,
+    size_t buffer_size) const noexcept
+{
+    entry(m_query, QueryKind::copy_code).fixed(addr).uint(code_offset).uint(buffer_size);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    if (!match_query())
+        return 0;
+    const auto code = r.data();
+    const auto n = std::min(code.size(), buffer_size);
+    std::copy_n(code.data(), n, buffer_data);
+    return n;
+}
+
+bool ReplayHost::selfdestruct(const address& addr, const address& beneficiary) noexcept
+{
+    entry(m_query, QueryKind::selfdestruct).fixed(addr).fixed(beneficiary);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() && r.uint() != 0;
+}
+
+evmc::Result ReplayHost::call(const evmc_message& msg) noexcept
+{
+    entry(m_query, QueryKind::call).message(msg);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    if (!match_query())
+        return evmc::Result{EVMC_FAILURE};
+
+    const auto status = static_cast<evmc_status_code>(static_cast<int32_t>(r.uint()));
+    const auto gas_left = static_cast<int64_t>(r.uint());
+    const auto gas_refund = static_cast<int64_t>(r.uint());
+    const auto output = r.data();
+    evmc::Result result{status, gas_left, gas_refund, output.data(), output.size()};
+    result.create_address = r.fixed<address>();
+    return result;
+}
+
+evmc_tx_context ReplayHost::get_tx_context() const noexcept
+{
+    entry(m_query, QueryKind::get_tx_context);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    if (!match_query())
+        return {};
+
+    evmc_tx_context c{};
+    c.tx_gas_price = r.fixed<evmc::uint256be>();
+    c.tx_origin = r.fixed<address>();
+    c.block_coinbase = r.fixed<address>();
+    c.block_number = static_cast<int64_t>(r.uint());
+    c.block_timestamp = static_cast<int64_t>(r.uint());
+    c.block_gas_limit = static_cast<int64_t>(r.uint());
+    c.block_prev_randao = r.fixed<evmc::uint256be>();
+    c.chain_id = r.fixed<evmc::uint256be>();
+    c.block_base_fee = r.fixed<evmc::uint256be>();
+    c.blob_base_fee = r.fixed<evmc::uint256be>();
+    m_blob_hashes.resize(static_cast<size_t>(r.uint()));
+    for (auto& h : m_blob_hashes)
+        h = r.fixed<bytes32>();
+    c.blob_hashes = m_blob_hashes.data();
+    c.blob_hashes_count = m_blob_hashes.size();
+    return c;
+}
+
+bytes32 ReplayHost::get_block_hash(int64_t block_number) const noexcept
+{
+    entry(m_query, QueryKind::get_block_hash).uint(static_cast<uint64_t>(block_number));
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() ? r.fixed<bytes32>() : bytes32{};
+}
+
+void ReplayHost::emit_log(const address& addr, const uint8_t* data, size_t data_size,
+    const bytes32 topics[], size_t num_topics) noexcept
+{
+    auto q = entry(m_query, QueryKind::emit_log);
+    q.fixed(addr).data({data, data_size}).uint(num_topics);
+    for (size_t i = 0; i < num_topics; ++i)
+        q.fixed(topics[i]);
+    (void)match_query();
+}
+
+evmc_access_status ReplayHost::access_account(const address& addr) noexcept
+{
+    entry(m_query, QueryKind::access_account).fixed(addr);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() ? static_cast<evmc_access_status>(r.uint()) : EVMC_ACCESS_COLD;
+}
+
+evmc_access_status ReplayHost::access_storage(const address& addr, const bytes32& key) noexcept
+{
+    entry(m_query, QueryKind::access_storage).fixed(addr).fixed(key);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() ? static_cast<evmc_access_status>(r.uint()) : EVMC_ACCESS_COLD;
+}
+
+bytes32 ReplayHost::get_transient_storage(const address& addr, const bytes32& key) const noexcept
+{
+    entry(m_query, QueryKind::get_transient_storage).fixed(addr).fixed(key);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    return match_query() ? r.fixed<bytes32>() : bytes32{};
+}
+
+void ReplayHost::set_transient_storage(
+    const address& addr, const bytes32& key, const bytes32& value) noexcept
+{
+    entry(m_query, QueryKind::set_transient_storage).fixed(addr).fixed(key).fixed(value);
+    (void)match_query();
+}
+
+StorageLoadResult ReplayHost::load_storage(const address& addr, const bytes32& key) noexcept
+{
+    entry(m_query, QueryKind::load_storage).fixed(addr).fixed(key);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    if (!match_query())
+        return {{}, EVMC_ACCESS_COLD};
+    const auto value = r.fixed<bytes32>();
+    return {value, static_cast<evmc_access_status>(r.uint())};
+}
+
+StorageStoreResult ReplayHost::store_storage(
+    const address& addr, const bytes32& key, const bytes32& value) noexcept
+{
+    entry(m_query, QueryKind::store_storage).fixed(addr).fixed(key).fixed(value);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    if (!match_query())
+        return {EVMC_STORAGE_ASSIGNED, EVMC_ACCESS_COLD};
+    const auto status = static_cast<evmc_storage_status>(r.uint());
+    return {status, static_cast<evmc_access_status>(r.uint())};
+}
+
+AccountQueryResult ReplayHost::query_account(const address& addr) noexcept
+{
+    entry(m_query, QueryKind::query_account).fixed(addr);
+    Reader r{m_recording.log, m_pos, m_diverged};
+    AccountQueryResult result{};
+    if (!match_query())
+        return result;
+    result.access_status = static_cast<evmc_access_status>(r.uint());
+    result.exists = r.uint() != 0;
+    result.code_size = static_cast<size_t>(r.uint());
+    const auto prefix = r.data();
+    std::copy_n(
+        prefix.data(), std::min(prefix.size(), std::size(result.code_prefix)), result.code_prefix);
+    return result;
+}
+
+
+namespace
+{
+class RecordingVM : public evmc_vm
+{
+    evmc::VM& m_vm;
+    std::vector<HostRecording>& m_recordings;
+
+    static void destroy(evmc_vm* vm) noexcept { delete static_cast<RecordingVM*>(vm); }
+
+    static evmc_capabilities_flagset get_capabilities(evmc_vm* vm) noexcept
+    {
+        return static_cast<RecordingVM*>(vm)->m_vm.get_capabilities();
+    }
+
+    static evmc_result execute(evmc_vm* c_vm, const evmc_host_interface* host,
+        evmc_host_context* ctx, evmc_revision rev, const evmc_message* msg, const uint8_t* code,
+        size_t code_size) noexcept
+    {
+        auto& self = *static_cast<RecordingVM*>(c_vm);
+        auto* const vm = self.m_vm.get_raw_pointer();
+        if (msg->depth != 0)
+            return vm->execute(vm, host, ctx, rev, msg, code, code_size);
+
+        auto& rec = self.m_recordings.emplace_back();
+        rec.rev = rev;
+        rec.kind = msg->kind;
+        rec.flags = msg->flags;
+        rec.gas = msg->gas;
+        rec.recipient = msg->recipient;
+        rec.sender = msg->sender;
+        rec.input.assign(msg->input_data, msg->input_size);
+        rec.value = msg->value;
+        rec.create2_salt = msg->create2_salt;
+        rec.code_address = msg->code_address;
+        rec.code.assign(code, code_size);
+
+        RecordingHost recorder{*reinterpret_cast<const ExtendedHostInterface*>(host), ctx, rec};
+        return vm->execute(vm, &RecordingHost::get_extended_interface().evmc,
+            recorder.to_context(), rev, msg, code, code_size);
+    }
+
+public:
+    RecordingVM(evmc::VM& vm, std::vector<HostRecording>& recordings) noexcept
+      : evmc_vm{EVMC_ABI_VERSION, "recording", vm.version(), destroy, execute, get_capabilities,
+            nullptr},
+        m_vm{vm},
+        m_recordings{recordings}
+    {}
+};
+}  // namespace
+
+evmc_vm* create_recording_vm(evmc::VM& vm, std::vector<HostRecording>& recordings)
+{
+    return new RecordingVM{vm, recordings};
+}
+}  // namespace evmone::state
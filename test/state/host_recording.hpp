@@ -0,0 +1,165 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "extended_host.hpp"
+#include "hash_utils.hpp"
+#include <optional>
+#include <vector>
+
+namespace evmone::state
+{
+/// The recorded execution of a top-level message: the message, the code
+/// and the log of all host queries made during the execution together with their responses.
+///
+/// The nested calls are not recorded: they are executed by the original host and only
+/// their results are in the log.
+struct HostRecording
+{
+    evmc_revision rev = EVMC_FRONTIER;
+    evmc_call_kind kind = EVMC_CALL;
+    uint32_t flags = 0;
+    int64_t gas = 0;
+    address recipient;
+    address sender;
+    bytes input;
+    bytes32 value;
+    bytes32 create2_salt;
+    address code_address;
+    bytes code;
+
+    /// True if the evmone host interface extension has been used.
+    /// The replay must be executed with the VM having the same "host_ext" option.
+    bool host_ext = false;
+
+    /// The host queries log in the binary format.
+    bytes log;
+
+    /// Returns the recorded message. The message references the input of this recording.
+    [[nodiscard]] evmc_message message() const noexcept;
+
+    /// Serializes the recording into the compact binary format.
+    [[nodiscard]] bytes serialize() const;
+
+    /// Deserializes the recording. Returns nothing if the data is invalid.
+    [[nodiscard]] static std::optional<HostRecording> deserialize(bytes_view data);
+};
+
+/// The host wrapper recording all host queries and the responses of the wrapped host.
+class RecordingHost : public ForwardingHost
+{
+    HostRecording& m_recording;
+
+public:
+    RecordingHost(const ExtendedHostInterface& host_interface, evmc_host_context* host_context,
+        HostRecording& recording) noexcept
+      : ForwardingHost{host_interface, host_context}, m_recording{recording}
+    {}
+
+    /// Returns the extended host interface to execute messages with.
+    static const ExtendedHostInterface& get_extended_interface() noexcept;
+
+    bool account_exists(const address& addr) const noexcept override;
+    bytes32 get_storage(const address& addr, const bytes32& key) const noexcept override;
+    evmc_storage_status set_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept override;
+    evmc::uint256be get_balance(const address& addr) const noexcept override;
+    size_t get_code_size(const address& addr) const noexcept override;
+    bytes32 get_code_hash(const address& addr) const noexcept override;
+    size_t copy_code(const address& addr, size_t code_offset, uint8_t* buffer_data,
+        size_t buffer_size) const noexcept override;
+    bool selfdestruct(const address& addr, const address& beneficiary) noexcept override;
+    evmc::Result call(const evmc_message& msg) noexcept override;
+    evmc_tx_context get_tx_context() const noexcept override;
+    bytes32 get_block_hash(int64_t block_number) const noexcept override;
+    void emit_log(const address& addr, const uint8_t* data, size_t data_size,
+        const bytes32 topics[], size_t num_topics) noexcept override;
+    evmc_access_status access_account(const address& addr) noexcept override;
+    evmc_access_status access_storage(const address& addr, const bytes32& key) noexcept override;
+    bytes32 get_transient_storage(const address& addr, const bytes32& key) const noexcept override;
+    void set_transient_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept override;
+
+    StorageLoadResult load_storage(const address& addr, const bytes32& key) noexcept;
+    StorageStoreResult store_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept;
+    AccountQueryResult query_account(const address& addr) noexcept;
+};
+
+/// The host serving the responses from the recording.
+///
+/// The execution must be deterministic: the host queries must be exactly the same
+/// as recorded. Otherwise, the replay is marked as diverged and default responses are returned.
+class ReplayHost : public evmc::Host
+{
+    const HostRecording& m_recording;
+
+    /// The position of the next query in the log.
+    mutable size_t m_pos = 0;
+
+    mutable bool m_diverged = false;
+
+    /// The buffer for the encoded query.
+    mutable bytes m_query;
+
+    /// The blob hashes of the recorded transaction context.
+    mutable std::vector<bytes32> m_blob_hashes;
+
+public:
+    explicit ReplayHost(const HostRecording& recording) noexcept : m_recording{recording} {}
+
+    /// Returns the extended host interface to execute messages with.
+    static const ExtendedHostInterface& get_extended_interface() noexcept;
+
+    /// Rewinds the log to replay the execution again.
+    void reset() noexcept
+    {
+        m_pos = 0;
+        m_diverged = false;
+    }
+
+    /// Returns true if the execution has diverged from the recording.
+    [[nodiscard]] bool diverged() const noexcept { return m_diverged; }
+
+    /// Returns true if the whole log has been replayed.
+    [[nodiscard]] bool finished() const noexcept { return m_pos == m_recording.log.size(); }
+
+    bool account_exists(const address& addr) const noexcept override;
+    bytes32 get_storage(const address& addr, const bytes32& key) const noexcept override;
+    evmc_storage_status set_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept override;
+    evmc::uint256be get_balance(const address& addr) const noexcept override;
+    size_t get_code_size(const address& addr) const noexcept override;
+    bytes32 get_code_hash(const address& addr) const noexcept override;
+    size_t copy_code(const address& addr, size_t code_offset, uint8_t* buffer_data,
+        size_t buffer_size) const noexcept override;
+    bool selfdestruct(const address& addr, const address& beneficiary) noexcept override;
+    evmc::Result call(const evmc_message& msg) noexcept override;
+    evmc_tx_context get_tx_context() const noexcept override;
+    bytes32 get_block_hash(int64_t block_number) const noexcept override;
+    void emit_log(const address& addr, const uint8_t* data, size_t data_size,
+        const bytes32 topics[], size_t num_topics) noexcept override;
+    evmc_access_status access_account(const address& addr) noexcept override;
+    evmc_access_status access_storage(const address& addr, const bytes32& key) noexcept override;
+    bytes32 get_transient_storage(const address& addr, const bytes32& key) const noexcept override;
+    void set_transient_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept override;
+
+    StorageLoadResult load_storage(const address& addr, const bytes32& key) noexcept;
+    StorageStoreResult store_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept;
+    AccountQueryResult query_account(const address& addr) noexcept;
+
+private:
+    /// Checks if the next query in the log is the encoded m_query and skips it.
+    [[nodiscard]] bool match_query() const noexcept;
+};
+
+/// Creates the VM wrapper recording the top-level message executions of the wrapped VM.
+///
+/// The wrapped VM is executed with the RecordingHost for messages of depth 0
+/// and the recordings are appended to the provided vector. The wrapper must be used
+/// with the state::Host.
+evmc_vm* create_recording_vm(evmc::VM& vm, std::vector<HostRecording>& recordings);
+}  // namespace evmone::state
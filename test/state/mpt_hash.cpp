@@ -30,7 +30,7 @@ hash256 mpt_hash(const std::unordered_map<address, Account>& accounts)
     for (const auto& [addr, acc] : accounts)
     {
         trie.insert(keccak256(addr),
-            rlp::encode_tuple(acc.nonce, acc.balance, mpt_hash(acc.storage), keccak256(acc.code)));
+            rlp::encode_tuple(acc.nonce, acc.balance, mpt_hash(acc.storage), acc.code.hash()));
     }
     return trie.hash();
 }
@@ -45,6 +45,15 @@ hash256 mpt_hash(std::span<const T> list)
     return trie.hash();
 }
 
+hash256 mpt_hash_encoded(std::span<const bytes> encoded_list)
+{
+    MPT trie;
+    for (size_t i = 0; i < encoded_list.size(); ++i)
+        trie.insert(rlp::encode(i), encoded_list[i]);
+
+    return trie.hash();
+}
+
 template hash256 mpt_hash<Transaction>(std::span<const Transaction>);
 template hash256 mpt_hash<TransactionReceipt>(std::span<const TransactionReceipt>);
 template hash256 mpt_hash<Withdrawal>(std::span<const Withdrawal>);
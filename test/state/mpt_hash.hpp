@@ -18,6 +18,9 @@ hash256 mpt_hash(const std::unordered_map<address, Account>& accounts);
 template <typename T>
 hash256 mpt_hash(std::span<const T> list);
 
+/// Computes Merkle Patricia Trie root hash for the list of the already RLP-encoded items.
+hash256 mpt_hash_encoded(std::span<const bytes> encoded_list);
+
 /// A helper to automatically convert collections (e.g. vector, array) to span.
 template <typename T>
 inline hash256 mpt_hash(const T& list)
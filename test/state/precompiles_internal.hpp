@@ -0,0 +1,32 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "precompiles.hpp"
+#include <evmc/hex.hpp>
+
+namespace evmone::state
+{
+using evmc::bytes_view;
+
+/// The precompile analysis result: the gas cost and the upper bound of the output size.
+struct PrecompileAnalysis
+{
+    int64_t gas_cost;
+    size_t max_output_size;
+};
+
+PrecompileAnalysis ecrecover_analyze(bytes_view input, evmc_revision rev) noexcept;
+PrecompileAnalysis sha256_analyze(bytes_view input, evmc_revision rev) noexcept;
+PrecompileAnalysis ripemd160_analyze(bytes_view input, evmc_revision rev) noexcept;
+PrecompileAnalysis identity_analyze(bytes_view input, evmc_revision rev) noexcept;
+PrecompileAnalysis expmod_analyze(bytes_view input, evmc_revision rev) noexcept;
+PrecompileAnalysis ecadd_analyze(bytes_view input, evmc_revision rev) noexcept;
+PrecompileAnalysis ecmul_analyze(bytes_view input, evmc_revision rev) noexcept;
+PrecompileAnalysis ecpairing_analyze(bytes_view input, evmc_revision rev) noexcept;
+PrecompileAnalysis blake2bf_analyze(bytes_view input, evmc_revision rev) noexcept;
+
+ExecutionResult identity_execute(
+    const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size) noexcept;
+}  // namespace evmone::state
@@ -0,0 +1,254 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "prefetch.hpp"
+#include <evmone/baseline.hpp>
+#include <evmone/eof.hpp>
+#include <evmone/instructions_opcodes.hpp>
+#include <algorithm>
+#include <array>
+#include <optional>
+
+namespace evmone::state
+{
+namespace
+{
+constexpr bool is_push(uint8_t op) noexcept
+{
+    return op >= OP_PUSH0 && op <= OP_PUSH32;
+}
+
+/// Returns the value of the PUSH instruction at the code position
+/// or nullopt if the push data is truncated.
+std::optional<bytes32> push_value(bytes_view code, size_t pos) noexcept
+{
+    const auto push_size = static_cast<size_t>(code[pos] - OP_PUSH0);
+    if (pos + push_size >= code.size())
+        return std::nullopt;
+
+    bytes32 value;
+    std::copy_n(&code[pos + 1], push_size, &value.bytes[sizeof(value) - push_size]);
+    return value;
+}
+
+/// Returns the value as the code offset if it is a valid jump destination.
+std::optional<size_t> to_jumpdest(
+    const baseline::CodeAnalysis& analysis, const bytes32& value) noexcept
+{
+    const auto code_size = analysis.executable_code.size();
+    size_t dest = 0;
+    for (const auto b : value.bytes)
+    {
+        dest = dest * 256 + b;
+        if (dest >= code_size)
+            return std::nullopt;
+    }
+    if (!analysis.is_jumpdest(dest))
+        return std::nullopt;
+    return dest;
+}
+
+/// Checks if the instruction may access the accounts other than the recipient,
+/// including the nested executions and the value transfers.
+constexpr bool accesses_other_accounts(uint8_t op) noexcept
+{
+    switch (op)
+    {
+    case OP_BALANCE:
+    case OP_EXTCODESIZE:
+    case OP_EXTCODECOPY:
+    case OP_EXTCODEHASH:
+    case OP_CREATE:
+    case OP_CALL:
+    case OP_CALLCODE:
+    case OP_DELEGATECALL:
+    case OP_CREATE2:
+    case OP_STATICCALL:
+    case OP_SELFDESTRUCT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Records the SLOAD or SSTORE instruction with the key pushed immediately before (if any).
+void record_storage_access(
+    const address& addr, uint8_t op, const std::optional<bytes32>& key, AccessPrediction& p)
+{
+    if (key.has_value())
+    {
+        p.storage.emplace_back(addr, *key);
+        if (op == OP_SSTORE)
+            p.storage_writes.emplace_back(addr, *key);
+    }
+    else
+    {
+        auto& dynamic = op == OP_SSTORE ? p.dynamic_storage_writes : p.dynamic_storage_reads;
+        if (std::ranges::find(dynamic, addr) == dynamic.end())
+            dynamic.push_back(addr);
+    }
+}
+
+/// Collects the storage accesses of the whole legacy code.
+void collect_storage_accesses(const address& addr, bytes_view code, AccessPrediction& p)
+{
+    std::optional<bytes32> pushed;
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        const auto op = code[i];
+        if (is_push(op))
+        {
+            pushed = push_value(code, i);
+            if (!pushed.has_value())
+                break;  // Truncated push data: the value is not a valid key.
+            i += static_cast<size_t>(op - OP_PUSH0);
+            continue;
+        }
+
+        if (op == OP_SLOAD || op == OP_SSTORE)
+            record_storage_access(addr, op, pushed, p);
+        else if (accesses_other_accounts(op))
+            p.unknown_accesses = true;
+        pushed.reset();
+    }
+}
+
+/// Collects the storage accesses of the legacy code reachable from the entry point.
+///
+/// Every pushed constant being a valid jump destination is followed. This covers the static
+/// jump targets and also the return addresses of the internal function calls,
+/// which are jumped to with the targets not known statically.
+void collect_reachable_storage_accesses(const address& addr,
+    const baseline::CodeAnalysis& analysis, size_t entry, AccessPrediction& p)
+{
+    const auto code = analysis.executable_code;
+    std::vector<bool> visited(code.size());
+    std::vector<size_t> pending{entry};
+    while (!pending.empty())
+    {
+        auto i = pending.back();
+        pending.pop_back();
+
+        std::optional<bytes32> pushed;
+        for (; i < code.size() && !visited[i]; ++i)
+        {
+            visited[i] = true;
+            const auto op = code[i];
+            if (is_push(op))
+            {
+                pushed = push_value(code, i);
+                if (!pushed.has_value())
+                    break;
+                if (const auto dest = to_jumpdest(analysis, *pushed); dest.has_value())
+                    pending.push_back(*dest);
+                i += static_cast<size_t>(op - OP_PUSH0);
+                continue;
+            }
+
+            if (op == OP_SLOAD || op == OP_SSTORE)
+                record_storage_access(addr, op, pushed, p);
+            else if (accesses_other_accounts(op))
+                p.unknown_accesses = true;
+            pushed.reset();
+
+            if (op == OP_JUMP || op == OP_STOP || op == OP_RETURN || op == OP_REVERT ||
+                op == OP_INVALID || op == OP_SELFDESTRUCT)
+                break;
+        }
+    }
+}
+
+/// Finds the entry of the function in the Solidity-style selector dispatcher:
+/// PUSH selector, optional DUPn, EQ, PUSH destination, JUMPI.
+std::optional<size_t> find_function_entry(
+    const baseline::CodeAnalysis& analysis, const bytes32& selector)
+{
+    struct Instruction
+    {
+        uint8_t opcode = OP_STOP;
+        bytes32 value;
+    };
+
+    const auto code = analysis.executable_code;
+    std::array<Instruction, 4> last{};  // The preceding instructions, the most recent first.
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        const auto op = code[i];
+        if (op == OP_JUMPI && is_push(last[0].opcode) && last[1].opcode == OP_EQ)
+        {
+            const auto& sel = (last[2].opcode >= OP_DUP1 && last[2].opcode <= OP_DUP16) ?
+                                  last[3] :
+                                  last[2];
+            if (is_push(sel.opcode) && sel.opcode <= OP_PUSH4 && sel.value == selector)
+            {
+                if (const auto dest = to_jumpdest(analysis, last[0].value); dest.has_value())
+                    return dest;
+            }
+        }
+
+        std::move_backward(last.begin(), last.end() - 1, last.end());
+        last[0] = {op, {}};
+        if (is_push(op))
+        {
+            const auto value = push_value(code, i);
+            if (!value.has_value())
+                break;
+            last[0].value = *value;
+            i += static_cast<size_t>(op - OP_PUSH0);
+        }
+    }
+    return std::nullopt;
+}
+
+/// Collects the storage accesses of the legacy code executed with the call data.
+void collect_storage_accesses(
+    const address& addr, bytes_view code, bytes_view data, AccessPrediction& p)
+{
+    if (data.size() >= 4)
+    {
+        // The code is legacy (EOF is excluded by the caller): the revision does not matter.
+        const auto analysis = baseline::analyze(EVMC_CANCUN, code, true);
+        bytes32 selector;
+        std::copy_n(data.data(), 4, &selector.bytes[sizeof(selector) - 4]);
+        if (const auto entry = find_function_entry(analysis, selector); entry.has_value())
+        {
+            collect_reachable_storage_accesses(addr, analysis, *entry, p);
+            return;
+        }
+    }
+    collect_storage_accesses(addr, code, p);
+}
+}  // namespace
+
+AccessPrediction predict_accesses(const State& state, const Transaction& tx)
+{
+    AccessPrediction p;
+    p.accounts.push_back(tx.sender);
+    p.account_writes.push_back(tx.sender);
+
+    if (tx.to.has_value())
+    {
+        p.accounts.push_back(*tx.to);
+        if (tx.value != 0)
+            p.account_writes.push_back(*tx.to);
+        if (const auto* const acc = state.find(*tx.to); acc != nullptr)
+        {
+            if (const auto code = acc->code.load(); !is_eof_container(*code))
+                collect_storage_accesses(*tx.to, *code, tx.data, p);
+            else
+                p.unknown_accesses = true;
+        }
+    }
+    else
+        p.unknown_accesses = true;  // The initcode is not inspected.
+
+    for (const auto& [addr, keys] : tx.access_list)
+    {
+        p.accounts.push_back(addr);
+        for (const auto& key : keys)
+            p.storage.emplace_back(addr, key);
+    }
+    return p;
+}
+}  // namespace evmone::state
@@ -0,0 +1,47 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "state.hpp"
+#include <vector>
+
+namespace evmone::state
+{
+/// The state locations predicted to be accessed by a transaction.
+struct AccessPrediction
+{
+    std::vector<address> accounts;
+    std::vector<std::pair<address, bytes32>> storage;
+
+    /// The accounts predicted to be modified: the sender and the value transfer recipient.
+    std::vector<address> account_writes;
+
+    /// The storage slots predicted to be modified. These are also included in the storage.
+    std::vector<std::pair<address, bytes32>> storage_writes;
+
+    /// The contracts loading the storage with the keys not known statically.
+    std::vector<address> dynamic_storage_reads;
+
+    /// The contracts modifying the storage with the keys not known statically.
+    std::vector<address> dynamic_storage_writes;
+
+    /// The transaction may access any state location: the executed code is not inspected
+    /// or it may call or create other contracts, self-destruct or inspect other accounts.
+    bool unknown_accesses = false;
+};
+
+/// Predicts the state accesses of the transaction before its execution.
+///
+/// The prediction includes the sender, the recipient, the EIP-2930 access list
+/// and the storage keys statically known from the recipient code:
+/// the constants pushed immediately before SLOAD and SSTORE instructions.
+/// If the function selected by the call data is found in the Solidity-style selector dispatcher
+/// only the code reachable from the function entry is inspected, otherwise the whole code.
+///
+/// The accesses are unknown (see AccessPrediction::unknown_accesses) for contract creations,
+/// the EOF code and the inspected code having any instruction accessing other accounts
+/// (e.g. CALL, CREATE, SELFDESTRUCT or BALANCE). The reachable code is found by following
+/// the pushed constants, so the jumps to the computed destinations are not covered.
+[[nodiscard]] AccessPrediction predict_accesses(const State& state, const Transaction& tx);
+}  // namespace evmone::state
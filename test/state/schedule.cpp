@@ -0,0 +1,231 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "schedule.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <unordered_map>
+
+namespace evmone::state
+{
+namespace
+{
+using Slot = std::pair<address, bytes32>;
+
+struct SlotHash
+{
+    size_t operator()(const Slot& slot) const noexcept
+    {
+        return std::hash<address>{}(slot.first) ^ std::hash<bytes32>{}(slot.second);
+    }
+};
+
+/// The preceding transactions using a state location.
+struct LocationUsers
+{
+    std::vector<size_t> accessing;  ///< The transactions accessing (including modifying).
+    std::vector<size_t> modifying;  ///< The transactions modifying.
+};
+
+/// The state locations used by the preceding transactions.
+template <typename Key, typename Hash = std::hash<Key>>
+class LocationIndex
+{
+    std::unordered_map<Key, LocationUsers, Hash> m_users;
+
+public:
+    /// Appends the transactions conflicting with the access to the location.
+    void find_conflicts(const Key& key, bool modifying, std::vector<size_t>& out) const
+    {
+        if (const auto it = m_users.find(key); it != m_users.end())
+        {
+            const auto& txs = modifying ? it->second.accessing : it->second.modifying;
+            out.insert(out.end(), txs.begin(), txs.end());
+        }
+    }
+
+    /// Adds the transaction to the users of the location.
+    void add(const Key& key, size_t tx_index, bool modifying)
+    {
+        auto& users = m_users[key];
+        if (users.accessing.empty() || users.accessing.back() != tx_index)
+            users.accessing.push_back(tx_index);
+        if (modifying && (users.modifying.empty() || users.modifying.back() != tx_index))
+            users.modifying.push_back(tx_index);
+    }
+};
+
+std::vector<Slot> sorted_slots(const std::vector<Slot>& slots)
+{
+    auto sorted = slots;
+    std::ranges::sort(sorted);
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    return sorted;
+}
+
+bool contains(const std::vector<address>& addresses, const address& addr) noexcept
+{
+    return std::ranges::find(addresses, addr) != addresses.end();
+}
+}  // namespace
+
+ConflictGraph build_conflict_graph(std::span<const AccessPrediction> txs)
+{
+    LocationIndex<address> accounts;
+    LocationIndex<Slot, SlotHash> slots;
+    LocationIndex<address> contract_storage;  // Any storage access of the contract.
+    LocationIndex<address> dynamic_storage;   // The storage accesses with the unknown keys.
+
+    std::vector<size_t> unknown;  // The transactions with the unknown accesses.
+
+    ConflictGraph graph(txs.size());
+    for (size_t i = 0; i < txs.size(); ++i)
+    {
+        const auto& p = txs[i];
+        auto& conflicts = graph[i];
+
+        if (p.unknown_accesses)
+        {
+            // Conflicts with all the preceding transactions. The following transactions
+            // conflict with it by the unknown list so its accesses are not indexed.
+            for (size_t j = 0; j < i; ++j)
+                conflicts.push_back(j);
+            unknown.push_back(i);
+            continue;
+        }
+
+        conflicts = unknown;
+        for (const auto& addr : p.accounts)
+            accounts.find_conflicts(addr, false, conflicts);
+        for (const auto& addr : p.account_writes)
+            accounts.find_conflicts(addr, true, conflicts);
+        for (const auto& slot : p.storage)
+        {
+            slots.find_conflicts(slot, false, conflicts);
+            dynamic_storage.find_conflicts(slot.first, false, conflicts);
+        }
+        for (const auto& slot : p.storage_writes)
+        {
+            slots.find_conflicts(slot, true, conflicts);
+            dynamic_storage.find_conflicts(slot.first, true, conflicts);
+        }
+        for (const auto& addr : p.dynamic_storage_reads)
+            contract_storage.find_conflicts(addr, false, conflicts);
+        for (const auto& addr : p.dynamic_storage_writes)
+            contract_storage.find_conflicts(addr, true, conflicts);
+
+        std::ranges::sort(conflicts);
+        conflicts.erase(std::unique(conflicts.begin(), conflicts.end()), conflicts.end());
+
+        for (const auto& addr : p.accounts)
+            accounts.add(addr, i, false);
+        for (const auto& addr : p.account_writes)
+            accounts.add(addr, i, true);
+        for (const auto& slot : p.storage)
+        {
+            slots.add(slot, i, false);
+            contract_storage.add(slot.first, i, false);
+        }
+        for (const auto& slot : p.storage_writes)
+        {
+            slots.add(slot, i, true);
+            contract_storage.add(slot.first, i, true);
+        }
+        for (const auto& addr : p.dynamic_storage_reads)
+        {
+            dynamic_storage.add(addr, i, false);
+            contract_storage.add(addr, i, false);
+        }
+        for (const auto& addr : p.dynamic_storage_writes)
+        {
+            dynamic_storage.add(addr, i, true);
+            contract_storage.add(addr, i, true);
+        }
+    }
+    return graph;
+}
+
+std::vector<std::vector<size_t>> schedule_waves(const ConflictGraph& graph)
+{
+    std::vector<std::vector<size_t>> waves;
+    std::vector<size_t> tx_wave(graph.size());
+    for (size_t i = 0; i < graph.size(); ++i)
+    {
+        size_t wave = 0;
+        for (const auto j : graph[i])
+            wave = std::max(wave, tx_wave[j] + 1);
+        tx_wave[i] = wave;
+        if (wave == waves.size())
+            waves.emplace_back();
+        waves[wave].push_back(i);
+    }
+    return waves;
+}
+
+AccessPrediction observed_accesses(const Transaction& tx, const StorageHeatmap& heatmap)
+{
+    AccessPrediction p;
+    p.accounts.push_back(tx.sender);
+    p.account_writes.push_back(tx.sender);
+    if (tx.to.has_value())
+    {
+        p.accounts.push_back(*tx.to);
+        if (tx.value != 0)
+            p.account_writes.push_back(*tx.to);
+    }
+
+    for (const auto& [addr, slots] : heatmap.contracts)
+    {
+        p.accounts.push_back(addr);
+        for (const auto& [key, stats] : slots)
+        {
+            p.storage.emplace_back(addr, key);
+            if (stats.stores != 0)
+                p.storage_writes.emplace_back(addr, key);
+        }
+    }
+    return p;
+}
+
+PredictionAccuracy measure_accuracy(
+    std::span<const AccessPrediction> predicted, std::span<const AccessPrediction> observed)
+{
+    assert(predicted.size() == observed.size());
+
+    PredictionAccuracy r;
+    for (size_t i = 0; i < predicted.size(); ++i)
+    {
+        const auto& p = predicted[i];
+        const auto predicted_slots = sorted_slots(p.storage);
+        const auto observed_slots = sorted_slots(observed[i].storage);
+        r.predicted_slots += predicted_slots.size();
+        r.observed_slots += observed_slots.size();
+        for (const auto& slot : observed_slots)
+        {
+            const auto hit = std::ranges::binary_search(predicted_slots, slot);
+            r.predicted_observed_slots += hit;
+            r.covered_observed_slots += hit || p.unknown_accesses ||
+                                        contains(p.dynamic_storage_reads, slot.first) ||
+                                        contains(p.dynamic_storage_writes, slot.first);
+        }
+    }
+
+    const auto predicted_graph = build_conflict_graph(predicted);
+    const auto observed_graph = build_conflict_graph(observed);
+    for (size_t i = 0; i < predicted_graph.size(); ++i)
+    {
+        r.predicted_conflicts += predicted_graph[i].size();
+        r.observed_conflicts += observed_graph[i].size();
+
+        std::vector<size_t> missed;
+        std::ranges::set_difference(
+            observed_graph[i], predicted_graph[i], std::back_inserter(missed));
+        r.missed_conflicts += missed.size();
+    }
+    r.predicted_waves = schedule_waves(predicted_graph).size();
+    r.observed_waves = schedule_waves(observed_graph).size();
+    return r;
+}
+}  // namespace evmone::state
@@ -0,0 +1,80 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "prefetch.hpp"
+#include "storage_heatmap.hpp"
+#include <span>
+#include <vector>
+
+namespace evmone::state
+{
+/// The conflict graph of the block transactions:
+/// for every transaction the indexes of the preceding transactions it conflicts with.
+///
+/// Two transactions conflict if one of them modifies a state location the other one accesses.
+/// The storage accessed with the keys not known statically conflicts with all the storage
+/// modifications of the same contract (and vice versa).
+/// The transaction with the unknown accesses (see AccessPrediction::unknown_accesses)
+/// conflicts with all other transactions.
+/// The block coinbase receiving the fees of all transactions is not considered.
+using ConflictGraph = std::vector<std::vector<size_t>>;
+
+/// Builds the conflict graph of the transactions with the given (predicted) accesses.
+[[nodiscard]] ConflictGraph build_conflict_graph(std::span<const AccessPrediction> txs);
+
+/// Schedules the transactions into waves which may be executed in parallel, one after another.
+///
+/// Every transaction is placed in the wave following the last wave with a preceding
+/// conflicting transaction. Therefore, the transactions in a wave do not conflict
+/// and the execution in waves has the same result as the execution in the block order
+/// as long as the accesses used to build the graph cover the accesses of the execution
+/// (see predict_accesses() for the accesses not covered by the prediction).
+[[nodiscard]] std::vector<std::vector<size_t>> schedule_waves(const ConflictGraph& graph);
+
+/// Returns the state accesses of the transaction observed in the execution.
+///
+/// The storage accesses are taken from the heatmap, which must have collected
+/// only the given transaction. The value transfers by nested calls are not observed.
+[[nodiscard]] AccessPrediction observed_accesses(
+    const Transaction& tx, const StorageHeatmap& heatmap);
+
+/// The accuracy of the access predictions of the block transactions
+/// measured against the observed accesses.
+struct PredictionAccuracy
+{
+    /// The number of the storage slots accessed in the execution (per transaction).
+    size_t observed_slots = 0;
+
+    /// The number of the storage slots predicted statically (per transaction).
+    size_t predicted_slots = 0;
+
+    /// The number of the observed slots predicted statically.
+    size_t predicted_observed_slots = 0;
+
+    /// The number of the observed slots predicted statically or covered by the predicted
+    /// storage accesses with the keys not known statically.
+    size_t covered_observed_slots = 0;
+
+    /// The number of the conflicting transaction pairs observed.
+    size_t observed_conflicts = 0;
+
+    /// The number of the conflicting transaction pairs predicted.
+    size_t predicted_conflicts = 0;
+
+    /// The number of the observed conflicts not predicted.
+    /// The transactions of these pairs must be re-executed.
+    size_t missed_conflicts = 0;
+
+    /// The number of waves scheduled with the predicted accesses.
+    size_t predicted_waves = 0;
+
+    /// The number of waves scheduled with the observed accesses.
+    size_t observed_waves = 0;
+};
+
+/// Measures the accuracy of the predicted accesses of the transactions.
+[[nodiscard]] PredictionAccuracy measure_accuracy(
+    std::span<const AccessPrediction> predicted, std::span<const AccessPrediction> observed);
+}  // namespace evmone::state
@@ -9,6 +9,11 @@
 #include "rlp.hpp"
 #include <evmone/evmone.h>
 #include <evmone/execution_state.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <future>
+#include <thread>
 
 namespace evmone::state
 {
@@ -19,14 +24,36 @@ inline constexpr int64_t num_words(size_t size_in_bytes) noexcept
     return static_cast<int64_t>((size_in_bytes + 31) / 32);
 }
 
+/// Counts the zero bytes in the data.
+///
+/// The data is processed in 8-byte words (SWAR): the high bit of every byte is set
+/// if the byte is non-zero and the zero bytes are the remaining unset high bits.
+size_t count_zero_bytes(bytes_view data) noexcept
+{
+    static constexpr uint64_t low_bits = 0x7f7f7f7f7f7f7f7f;
+    static constexpr size_t word_size = sizeof(uint64_t);
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + word_size <= data.size(); i += word_size)
+    {
+        uint64_t w = 0;
+        std::memcpy(&w, &data[i], word_size);
+        const auto nonzero_high_bits = (((w & low_bits) + low_bits) | w) & ~low_bits;
+        count += word_size - static_cast<size_t>(std::popcount(nonzero_high_bits));
+    }
+    for (; i < data.size(); ++i)
+        count += data[i] == 0;
+    return count;
+}
+
 int64_t compute_tx_data_cost(evmc_revision rev, bytes_view data) noexcept
 {
     constexpr int64_t zero_byte_cost = 4;
     const int64_t nonzero_byte_cost = rev >= EVMC_ISTANBUL ? 16 : 68;
-    int64_t cost = 0;
-    for (const auto b : data)
-        cost += (b == 0) ? zero_byte_cost : nonzero_byte_cost;
-    return cost;
+    const auto num_zero_bytes = static_cast<int64_t>(count_zero_bytes(data));
+    const auto num_nonzero_bytes = static_cast<int64_t>(data.size()) - num_zero_bytes;
+    return num_zero_bytes * zero_byte_cost + num_nonzero_bytes * nonzero_byte_cost;
 }
 
 int64_t compute_access_list_cost(const AccessList& access_list) noexcept
@@ -135,12 +162,100 @@ std::variant<int64_t, std::error_code> validate_transaction(const Account& sende
     return execution_gas_limit;
 }
 
+std::vector<TransactionValidation> validate_transactions(const State& state,
+    const BlockInfo& block, std::span<const Transaction> txs, evmc_revision rev,
+    unsigned num_threads)
+{
+    std::vector<TransactionValidation> results(txs.size());
+
+    const auto validate = [&](size_t begin, size_t end) noexcept {
+        const Account empty_account;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const auto* const sender_acc = state.find(txs[i].sender);
+            const auto r = validate_transaction(sender_acc != nullptr ? *sender_acc : empty_account,
+                block, txs[i], rev, block.gas_limit);
+            if (holds_alternative<std::error_code>(r))
+                results[i].error = static_cast<ErrorCode>(get<std::error_code>(r).value());
+            else
+                results[i].execution_gas_limit = get<int64_t>(r);
+        }
+    };
+
+    if (num_threads == 0)
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    const auto chunk_size = (txs.size() + num_threads - 1) / num_threads;
+
+    // The first chunk is validated by the calling thread.
+    std::vector<std::future<void>> workers;
+    for (size_t begin = chunk_size; begin < txs.size(); begin += chunk_size)
+    {
+        workers.emplace_back(std::async(
+            std::launch::async, validate, begin, std::min(begin + chunk_size, txs.size())));
+    }
+    validate(0, std::min(chunk_size, txs.size()));
+    for (auto& w : workers)
+        w.wait();
+    return results;
+}
+
+void State::commit()
+{
+    assert(m_parent != nullptr);
+    for (const auto& addr : m_erased)
+    {
+        m_parent->m_accounts.erase(addr);
+        m_parent->m_storage_overlays.erase(addr);
+        if (m_parent->m_parent != nullptr)
+            m_parent->m_erased.insert(addr);
+    }
+    for (auto& [addr, acc] : m_accounts)
+    {
+        const auto dirty = std::exchange(acc.dirty, false);
+        if (!m_storage_overlays.contains(addr))
+            m_parent->m_storage_overlays.erase(addr);
+        else if (const auto it = m_parent->m_accounts.find(addr); it != m_parent->m_accounts.end())
+        {
+            // Merge the slots copied to the fork into the parent's account storage.
+            auto storage = std::move(it->second.storage);
+            for (const auto& [key, value] : acc.storage)
+                storage.insert_or_assign(key, value);
+            acc.storage = std::move(storage);
+        }
+        else
+        {
+            // The account is in the further ancestor so the parent becomes the overlay.
+            assert(m_parent->m_parent != nullptr);
+            m_parent->m_storage_overlays.insert(addr);
+        }
+        auto& parent_acc =
+            m_parent->m_accounts.insert_or_assign(addr, std::move(acc)).first->second;
+        m_parent->m_erased.erase(addr);
+        if (dirty)
+            m_parent->mark_dirty(addr, parent_acc);
+    }
+    m_accounts.clear();
+    m_erased.clear();
+    m_storage_overlays.clear();
+    m_dirty.clear();
+}
+
+void State::set_code_store(std::shared_ptr<CodeStore> code_store)
+{
+    m_code_store = std::move(code_store);
+    if (m_code_store == nullptr)
+        return;
+    for (auto& [_, acc] : m_accounts)
+        acc.code = m_code_store->intern(acc.code);
+}
+
 namespace
 {
 /// Deletes "touched" (marked as erasable) empty accounts in the state.
+/// Only the dirty accounts are checked: the account must be modified to become erasable.
 void delete_empty_accounts(State& state)
 {
-    std::erase_if(state.get_accounts(), [](const std::pair<const address, Account>& p) noexcept {
+    state.erase_dirty_if([](const std::pair<const address, Account>& p) noexcept {
         const auto& acc = p.second;
         return acc.erasable && acc.is_empty();
     });
@@ -176,7 +291,8 @@ void finalize(State& state, evmc_revision rev, const address& coinbase,
 }
 
 std::variant<TransactionReceipt, std::error_code> transition(State& state, const BlockInfo& block,
-    const Transaction& tx, evmc_revision rev, evmc::VM& vm, int64_t block_gas_left)
+    const Transaction& tx, evmc_revision rev, evmc::VM& vm, int64_t block_gas_left,
+    StaticCallMemo* static_call_memo, TransientStorage* transient_storage)
 {
     auto* sender_ptr = state.find(tx.sender);
 
@@ -207,7 +323,7 @@ std::variant<TransactionReceipt, std::error_code> transition(State& state, const
 
     sender_acc.balance -= tx_max_cost;  // Modify sender balance after all checks.
 
-    Host host{rev, vm, state, block, tx};
+    Host host{rev, vm, state, block, tx, static_call_memo, transient_storage};
 
     sender_acc.access_status = EVMC_ACCESS_WARM;  // Tx sender is always warm.
     if (tx.to.has_value())
@@ -215,9 +331,8 @@ std::variant<TransactionReceipt, std::error_code> transition(State& state, const
     for (const auto& [a, storage_keys] : tx.access_list)
     {
         host.access_account(a);  // TODO: Return account ref.
-        auto& storage = state.get(a).storage;
         for (const auto& key : storage_keys)
-            storage[key].access_status = EVMC_ACCESS_WARM;
+            state.get_storage(a, key).access_status = EVMC_ACCESS_WARM;
     }
     // EIP-3651: Warm COINBASE.
     // This may create an empty coinbase account. The account cannot be created unconditionally
@@ -239,7 +354,7 @@ std::variant<TransactionReceipt, std::error_code> transition(State& state, const
     state.touch(block.coinbase).balance += gas_used * priority_gas_price;
 
     // Apply destructs.
-    std::erase_if(state.get_accounts(),
+    state.erase_dirty_if(
         [](const std::pair<const address, Account>& p) noexcept { return p.second.destructed; });
 
     // Cumulative gas used is unknown in this scope.
@@ -254,16 +369,16 @@ std::variant<TransactionReceipt, std::error_code> transition(State& state, const
     if (rev >= EVMC_SPURIOUS_DRAGON)
         delete_empty_accounts(state);
 
-    // Set accounts and their storage access status to cold in the end of transition process
-    for (auto& acc : state.get_accounts())
-    {
-        acc.second.access_status = EVMC_ACCESS_COLD;
-        for (auto& [_, val] : acc.second.storage)
+    // Set accounts and their storage access status to cold in the end of transition process.
+    // Only the dirty accounts may have been accessed.
+    state.clean([](Account& acc) noexcept {
+        acc.access_status = EVMC_ACCESS_COLD;
+        for (auto& [_, val] : acc.storage)
         {
             val.access_status = EVMC_ACCESS_COLD;
             val.original = val.current;
         }
-    }
+    });
 
     return receipt;
 }
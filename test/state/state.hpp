@@ -6,37 +6,127 @@
 
 #include "account.hpp"
 #include "bloom_filter.hpp"
+#include "errors.hpp"
 #include "hash_utils.hpp"
 #include <cassert>
 #include <optional>
+#include <span>
+#include <unordered_set>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace evmone::state
 {
+/// The world state.
+///
+/// The accounts accessed for modification (with mutable find() or insert()) are recorded
+/// as dirty, so the end-of-transaction processing only visits these instead of the whole state.
+///
+/// The state can be forked: the child state records the modifications on top of
+/// the parent state. The accounts are copied from the parent on the first access and
+/// erased accounts are recorded as tombstones, so the cost of the child is proportional
+/// to the number of accounts it accesses. The child is either committed to the parent
+/// or discarded (destroyed). The child can be forked further.
 class State
 {
     std::unordered_map<address, Account> m_accounts;
 
+    /// The parent state of the fork. Null for the root state.
+    State* m_parent = nullptr;
+
+    /// The accounts of the parent state erased in this fork.
+    std::unordered_set<address> m_erased;
+
+    /// The accounts copied from the parent state whose storage only has the slots
+    /// accessed in this fork. The other slots are read from the parent state.
+    std::unordered_set<address> m_storage_overlays;
+
+    /// The store deduplicating the account code. Null if not used.
+    std::shared_ptr<CodeStore> m_code_store;
+
+    /// The addresses of the dirty accounts (see Account::dirty) in the order of the first access.
+    /// The accounts may have been erased since. The address is listed again
+    /// if the account has been erased and inserted again.
+    std::vector<address> m_dirty;
+
+    void mark_dirty(const address& addr, Account& acc)
+    {
+        if (!std::exchange(acc.dirty, true))
+            m_dirty.push_back(addr);
+    }
+
+    /// Returns the pointer to the account in this state or its ancestors without
+    /// copying the account to this state.
+    [[nodiscard]] const Account* find_in_ancestors(const address& addr) const noexcept
+    {
+        for (auto* st = this; st != nullptr; st = st->m_parent)
+        {
+            if (const auto it = st->m_accounts.find(addr); it != st->m_accounts.end())
+                return &it->second;
+            if (st->m_erased.contains(addr))
+                break;
+        }
+        return nullptr;
+    }
+
 public:
     /// Inserts the new account at the address.
     /// There must not exist any account under this address before.
     Account& insert(const address& addr, Account account = {})
     {
+        assert(m_parent == nullptr || find_in_ancestors(addr) == nullptr);
+        account.dirty = false;
         const auto r = m_accounts.insert({addr, std::move(account)});
         assert(r.second);
+        if (m_parent != nullptr)
+        {
+            m_erased.erase(addr);
+            m_storage_overlays.erase(addr);
+        }
+        mark_dirty(addr, r.first->second);
         return r.first->second;
     }
 
     /// Returns the pointer to the account at the address if the account exists. Null otherwise.
+    ///
+    /// The account is marked dirty.
+    /// In the forked state the account existing in the parent state is copied to the fork
+    /// without the storage (see get_storage()).
     Account* find(const address& addr) noexcept
     {
         const auto it = m_accounts.find(addr);
         if (it != m_accounts.end())
+        {
+            mark_dirty(it->first, it->second);
             return &it->second;
+        }
+        if (m_parent != nullptr && !m_erased.contains(addr))
+        {
+            if (const auto* const acc = m_parent->find_in_ancestors(addr); acc != nullptr)
+            {
+                // The storage slots are copied on access (see get_storage()).
+                Account header{.nonce = acc->nonce,
+                    .balance = acc->balance,
+                    .code = acc->code,
+                    .destructed = acc->destructed,
+                    .erasable = acc->erasable,
+                    .access_status = acc->access_status};
+                auto& copy = m_accounts.emplace(addr, std::move(header)).first->second;
+                m_storage_overlays.insert(addr);
+                mark_dirty(addr, copy);
+                return &copy;
+            }
+        }
         return nullptr;
     }
 
+    /// Returns the pointer to the account at the address if the account exists. Null otherwise.
+    [[nodiscard]] const Account* find(const address& addr) const noexcept
+    {
+        return find_in_ancestors(addr);
+    }
+
     /// Gets the account at the address (the account must exist).
     Account& get(const address& addr) noexcept
     {
@@ -53,6 +143,45 @@ public:
         return insert(addr, std::move(account));
     }
 
+    /// Gets the storage slot of the existing account. The missing slot is inserted empty.
+    ///
+    /// In the forked state only this slot is copied from the parent state.
+    StorageValue& get_storage(const address& addr, const bytes32& key)
+    {
+        const auto [it, inserted] = get(addr).storage.try_emplace(key);
+        if (inserted && m_storage_overlays.contains(addr))
+        {
+            if (const auto* const slot = m_parent->find_storage(addr, key); slot != nullptr)
+                it->second = *slot;
+        }
+        return it->second;
+    }
+
+    /// Returns the pointer to the storage slot of the account if the slot exists.
+    /// Null otherwise.
+    [[nodiscard]] const StorageValue* find_storage(
+        const address& addr, const bytes32& key) const noexcept
+    {
+        for (auto* st = this; st != nullptr; st = st->m_parent)
+        {
+            if (const auto it = st->m_accounts.find(addr); it != st->m_accounts.end())
+            {
+                const auto& storage = it->second.storage;
+                if (const auto slot = storage.find(key); slot != storage.end())
+                    return &slot->second;
+                if (!st->m_storage_overlays.contains(addr))
+                    break;
+            }
+            else if (st->m_erased.contains(addr))
+                break;
+        }
+        return nullptr;
+    }
+
+    /// Hides the storage slots of the account not yet copied from the parent state.
+    /// Used when the account storage is cleared: the remaining slots read as empty.
+    void discard_parent_storage(const address& addr) noexcept { m_storage_overlays.erase(addr); }
+
     /// Touches (as in EIP-161) an existing account or inserts new erasable account.
     Account& touch(const address& addr)
     {
@@ -61,6 +190,94 @@ public:
         return acc;
     }
 
+    /// Erases the accounts in this state matching the predicate.
+    ///
+    /// In the forked state only the accounts already copied to the fork are checked.
+    template <typename Predicate>
+    void erase_if(Predicate pred)
+    {
+        for (auto it = m_accounts.begin(); it != m_accounts.end();)
+        {
+            if (pred(*it))
+            {
+                if (m_parent != nullptr)
+                {
+                    m_erased.insert(it->first);
+                    m_storage_overlays.erase(it->first);
+                }
+                it = m_accounts.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
+    /// Erases the dirty accounts matching the predicate.
+    template <typename Predicate>
+    void erase_dirty_if(Predicate pred)
+    {
+        for (const auto& addr : m_dirty)
+        {
+            if (const auto it = m_accounts.find(addr); it != m_accounts.end() && pred(*it))
+            {
+                if (m_parent != nullptr)
+                {
+                    m_erased.insert(addr);
+                    m_storage_overlays.erase(addr);
+                }
+                m_accounts.erase(it);
+            }
+        }
+    }
+
+    /// Applies the function to the dirty accounts and marks them clean.
+    template <typename Fn>
+    void clean(Fn fn)
+    {
+        for (const auto& addr : m_dirty)
+        {
+            if (const auto it = m_accounts.find(addr); it != m_accounts.end())
+            {
+                it->second.dirty = false;
+                fn(it->second);
+            }
+        }
+        m_dirty.clear();
+    }
+
+    /// Returns the number of the dirty accounts (including the erased ones).
+    [[nodiscard]] size_t num_dirty() const noexcept { return m_dirty.size(); }
+
+    /// Creates the child state recording the modifications on top of this state.
+    ///
+    /// This state must outlive the child and must not be modified
+    /// until the child is committed or discarded.
+    [[nodiscard]] State fork() noexcept
+    {
+        State child;
+        child.m_parent = this;
+        child.m_code_store = m_code_store;
+        return child;
+    }
+
+    /// Applies the modifications of the forked state to its parent state.
+    /// The forked state becomes empty (as freshly forked) and can be reused.
+    void commit();
+
+    /// Sets the store deduplicating the code of the accounts.
+    /// The code of the accounts already in this state is interned in the store.
+    void set_code_store(std::shared_ptr<CodeStore> code_store);
+
+    /// Creates the code for an account of this state (interned in the code store if set).
+    [[nodiscard]] Code make_code(bytes_view code) const
+    {
+        return m_code_store != nullptr ? m_code_store->intern(code) : Code{code};
+    }
+
+    /// Returns the accounts of the state.
+    ///
+    /// For the forked state these are only the accounts copied to the fork
+    /// and their storage has only the slots copied to the fork.
     [[nodiscard]] auto& get_accounts() noexcept { return m_accounts; }
 
     [[nodiscard]] const auto& get_accounts() const noexcept { return m_accounts; }
@@ -182,14 +399,44 @@ void finalize(State& state, evmc_revision rev, const address& coinbase,
     std::optional<uint64_t> block_reward, std::span<Ommer> ommers,
     std::span<Withdrawal> withdrawals);
 
+class StaticCallMemo;
+class TransientStorage;
+
+/// Executes the transaction.
+///
+/// @param static_call_memo   The optional memo table for the repeated STATICCALLs.
+///                           It is cleared before the execution.
+/// @param transient_storage  The optional transient storage to reuse the memory
+///                           of the previous transactions. It is cleared before the execution.
 [[nodiscard]] std::variant<TransactionReceipt, std::error_code> transition(State& state,
     const BlockInfo& block, const Transaction& tx, evmc_revision rev, evmc::VM& vm,
-    int64_t block_gas_left);
+    int64_t block_gas_left, StaticCallMemo* static_call_memo = nullptr,
+    TransientStorage* transient_storage = nullptr);
 
 std::variant<int64_t, std::error_code> validate_transaction(const Account& sender_acc,
     const BlockInfo& block, const Transaction& tx, evmc_revision rev,
     int64_t block_gas_left) noexcept;
 
+/// The compact result of the transaction validation.
+struct TransactionValidation
+{
+    /// The execution gas limit of the valid transaction.
+    int64_t execution_gas_limit = 0;
+
+    ErrorCode error = SUCCESS;
+};
+
+/// Validates the transactions independently against the read-only state in parallel,
+/// e.g. for the mempool admission.
+///
+/// Every transaction is validated as the first one in the block.
+/// The state must not be modified during the validation.
+///
+/// @param num_threads  The number of threads to use. Zero means the hardware concurrency.
+[[nodiscard]] std::vector<TransactionValidation> validate_transactions(const State& state,
+    const BlockInfo& block, std::span<const Transaction> txs, evmc_revision rev,
+    unsigned num_threads = 0);
+
 /// Defines how to RLP-encode a Transaction.
 [[nodiscard]] bytes rlp_encode(const Transaction& tx);
 
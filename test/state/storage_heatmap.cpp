@@ -0,0 +1,206 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "storage_heatmap.hpp"
+#include "extended_host.hpp"
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+namespace evmone::state
+{
+namespace
+{
+using SlotStats = StorageHeatmap::SlotStats;
+
+uint64_t accesses(const SlotStats& s) noexcept
+{
+    return s.loads + s.stores;
+}
+
+void add(SlotStats& total, const SlotStats& s) noexcept
+{
+    total.loads += s.loads;
+    total.stores += s.stores;
+    total.cold_accesses += s.cold_accesses;
+    total.warm_accesses += s.warm_accesses;
+}
+
+/// Outputs the statistics as the CSV columns: loads,stores,cold,warm.
+std::ostream& write_csv(std::ostream& out, const SlotStats& s)
+{
+    return out << s.loads << ',' << s.stores << ',' << s.cold_accesses << ','
+               << s.warm_accesses;
+}
+
+/// Sorts the rows by the number of accesses (descending) and leaves the top_k of them.
+/// The ties are ordered by the row id() to make the report deterministic.
+template <typename Row>
+void select_top(std::vector<Row>& rows, size_t top_k)
+{
+    const auto top_end = rows.begin() + static_cast<ptrdiff_t>(std::min(top_k, rows.size()));
+    std::partial_sort(rows.begin(), top_end, rows.end(), [](const Row& a, const Row& b) {
+        const auto a_accesses = accesses(a.stats);
+        const auto b_accesses = accesses(b.stats);
+        return a_accesses != b_accesses ? a_accesses > b_accesses : a.id() < b.id();
+    });
+    rows.erase(top_end, rows.end());
+}
+
+/// The host wrapper counting the storage accesses of the wrapped host.
+class HeatmapHost : public ForwardingHost
+{
+    StorageHeatmap& m_heatmap;
+
+public:
+    HeatmapHost(const ExtendedHostInterface& host_interface, evmc_host_context* host_context,
+        StorageHeatmap& heatmap) noexcept
+      : ForwardingHost{host_interface, host_context}, m_heatmap{heatmap}
+    {}
+
+    bytes32 get_storage(const address& addr, const bytes32& key) const noexcept override
+    {
+        m_heatmap.record_load(addr, key);
+        return m_host.get_storage(addr, key);
+    }
+
+    evmc_storage_status set_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept override
+    {
+        m_heatmap.record_store(addr, key);
+        return m_host.set_storage(addr, key, value);
+    }
+
+    evmc_access_status access_storage(const address& addr, const bytes32& key) noexcept override
+    {
+        const auto r = m_host.access_storage(addr, key);
+        m_heatmap.record_access(addr, key, r);
+        return r;
+    }
+
+    StorageLoadResult load_storage(const address& addr, const bytes32& key) noexcept
+    {
+        const auto r = ForwardingHost::load_storage(addr, key);
+        m_heatmap.record_load(addr, key);
+        m_heatmap.record_access(addr, key, r.access_status);
+        return r;
+    }
+
+    StorageStoreResult store_storage(
+        const address& addr, const bytes32& key, const bytes32& value) noexcept
+    {
+        const auto r = ForwardingHost::store_storage(addr, key, value);
+        m_heatmap.record_store(addr, key);
+        m_heatmap.record_access(addr, key, r.access_status);
+        return r;
+    }
+};
+
+class StorageHeatmapVM : public evmc_vm
+{
+    evmc::VM& m_vm;
+    StorageHeatmap& m_heatmap;
+
+    static void destroy(evmc_vm* vm) noexcept { delete static_cast<StorageHeatmapVM*>(vm); }
+
+    static evmc_capabilities_flagset get_capabilities(evmc_vm* vm) noexcept
+    {
+        return static_cast<StorageHeatmapVM*>(vm)->m_vm.get_capabilities();
+    }
+
+    static evmc_result execute(evmc_vm* c_vm, const evmc_host_interface* host,
+        evmc_host_context* ctx, evmc_revision rev, const evmc_message* msg, const uint8_t* code,
+        size_t code_size) noexcept
+    {
+        auto& self = *static_cast<StorageHeatmapVM*>(c_vm);
+        auto* const vm = self.m_vm.get_raw_pointer();
+
+        // The nested messages are executed by the state::Host with this VM again
+        // so all the depths are wrapped.
+        HeatmapHost heatmap_host{
+            *reinterpret_cast<const ExtendedHostInterface*>(host), ctx, self.m_heatmap};
+        return vm->execute(vm, &extended_interface<HeatmapHost>().evmc,
+            heatmap_host.to_context(), rev, msg, code, code_size);
+    }
+
+public:
+    StorageHeatmapVM(evmc::VM& vm, StorageHeatmap& heatmap) noexcept
+      : evmc_vm{EVMC_ABI_VERSION, "storage-heatmap", vm.version(), destroy, execute,
+            get_capabilities, nullptr},
+        m_vm{vm},
+        m_heatmap{heatmap}
+    {}
+};
+}  // namespace
+
+void StorageHeatmap::merge(const StorageHeatmap& other)
+{
+    for (const auto& [addr, slots] : other.contracts)
+    {
+        auto& contract = contracts[addr];
+        for (const auto& [key, stats] : slots)
+            add(contract[key], stats);
+    }
+}
+
+void StorageHeatmap::report(std::ostream& out, size_t top_k) const
+{
+    struct ContractRow
+    {
+        address addr;
+        size_t slots = 0;
+        SlotStats stats;
+
+        [[nodiscard]] auto id() const noexcept { return std::tie(addr); }
+    };
+    struct SlotRow
+    {
+        address addr;
+        bytes32 key;
+        SlotStats stats;
+
+        [[nodiscard]] auto id() const noexcept { return std::tie(addr, key); }
+    };
+
+    std::vector<ContractRow> contract_rows;
+    std::vector<SlotRow> slot_rows;
+    SlotStats total;
+    for (const auto& [addr, slots] : contracts)
+    {
+        auto& c = contract_rows.emplace_back(ContractRow{addr, slots.size(), {}});
+        for (const auto& [key, stats] : slots)
+        {
+            add(c.stats, stats);
+            slot_rows.push_back({addr, key, stats});
+        }
+        add(total, c.stats);
+    }
+    const auto num_slots = slot_rows.size();
+    select_top(contract_rows, top_k);
+    select_top(slot_rows, top_k);
+
+    out << "--- # STORAGE HEATMAP contracts=" << contracts.size() << " slots=" << num_slots
+        << "\nloads,stores,cold,warm\n";
+    write_csv(out, total) << '\n';
+
+    out << "--- # STORAGE HEATMAP top contracts\ncontract,slots,loads,stores,cold,warm\n";
+    for (const auto& r : contract_rows)
+    {
+        out << r.addr << ',' << r.slots << ',';
+        write_csv(out, r.stats) << '\n';
+    }
+
+    out << "--- # STORAGE HEATMAP top slots\ncontract,slot,loads,stores,cold,warm\n";
+    for (const auto& r : slot_rows)
+    {
+        out << r.addr << ',' << r.key << ',';
+        write_csv(out, r.stats) << '\n';
+    }
+}
+
+evmc_vm* create_storage_heatmap_vm(evmc::VM& vm, StorageHeatmap& heatmap)
+{
+    return new StorageHeatmapVM{vm, heatmap};
+}
+}  // namespace evmone::state
@@ -0,0 +1,64 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "hash_utils.hpp"
+#include <evmc/evmc.hpp>
+#include <ostream>
+#include <unordered_map>
+
+namespace evmone::state
+{
+/// The storage access statistics aggregated per storage slot.
+///
+/// The exact table is used: the number of distinct slots accessed in a t8n run
+/// is small enough not to need a probabilistic sketch.
+class StorageHeatmap
+{
+public:
+    struct SlotStats
+    {
+        uint64_t loads = 0;
+        uint64_t stores = 0;
+
+        /// The number of the cold and warm accesses (as reported by the host).
+        uint64_t cold_accesses = 0;
+        uint64_t warm_accesses = 0;
+    };
+
+    /// The statistics of the accessed slots per contract address.
+    std::unordered_map<address, std::unordered_map<bytes32, SlotStats>> contracts;
+
+    void record_load(const address& addr, const bytes32& key) noexcept
+    {
+        ++contracts[addr][key].loads;
+    }
+
+    void record_store(const address& addr, const bytes32& key) noexcept
+    {
+        ++contracts[addr][key].stores;
+    }
+
+    void record_access(
+        const address& addr, const bytes32& key, evmc_access_status status) noexcept
+    {
+        auto& s = contracts[addr][key];
+        ++(status == EVMC_ACCESS_COLD ? s.cold_accesses : s.warm_accesses);
+    }
+
+    /// Adds the statistics collected in the other heatmap.
+    void merge(const StorageHeatmap& other);
+
+    /// Outputs the report in CSV format: the totals per contract and per slot
+    /// of the top_k most accessed (loads + stores) contracts and slots.
+    void report(std::ostream& out, size_t top_k) const;
+};
+
+/// Creates the VM wrapper collecting the storage access statistics of all executed messages
+/// into the heatmap.
+///
+/// The wrapped VM must use the host interface extension (the "host_ext" option)
+/// and the wrapper must be used with the state::Host.
+evmc_vm* create_storage_heatmap_vm(evmc::VM& vm, StorageHeatmap& heatmap);
+}  // namespace evmone::state
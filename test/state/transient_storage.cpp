@@ -0,0 +1,95 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "transient_storage.hpp"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace evmone::state
+{
+namespace
+{
+/// The minimal non-zero capacity of the table.
+constexpr size_t min_capacity = 16;
+
+size_t hash(const address& addr, const bytes32& key) noexcept
+{
+    const auto h = std::hash<bytes32>{}(key);
+    return h ^ (std::hash<address>{}(addr) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2));
+}
+}  // namespace
+
+size_t TransientStorage::find(const address& addr, const bytes32& key) const noexcept
+{
+    assert(!m_entries.empty());
+    const auto mask = m_entries.size() - 1;
+    // The load factor is kept below 1/2 so the loop always finds an unused entry.
+    for (auto index = hash(addr, key) & mask;; index = (index + 1) & mask)
+    {
+        if (const auto& e = m_entries[index];
+            e.generation != m_generation || (e.key == key && e.addr == addr))
+            return index;
+    }
+}
+
+void TransientStorage::grow()
+{
+    const auto old_entries =
+        std::exchange(m_entries, std::vector<Entry>(std::max(m_entries.size() * 2, min_capacity)));
+    for (const auto& e : old_entries)
+    {
+        if (e.generation == m_generation)
+            m_entries[find(e.addr, e.key)] = e;
+    }
+}
+
+bytes32 TransientStorage::get(const address& addr, const bytes32& key) const noexcept
+{
+    if (m_entries.empty())
+        return {};
+    const auto& e = m_entries[find(addr, key)];
+    return e.generation == m_generation ? e.value : bytes32{};
+}
+
+void TransientStorage::set(const address& addr, const bytes32& key, const bytes32& value)
+{
+    if ((m_size + 1) * 2 > m_entries.size())
+        grow();
+
+    auto& e = m_entries[find(addr, key)];
+    if (e.generation != m_generation)
+    {
+        e = {addr, key, {}, m_generation};
+        ++m_size;
+    }
+    m_journal.push_back({addr, key, e.value});
+    e.value = value;
+}
+
+void TransientStorage::rollback(size_t checkpoint) noexcept
+{
+    assert(checkpoint <= m_journal.size());
+    // The entries are never removed so the reverted ones keep the zero value.
+    for (auto i = m_journal.size(); i-- > checkpoint;)
+    {
+        const auto& j = m_journal[i];
+        m_entries[find(j.addr, j.key)].value = j.prev_value;
+    }
+    m_journal.resize(checkpoint);
+}
+
+void TransientStorage::clear() noexcept
+{
+    m_journal.clear();
+    m_size = 0;
+
+    // Reset the entries only when the generation number wraps around.
+    if (++m_generation == 0) [[unlikely]]
+    {
+        std::ranges::fill(m_entries, Entry{});
+        m_generation = 1;
+    }
+}
+}  // namespace evmone::state
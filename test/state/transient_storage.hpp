@@ -0,0 +1,76 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <evmc/evmc.hpp>
+#include <vector>
+
+namespace evmone::state
+{
+using evmc::address;
+using evmc::bytes32;
+
+/// The EIP-1153 transient storage of a transaction.
+///
+/// The storage of all accounts is kept in a single flat hash table (open addressing
+/// with linear probing) keyed by the (address, key) pair. The entries are tagged with
+/// the generation number so the whole storage is cleared in O(1) by advancing the generation.
+/// The writes are journaled and can be rolled back to a checkpoint when a call is reverted.
+class TransientStorage
+{
+    struct Entry
+    {
+        address addr;
+        bytes32 key;
+        bytes32 value;
+
+        /// The entry is in use if it has the current generation number.
+        uint32_t generation = 0;
+    };
+
+    struct JournalEntry
+    {
+        address addr;
+        bytes32 key;
+        bytes32 prev_value;
+    };
+
+    /// The hash table of the size being a power of 2 (or empty before the first write).
+    std::vector<Entry> m_entries;
+
+    /// The number of the entries in use.
+    size_t m_size = 0;
+
+    /// The current generation number. Never zero so the value-initialized entries are unused.
+    uint32_t m_generation = 1;
+
+    std::vector<JournalEntry> m_journal;
+
+    /// Returns the index of the entry for the key or of the unused entry to insert the key to.
+    /// The table must not be empty.
+    [[nodiscard]] size_t find(const address& addr, const bytes32& key) const noexcept;
+
+    /// Doubles the capacity of the table.
+    void grow();
+
+public:
+    /// Returns the value of the transient storage slot (zero if not set).
+    [[nodiscard]] bytes32 get(const address& addr, const bytes32& key) const noexcept;
+
+    /// Sets the value of the transient storage slot. The previous value is journaled.
+    void set(const address& addr, const bytes32& key, const bytes32& value);
+
+    /// Returns the checkpoint of the journal to roll back to.
+    [[nodiscard]] size_t checkpoint() const noexcept { return m_journal.size(); }
+
+    /// Reverts all the writes made after the checkpoint.
+    void rollback(size_t checkpoint) noexcept;
+
+    /// Clears the storage and the journal. The allocated memory is kept for reuse.
+    void clear() noexcept;
+
+    /// Returns the number of the slots written since the last clear().
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+};
+}  // namespace evmone::state
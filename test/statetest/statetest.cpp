@@ -89,7 +89,7 @@ int main(int argc, char* argv[])
 
         CLI11_PARSE(app, argc, argv);
 
-        evmc::VM vm{evmc_create_evmone(), {{"O", "0"}}};
+        evmc::VM vm{evmc_create_evmone(), {{"O", "0"}, {"host_ext", ""}}};
 
         if (trace)
             vm.set_option("trace", "1");
@@ -389,11 +389,11 @@ void validate_deployed_code(const state::State& state, evmc_revision rev)
 {
     for (const auto& [addr, acc] : state.get_accounts())
     {
-        if (is_eof_container(acc.code))
+        if (const auto code = acc.code.load(); is_eof_container(*code))
         {
             if (rev >= EVMC_PRAGUE)
             {
-                if (const auto result = validate_eof(rev, acc.code);
+                if (const auto result = validate_eof(rev, *code);
                     result != EOFValidationError::success)
                 {
                     throw std::invalid_argument(
@@ -4,17 +4,26 @@
 
 #include "../state/errors.hpp"
 #include "../state/ethash_difficulty.hpp"
+#include "../state/host.hpp"
+#include "../state/host_recording.hpp"
 #include "../state/mpt_hash.hpp"
+#include "../state/prefetch.hpp"
 #include "../state/rlp.hpp"
+#include "../state/schedule.hpp"
+#include "../state/storage_heatmap.hpp"
 #include "../statetest/statetest.hpp"
 #include "../utils/utils.hpp"
 #include <evmone/evmone.h>
 #include <evmone/version.h>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <string_view>
+#include <thread>
 
 namespace fs = std::filesystem;
 namespace json = nlohmann;
@@ -22,6 +31,62 @@ using namespace evmone;
 using namespace evmone::test;
 using namespace std::literals;
 
+namespace
+{
+/// The transaction decoded and hashed before the execution.
+struct PreprocessedTransaction
+{
+    state::Transaction tx;
+    hash256 hash;
+
+    /// The RLP encoding of the transaction (the transactions trie value).
+    bytes encoded;
+};
+
+/// Decodes the transactions and computes their hashes in parallel.
+///
+/// The transactions are split into contiguous chunks processed by the helper threads.
+/// The hashes are checked against the loaded ones (if provided).
+std::vector<PreprocessedTransaction> preprocess_transactions(
+    const json::json& j_txs, uint64_t chain_id)
+{
+    std::vector<PreprocessedTransaction> txs(j_txs.size());
+
+    const auto process = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto& [tx, hash, encoded] = txs[i];
+            tx = test::from_json<state::Transaction>(j_txs[i]);
+            tx.chain_id = chain_id;
+            encoded = rlp::encode(tx);
+            hash = keccak256(encoded);
+
+            if (j_txs[i].contains("hash"))
+            {
+                const auto loaded_tx_hash_opt =
+                    evmc::from_hex<bytes32>(j_txs[i]["hash"].get<std::string>());
+
+                if (loaded_tx_hash_opt != hash)
+                    throw std::logic_error("transaction hash mismatched: computed " + hex0x(hash) +
+                                           ", expected " + hex0x(loaded_tx_hash_opt.value()));
+            }
+        }
+    };
+
+    const size_t num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    const auto chunk_size = (txs.size() + num_threads - 1) / num_threads;
+    std::vector<std::future<void>> workers;
+    for (size_t begin = 0; begin < txs.size(); begin += chunk_size)
+    {
+        workers.emplace_back(std::async(std::launch::async, process, begin,
+            std::min(begin + chunk_size, txs.size())));
+    }
+    for (auto& w : workers)
+        w.get();  // Rethrows the decoding errors.
+    return txs;
+}
+}  // namespace
+
 int main(int argc, const char* argv[])
 {
     evmc_revision rev = {};
@@ -35,6 +100,14 @@ int main(int argc, const char* argv[])
     std::optional<uint64_t> block_reward;
     uint64_t chain_id = 0;
     bool trace = false;
+    std::string trace_options;
+    bool record = false;
+    bool heatmap = false;
+    bool timing = false;
+    bool schedule = false;
+    bool memoize_static_calls = false;
+    bool dedup_code = false;
+    size_t code_compression_threshold = 0;
 
     try
     {
@@ -69,8 +142,42 @@ int main(int argc, const char* argv[])
                 output_body_file = argv[i];
             else if (arg == "--trace")
                 trace = true;
+            else if (arg == "--trace.memory")
+                trace_options += "+memory";
+            else if (arg == "--trace.storage")
+                trace_options += "+storage";
+            else if (arg == "--record")
+                record = true;
+            else if (arg == "--heatmap")
+                heatmap = true;
+            else if (arg == "--timing")
+                timing = true;
+            else if (arg == "--schedule")
+                schedule = true;
+            else if (arg == "--memoize-static-calls")
+                memoize_static_calls = true;
+            else if (arg == "--dedup-code")
+                dedup_code = true;
+            else if (arg == "--compress-code" && ++i < argc)
+            {
+                dedup_code = true;
+                code_compression_threshold = std::stoul(argv[i]);
+            }
         }
 
+        // Reports the duration of the block processing stage (if enabled).
+        auto stage_start = std::chrono::steady_clock::now();
+        const auto end_stage = [&](std::string_view name) {
+            const auto now = std::chrono::steady_clock::now();
+            if (timing)
+            {
+                std::cerr << name << ": "
+                          << std::chrono::duration<double, std::milli>(now - stage_start).count()
+                          << " ms\n";
+            }
+            stage_start = now;
+        };
+
         state::BlockInfo block;
         state::State state;
 
@@ -79,6 +186,15 @@ int main(int argc, const char* argv[])
             const auto j = json::json::parse(std::ifstream{alloc_file}, nullptr, false);
             state = test::from_json<state::State>(j);
         }
+
+        // The code shared by the accounts is stored once (and optionally compressed).
+        std::shared_ptr<state::CodeStore> code_store;
+        if (dedup_code)
+        {
+            code_store = std::make_shared<state::CodeStore>(
+                state::CodeStore::Config{.compression_threshold = code_compression_threshold});
+            state.set_code_store(code_store);
+        }
         if (!env_file.empty())
         {
             const auto j = json::json::parse(std::ifstream{env_file});
@@ -108,9 +224,33 @@ int main(int argc, const char* argv[])
 
         int64_t cumulative_gas_used = 0;
         std::vector<state::Transaction> transactions;
+        std::vector<bytes> encoded_txs;
         std::vector<state::TransactionReceipt> receipts;
         int64_t block_gas_left = block.gas_limit;
 
+        // The block roots not depending on the post-state are computed on helper threads:
+        // the withdrawals root concurrently with the transaction execution,
+        // the receipts root concurrently with the state root.
+        // The transactions root is computed from the preprocessing encodings concurrently
+        // with the execution assuming all transactions are valid. Otherwise, it is recomputed
+        // for the included transactions after the execution.
+        auto withdrawals_root = std::async(
+            std::launch::async, [&block] { return state::mpt_hash(block.withdrawals); });
+        std::future<hash256> txs_root;
+        std::future<hash256> receipts_root;
+        std::future<state::BloomFilter> logs_bloom;
+        const auto start_lists_hashing = [&] {
+            if (!txs_root.valid())
+            {
+                txs_root = std::async(std::launch::async,
+                    [&transactions] { return state::mpt_hash(transactions); });
+            }
+            receipts_root = std::async(
+                std::launch::async, [&receipts] { return state::mpt_hash(receipts); });
+            logs_bloom = std::async(
+                std::launch::async, [&receipts] { return compute_bloom_filter(receipts); });
+        };
+
         // Validate eof code in pre-state
         if (rev >= EVMC_PRAGUE)
             validate_deployed_code(state, rev);
@@ -119,11 +259,32 @@ int main(int argc, const char* argv[])
         if (!txs_file.empty())
         {
             const auto j_txs = json::json::parse(std::ifstream{txs_file});
+            end_stage("loading");
 
-            evmc::VM vm{evmc_create_evmone(), {{"O", "0"}}};
+            evmc::VM vm{evmc_create_evmone(), {{"O", "0"}, {"host_ext", ""}}};
 
             if (trace)
-                vm.set_option("trace", "0");
+                vm.set_option("trace", trace_options.c_str());
+
+            // The `heatmap` flag collects the storage access statistics of all transactions.
+            // The `schedule` flag collects them for every transaction separately.
+            state::StorageHeatmap storage_heatmap;
+            state::StorageHeatmap tx_storage_heatmap;
+            evmc::VM heatmap_vm;
+            if (heatmap || schedule)
+            {
+                heatmap_vm = evmc::VM{state::create_storage_heatmap_vm(
+                    vm, schedule ? tx_storage_heatmap : storage_heatmap)};
+            }
+            auto& exec_vm = (heatmap || schedule) ? heatmap_vm : vm;
+
+            // The `record` flag records the host queries of the top-level messages
+            // to be replayed in evmone-bench.
+            std::vector<state::HostRecording> recordings;
+            evmc::VM recording_vm;
+            if (record)
+                recording_vm = evmc::VM{state::create_recording_vm(exec_vm, recordings)};
+            auto& tx_vm = record ? recording_vm : exec_vm;
 
             std::vector<state::Log> txs_logs;
 
@@ -132,24 +293,37 @@ int main(int argc, const char* argv[])
                 j_result["receipts"] = json::json::array();
                 j_result["rejected"] = json::json::array();
 
-                for (size_t i = 0; i < j_txs.size(); ++i)
+                auto preprocessed_txs = preprocess_transactions(j_txs, chain_id);
+                end_stage("preprocessing");
+
+                for (auto& p : preprocessed_txs)
+                    encoded_txs.emplace_back(std::move(p.encoded));
+                txs_root = std::async(std::launch::async,
+                    [&encoded_txs] { return state::mpt_hash_encoded(encoded_txs); });
+
+                // The `schedule` flag predicts the accesses of all transactions from the
+                // pre-block state, as needed for the parallel execution, and reports
+                // the accuracy of the predictions against the observed accesses.
+                std::vector<state::AccessPrediction> tx_predictions;
+                std::vector<state::AccessPrediction> predicted;
+                std::vector<state::AccessPrediction> observed;
+                if (schedule)
                 {
-                    auto tx = test::from_json<state::Transaction>(j_txs[i]);
-                    tx.chain_id = chain_id;
+                    for (const auto& p : preprocessed_txs)
+                        tx_predictions.push_back(state::predict_accesses(state, p.tx));
+                }
 
-                    const auto computed_tx_hash = keccak256(rlp::encode(tx));
-                    const auto computed_tx_hash_str = hex0x(computed_tx_hash);
+                state::StaticCallMemo static_call_memo;
+                auto* const tx_static_call_memo =
+                    memoize_static_calls ? &static_call_memo : nullptr;
 
-                    if (j_txs[i].contains("hash"))
-                    {
-                        const auto loaded_tx_hash_opt =
-                            evmc::from_hex<bytes32>(j_txs[i]["hash"].get<std::string>());
+                // The transient storage is cleared by each transition() keeping its memory.
+                state::TransientStorage transient_storage;
 
-                        if (loaded_tx_hash_opt != computed_tx_hash)
-                            throw std::logic_error("transaction hash mismatched: computed " +
-                                                   computed_tx_hash_str + ", expected " +
-                                                   hex0x(loaded_tx_hash_opt.value()));
-                    }
+                for (size_t i = 0; i < preprocessed_txs.size(); ++i)
+                {
+                    auto& [tx, computed_tx_hash, _] = preprocessed_txs[i];
+                    const auto computed_tx_hash_str = hex0x(computed_tx_hash);
 
                     std::ofstream trace_file_output;
                     const auto orig_clog_buf = std::clog.rdbuf();
@@ -165,7 +339,32 @@ int main(int argc, const char* argv[])
                         std::clog.rdbuf(trace_file_output.rdbuf());
                     }
 
-                    auto res = state::transition(state, block, tx, rev, vm, block_gas_left);
+                    auto res = state::transition(state, block, tx, rev, tx_vm, block_gas_left,
+                        tx_static_call_memo, &transient_storage);
+
+                    if (schedule)
+                    {
+                        if (!holds_alternative<std::error_code>(res))
+                        {
+                            predicted.push_back(std::move(tx_predictions[i]));
+                            observed.push_back(state::observed_accesses(tx, tx_storage_heatmap));
+                        }
+                        if (heatmap)
+                            storage_heatmap.merge(tx_storage_heatmap);
+                        tx_storage_heatmap.contracts.clear();
+                    }
+
+                    if (record && !recordings.empty())
+                    {
+                        const auto output_filename =
+                            output_dir /
+                            ("record-" + std::to_string(i) + "-" + computed_tx_hash_str + ".bin");
+                        const auto data = recordings.back().serialize();
+                        std::ofstream{output_filename, std::ios::binary}.write(
+                            reinterpret_cast<const char*>(data.data()),
+                            static_cast<std::streamsize>(data.size()));
+                        recordings.clear();
+                    }
 
                     if (holds_alternative<std::error_code>(res))
                     {
@@ -209,21 +408,69 @@ int main(int argc, const char* argv[])
                     if (trace)
                         std::clog.rdbuf(orig_clog_buf);
                 }
+
+                if (schedule)
+                {
+                    const auto a = state::measure_accuracy(predicted, observed);
+                    std::cerr << "schedule: " << a.predicted_waves << " waves ("
+                              << a.observed_waves << " with observed accesses), conflicts: "
+                              << a.predicted_conflicts << " predicted, " << a.observed_conflicts
+                              << " observed, " << a.missed_conflicts << " missed\n"
+                              << "storage slots: " << a.observed_slots << " observed, "
+                              << a.predicted_slots << " predicted, "
+                              << a.predicted_observed_slots << " observed predicted, "
+                              << a.covered_observed_slots << " observed covered\n";
+                }
+                if (timing && memoize_static_calls)
+                {
+                    std::cerr << "static call memo hits: " << static_call_memo.hits
+                              << ", misses: " << static_call_memo.misses << "\n";
+                }
+                if (timing && code_store != nullptr)
+                {
+                    const auto stats = code_store->get_stats();
+                    std::cerr << "code store: " << stats.num_codes << " codes, "
+                              << stats.code_size << " bytes (" << stats.stored_size
+                              << " bytes stored), hot code cache hits: " << stats.hot_cache_hits
+                              << ", misses: " << stats.hot_cache_misses << "\n";
+                }
             }
 
+            end_stage("execution");
+
+            // Discard the transactions root computed speculatively if any transaction
+            // has been rejected (waits for the helper thread).
+            if (transactions.size() != encoded_txs.size())
+                txs_root = {};
+
+            // The transactions and receipts are final.
+            start_lists_hashing();
+            auto txs_logs_hash =
+                std::async(std::launch::async, [&txs_logs] { return logs_hash(txs_logs); });
+
             state::finalize(
                 state, rev, block.coinbase, block_reward, block.ommers, block.withdrawals);
 
-            j_result["logsHash"] = hex0x(logs_hash(txs_logs));
             j_result["stateRoot"] = hex0x(state::mpt_hash(state.get_accounts()));
+            j_result["logsHash"] = hex0x(txs_logs_hash.get());
+
+            if (heatmap)
+            {
+                std::ofstream heatmap_output{output_dir / "storage-heatmap.csv"};
+                storage_heatmap.report(heatmap_output, 100);
+            }
         }
 
-        j_result["logsBloom"] = hex0x(compute_bloom_filter(receipts));
-        j_result["receiptsRoot"] = hex0x(state::mpt_hash(receipts));
+        if (txs_file.empty())
+            start_lists_hashing();
+
+        j_result["logsBloom"] = hex0x(logs_bloom.get());
+        j_result["receiptsRoot"] = hex0x(receipts_root.get());
         if (rev >= EVMC_SHANGHAI)
-            j_result["withdrawalsRoot"] = hex0x(state::mpt_hash(block.withdrawals));
+            j_result["withdrawalsRoot"] = hex0x(withdrawals_root.get());
 
-        j_result["txRoot"] = hex0x(state::mpt_hash(transactions));
+        j_result["txRoot"] = hex0x(txs_root.get());
+        end_stage("finalization");
         j_result["gasUsed"] = hex0x(cumulative_gas_used);
 
         std::ofstream{output_dir / output_result_file} << std::setw(2) << j_result;
@@ -237,7 +484,7 @@ int main(int argc, const char* argv[])
                 if (!is_zero(val.current))
                     j_alloc[hex0x(addr)]["storage"][hex0x(key)] = hex0x(val.current);
 
-            j_alloc[hex0x(addr)]["code"] = hex0x(bytes_view(acc.code.data(), acc.code.size()));
+            j_alloc[hex0x(addr)]["code"] = hex0x(bytes_view{*acc.code.load()});
             j_alloc[hex0x(addr)]["balance"] = hex0x(acc.balance);
         }
 
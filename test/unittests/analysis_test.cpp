@@ -278,3 +278,31 @@ TEST(analysis, example1_eof1)
     EXPECT_EQ(block.stack_req, 0);
     EXPECT_EQ(block.stack_max_growth, 2);
 }
+
+TEST(analysis, eof1_rjumpi)
+{
+    const auto code = eof1_bytecode(push(0) + OP_RJUMPI + "0001" + OP_STOP + OP_STOP, 1);
+    const auto analysis = analyze(EVMC_PRAGUE, code);
+    const auto& eof_op_tbl = get_op_table(EVMC_PRAGUE, 1);
+
+    ASSERT_EQ(analysis.instrs.size(), 7);
+
+    EXPECT_EQ(analysis.instrs[0].fn, op_tbl[OPX_BEGINBLOCK].fn);
+    EXPECT_EQ(analysis.instrs[1].fn, eof_op_tbl[OP_PUSH1].fn);
+    EXPECT_EQ(analysis.instrs[2].fn, eof_op_tbl[OP_RJUMPI].fn);
+    EXPECT_EQ(analysis.instrs[3].fn, op_tbl[OPX_BEGINBLOCK].fn);
+    EXPECT_EQ(analysis.instrs[4].fn, eof_op_tbl[OP_STOP].fn);
+    EXPECT_EQ(analysis.instrs[5].fn, op_tbl[OPX_BEGINBLOCK].fn);
+    EXPECT_EQ(analysis.instrs[6].fn, eof_op_tbl[OP_STOP].fn);
+
+    // The RJUMPI target is resolved to the index of the target block.
+    EXPECT_EQ(analysis.instrs[2].arg.number, 5);
+
+    ASSERT_EQ(analysis.code_section_entries.size(), 1);
+    EXPECT_EQ(analysis.code_section_entries[0], 0);
+
+    const auto& block = analysis.instrs[0].arg.block;
+    EXPECT_EQ(block.gas_cost, 7u);
+    EXPECT_EQ(block.stack_req, 0);
+    EXPECT_EQ(block.stack_max_growth, 1);
+}
@@ -93,6 +93,42 @@ TEST_P(evm, jump_over_jumpdest)
     EXPECT_GAS_USED(EVMC_SUCCESS, 3 + 8 + 1);
 }
 
+TEST_P(evm, jump_in_initcode)
+{
+    // The initcode uses the lazy JUMPDEST analysis. Check jumps to far and to not-yet-analyzed
+    // locations, including PUSH data crossing the analysis chunk boundary.
+    msg.kind = EVMC_CREATE;
+
+    auto code = jump(calldataload(0));
+    code += (1020 - static_cast<int>(code.size())) * OP_STOP;
+    const auto push_data_offset = code.size() + 10;
+    code += push(bytes(32, OP_JUMPDEST));
+    const auto jumpdest1_offset = code.size();
+    code += OP_JUMPDEST + ret(0, 1) + 1000 * OP_STOP;
+    const auto jumpdest2_offset = code.size();
+    code += OP_JUMPDEST + ret(0, 2);
+
+    const auto input = [](size_t offset) {
+        bytes in(32, 0);
+        intx::be::unsafe::store(in.data(), intx::uint256{offset});
+        return in;
+    };
+
+    execute(code, input(jumpdest2_offset));
+    EXPECT_STATUS(EVMC_SUCCESS);
+    EXPECT_EQ(result.output_size, 2);
+
+    execute(code, input(jumpdest1_offset));
+    EXPECT_STATUS(EVMC_SUCCESS);
+    EXPECT_EQ(result.output_size, 1);
+
+    execute(code, input(push_data_offset));
+    EXPECT_STATUS(EVMC_BAD_JUMP_DESTINATION);
+
+    execute(code, input(code.size()));
+    EXPECT_STATUS(EVMC_BAD_JUMP_DESTINATION);
+}
+
 TEST_P(evm, jump_to_missing_push_data)
 {
     execute(push(5) + OP_JUMP + OP_PUSH1);
@@ -12,7 +12,7 @@ using evmone::test::evm;
 
 TEST_P(evm, dupn)
 {
-    // DUPN is not implemented in Advanced.
+    // DUPN is only defined in EOF code in Advanced.
     if (evm::is_advanced())
         return;
 
@@ -40,7 +40,7 @@ TEST_P(evm, dupn)
 
 TEST_P(evm, swapn)
 {
-    // SWAPN is not implemented in Advanced.
+    // SWAPN is only defined in EOF code in Advanced.
     if (evm::is_advanced())
         return;
 
@@ -80,7 +80,7 @@ TEST_P(evm, swapn)
 
 TEST_P(evm, dupn_full_stack)
 {
-    // DUPN is not implemented in Advanced.
+    // DUPN is only defined in EOF code in Advanced.
     if (evm::is_advanced())
         return;
 
@@ -107,7 +107,7 @@ TEST_P(evm, dupn_full_stack)
 
 TEST_P(evm, swapn_full_stack)
 {
-    // SWAPN is not implemented in Advanced.
+    // SWAPN is only defined in EOF code in Advanced.
     if (evm::is_advanced())
         return;
 
@@ -135,7 +135,7 @@ TEST_P(evm, swapn_full_stack)
 
 TEST_P(evm, dupn_dup_consistency)
 {
-    // DUPN is not implemented in Advanced.
+    // DUPN is only defined in EOF code in Advanced.
     if (evm::is_advanced())
         return;
 
@@ -163,7 +163,7 @@ TEST_P(evm, dupn_dup_consistency)
 
 TEST_P(evm, swapn_swap_consistency)
 {
-    // DUPN is not implemented in Advanced.
+    // DUPN is only defined in EOF code in Advanced.
     if (evm::is_advanced())
         return;
 
@@ -188,3 +188,49 @@ TEST_P(evm, swapn_swap_consistency)
     EXPECT_STATUS(EVMC_SUCCESS);
     EXPECT_OUTPUT_INT(17);
 }
+
+TEST_P(evm, dupn_eof)
+{
+    rev = EVMC_PRAGUE;
+
+    auto pushes = bytecode{};
+    for (uint64_t i = 1; i <= 20; ++i)
+        pushes += push(i);
+
+    execute(eof1_bytecode(pushes + OP_DUPN + "00" + ret_top(), 22));
+    EXPECT_STATUS(EVMC_SUCCESS);
+    EXPECT_OUTPUT_INT(20);
+
+    execute(eof1_bytecode(pushes + OP_DUPN + "02" + ret_top(), 22));
+    EXPECT_STATUS(EVMC_SUCCESS);
+    EXPECT_OUTPUT_INT(18);
+
+    execute(eof1_bytecode(pushes + OP_DUPN + "13" + ret_top(), 22));
+    EXPECT_STATUS(EVMC_SUCCESS);
+    EXPECT_OUTPUT_INT(1);
+}
+
+TEST_P(evm, swapn_eof)
+{
+    rev = EVMC_PRAGUE;
+
+    auto pushes = bytecode{};
+    for (uint64_t i = 1; i <= 20; ++i)
+        pushes += push(i);
+
+    execute(eof1_bytecode(pushes + OP_SWAPN + "00" + ret_top(), 22));
+    EXPECT_STATUS(EVMC_SUCCESS);
+    EXPECT_OUTPUT_INT(19);
+
+    execute(eof1_bytecode(pushes + OP_SWAPN + "00" + OP_DUPN + "01" + ret_top(), 22));
+    EXPECT_STATUS(EVMC_SUCCESS);
+    EXPECT_OUTPUT_INT(20);
+
+    execute(eof1_bytecode(pushes + OP_SWAPN + "12" + ret_top(), 22));
+    EXPECT_STATUS(EVMC_SUCCESS);
+    EXPECT_OUTPUT_INT(1);
+
+    execute(eof1_bytecode(pushes + OP_SWAPN + "12" + OP_DUPN + "13" + ret_top(), 22));
+    EXPECT_STATUS(EVMC_SUCCESS);
+    EXPECT_OUTPUT_INT(20);
+}
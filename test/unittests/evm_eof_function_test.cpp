@@ -9,10 +9,6 @@ using evmone::test::evm;
 
 TEST_P(evm, eof_function_example1)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     const auto code = "EF00 01 010008 020002 000f 0002 040000 00 00000002 02010002" +
                       /* func0: */ push(1) + push(8) + OP_CALLF + "0001" + ret_top() +
@@ -27,10 +23,6 @@ TEST_P(evm, eof_function_example1)
 
 TEST_P(evm, eof_function_example2)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     const auto code =
         "ef0001 01000c 020003 003b 0017 001d 040000 00 00000004 01010003 01010004"
@@ -58,10 +50,6 @@ TEST_P(evm, eof_function_example2)
 
 TEST_P(evm, callf_stack_size_1024)
 {
-    // CALLF is not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     const auto code = bytecode{"ef0001 010008 020002 0BFF 0004 040000 00 000003FF 00000001"_hex} +
                       1023 * push(1) + OP_CALLF + bytecode{"0x0001"_hex} + 1021 * OP_POP +
@@ -74,10 +62,6 @@ TEST_P(evm, callf_stack_size_1024)
 
 TEST_P(evm, callf_with_inputs_stack_size_1024)
 {
-    // CALLF is not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     const auto code = bytecode{"ef0001 010008 020002 0BFF 0004 040000 00 000003FF 03030004"_hex} +
                       1023 * push(1) + OP_CALLF + bytecode{"0x0001"_hex} + 1021 * OP_POP +
@@ -90,10 +74,6 @@ TEST_P(evm, callf_with_inputs_stack_size_1024)
 
 TEST_P(evm, callf_stack_overflow)
 {
-    // CALLF is not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     const auto code =
         bytecode{"ef0001 01000c 020003 0BFF 0007 0004 040000 00 000003FF 00000001 00000001"_hex} +
@@ -107,10 +87,6 @@ TEST_P(evm, callf_stack_overflow)
 
 TEST_P(evm, callf_with_inputs_stack_overflow)
 {
-    // CALLF is not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     const auto code =
         bytecode{"ef0001 01000c 020003 0BFF 0007 0004 040000 00 000003FF 03030004 03030004"_hex} +
@@ -124,10 +100,6 @@ TEST_P(evm, callf_with_inputs_stack_overflow)
 
 TEST_P(evm, callf_call_stack_size_1024)
 {
-    // CALLF is not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     const auto code = bytecode{"ef0001 010008 020002 0007 000e 040000 00 00000001 01000002"_hex} +
                       push(1023) + OP_CALLF + bytecode{"0x0001"_hex} + OP_STOP + OP_DUP1 +
@@ -141,10 +113,6 @@ TEST_P(evm, callf_call_stack_size_1024)
 
 TEST_P(evm, callf_call_stack_size_1025)
 {
-    // CALLF is not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     const auto code = bytecode{"ef0001 010008 020002 0007 000e 040000 00 00000001 01000002"_hex} +
                       push(1024) + OP_CALLF + bytecode{"0x0001"_hex} + OP_STOP + OP_DUP1 +
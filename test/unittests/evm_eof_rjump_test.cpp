@@ -10,10 +10,6 @@ using evmone::test::evm;
 
 TEST_P(evm, eof1_rjump)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     auto code = eof1_bytecode(rjumpi(3, 0) + rjump(1) + OP_INVALID + mstore8(0, 1) + ret(0, 1), 2);
 
@@ -33,10 +29,6 @@ TEST_P(evm, eof1_rjump)
 
 TEST_P(evm, eof1_rjump_backward)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     auto code = eof1_bytecode(rjump(10) + mstore8(0, 1) + ret(0, 1) + rjump(-13), 2);
 
@@ -55,10 +47,6 @@ TEST_P(evm, eof1_rjump_backward)
 
 TEST_P(evm, eof1_rjump_0_offset)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     auto code = eof1_bytecode(rjump(0) + mstore8(0, 1) + ret(0, 1), 2);
 
@@ -70,10 +58,6 @@ TEST_P(evm, eof1_rjump_0_offset)
 
 TEST_P(evm, eof1_rjumpi)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     auto code = eof1_bytecode(
         rjumpi(10, calldataload(0)) + mstore8(0, 2) + ret(0, 1) + mstore8(0, 1) + ret(0, 1), 2);
@@ -93,10 +77,6 @@ TEST_P(evm, eof1_rjumpi)
 
 TEST_P(evm, eof1_rjumpi_backwards)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     auto code = eof1_bytecode(rjump(10) + mstore8(0, 1) + ret(0, 1) + rjumpi(-16, calldataload(0)) +
                                   mstore8(0, 2) + ret(0, 1),
@@ -117,10 +97,6 @@ TEST_P(evm, eof1_rjumpi_backwards)
 
 TEST_P(evm, eof1_rjumpi_0_offset)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     auto code = eof1_bytecode(rjumpi(0, calldataload(0)) + mstore8(0, 1) + ret(0, 1), 2);
 
@@ -139,10 +115,6 @@ TEST_P(evm, eof1_rjumpi_0_offset)
 
 TEST_P(evm, eof1_rjumpv_single_offset)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     auto code = eof1_bytecode(rjumpv({3}, 0) + OP_JUMPDEST + OP_JUMPDEST + OP_STOP + 20 + 40 + 0 +
                                   OP_CODECOPY + ret(0, 20),
@@ -157,10 +129,6 @@ TEST_P(evm, eof1_rjumpv_single_offset)
 
 TEST_P(evm, eof1_rjumpv_multiple_offsets)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     auto code = eof1_bytecode(rjump(12) + 10 + 68 + 0 + OP_CODECOPY + ret(0, 10) +
                                   rjumpv({12, -22, 0}, 1) + 10 + 78 + 0 + OP_CODECOPY + ret(0, 10) +
@@ -196,10 +164,6 @@ TEST_P(evm, eof1_rjumpv_multiple_offsets)
 
 TEST_P(evm, eof1_rjumpv_long_jumps)
 {
-    // Relative jumps are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     auto code =
         rjump(0x7fff - 3 - 5) + (0x7fff - 3 - 2 - 8 - 5) * bytecode{OP_JUMPDEST} + 7 + ret_top();
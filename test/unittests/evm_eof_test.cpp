@@ -152,10 +152,6 @@ TEST_P(evm, eof_data_only_contract)
 
 TEST_P(evm, eof1_dataload)
 {
-    // Data instructions are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     // data is 64 bytes long
     const auto data = bytes(8, 0x0) + bytes(8, 0x11) + bytes(8, 0x22) + bytes(8, 0x33) +
@@ -195,10 +191,6 @@ TEST_P(evm, eof1_dataload)
 
 TEST_P(evm, eof1_dataloadn)
 {
-    // Data instructions are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     // data is 64 bytes long
     const auto data = bytes(8, 0x0) + bytes(8, 0x11) + bytes(8, 0x22) + bytes(8, 0x33) +
@@ -228,10 +220,6 @@ TEST_P(evm, eof1_dataloadn)
 
 TEST_P(evm, eof1_datasize)
 {
-    // Data instructions are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
 
     // no data section
@@ -272,10 +260,6 @@ TEST_P(evm, eof1_datasize)
 
 TEST_P(evm, eof1_datacopy)
 {
-    // Data instructions are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     // data is 64 bytes long
     const auto data = bytes(8, 0x0) + bytes(8, 0x11) + bytes(8, 0x22) + bytes(8, 0x33) +
@@ -328,10 +312,6 @@ TEST_P(evm, eof1_datacopy)
 
 TEST_P(evm, datacopy_memory_cost)
 {
-    // Data instructions are not implemented in Advanced.
-    if (is_advanced())
-        return;
-
     rev = EVMC_PRAGUE;
     const auto data = bytes{0};
     const auto code = eof1_bytecode(bytecode(1) + 0 + 0 + OP_DATACOPY + OP_STOP, 3, data);
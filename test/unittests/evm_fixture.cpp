@@ -12,6 +12,7 @@ namespace
 evmc::VM advanced_vm{evmc_create_evmone(), {{"advanced", ""}}};
 evmc::VM baseline_vm{evmc_create_evmone()};
 evmc::VM bnocgoto_vm{evmc_create_evmone(), {{"cgoto", "no"}}};
+evmc::VM bpredecode_vm{evmc_create_evmone(), {{"predecode_push", ""}}};
 
 const char* print_vm_name(const testing::TestParamInfo<evmc::VM*>& info) noexcept
 {
@@ -21,12 +22,14 @@ const char* print_vm_name(const testing::TestParamInfo<evmc::VM*>& info) noexcep
         return "baseline";
     if (info.param == &bnocgoto_vm)
         return "bnocgoto";
+    if (info.param == &bpredecode_vm)
+        return "bpredecode";
     return "unknown";
 }
 }  // namespace
 
-INSTANTIATE_TEST_SUITE_P(
-    evmone, evm, testing::Values(&advanced_vm, &baseline_vm, &bnocgoto_vm), print_vm_name);
+INSTANTIATE_TEST_SUITE_P(evmone, evm,
+    testing::Values(&advanced_vm, &baseline_vm, &bnocgoto_vm, &bpredecode_vm), print_vm_name);
 
 bool evm::is_advanced() noexcept
 {
@@ -211,9 +211,6 @@ TEST_P(evm, memory_access)
 
             if (t.opcode == OP_DATACOPY)
             {
-                if (is_advanced())
-                    continue;
-
                 code += bytecode{OP_STOP};
                 code = eof1_bytecode(code, 3, bytes(32, 0));
             }
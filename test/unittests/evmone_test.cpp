@@ -3,10 +3,15 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <evmc/evmc.hpp>
+#include <evmc/hex.hpp>
+#include <evmc/mocked_host.hpp>
+#include <evmone/baseline.hpp>
 #include <evmone/evmone.h>
 #include <evmone/vm.hpp>
 #include <gtest/gtest.h>
 
+using namespace intx;
+
 TEST(evmone, info)
 {
     auto vm = evmc::VM{evmc_create_evmone()};
@@ -53,3 +58,275 @@ TEST(evmone, set_option_cgoto)
     EXPECT_EQ(vm.set_option("cgoto", "no"), EVMC_SET_OPTION_INVALID_NAME);
 #endif
 }
+
+TEST(evmone, set_option_adaptive)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    EXPECT_EQ(vm.set_option("adaptive_gas", "1000"), EVMC_SET_OPTION_INVALID_NAME);
+    EXPECT_EQ(vm.set_option("adaptive", "x"), EVMC_SET_OPTION_INVALID_VALUE);
+    EXPECT_EQ(vm.set_option("adaptive", ""), EVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(vm.set_option("adaptive", "10"), EVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(vm.set_option("adaptive_gas", "-1"), EVMC_SET_OPTION_INVALID_VALUE);
+    EXPECT_EQ(vm.set_option("adaptive_gas", "1000"), EVMC_SET_OPTION_SUCCESS);
+
+    const auto& cache = *static_cast<evmone::VM*>(vm.get_raw_pointer())->get_code_cache();
+    EXPECT_EQ(cache.config.execution_threshold, 10u);
+    EXPECT_EQ(cache.config.gas_threshold, 1000);
+}
+
+TEST(evmone, adaptive_promotion)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    ASSERT_EQ(vm.set_option("adaptive", "2"), EVMC_SET_OPTION_SUCCESS);
+    const auto& cache = *static_cast<evmone::VM*>(vm.get_raw_pointer())->get_code_cache();
+
+    // MSTORE(0, 1) RETURN(0, 32)
+    const uint8_t code[] = {0x60, 0x01, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+    evmc::MockedHost host;
+    evmc_message msg{};
+    msg.gas = 100000;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const auto r = vm.execute(host, EVMC_SHANGHAI, msg, code, std::size(code));
+        EXPECT_EQ(r.status_code, EVMC_SUCCESS);
+        EXPECT_EQ(r.gas_left, msg.gas - 18);
+        ASSERT_EQ(r.output_size, 32);
+        EXPECT_EQ(r.output_data[31], 1);
+    }
+
+    const auto stats = cache.get_stats();
+    EXPECT_EQ(stats.baseline_executions, 2u);
+    EXPECT_EQ(stats.advanced_executions, 2u);
+    EXPECT_EQ(stats.promotions, 1u);
+    EXPECT_EQ(stats.evictions, 0u);
+}
+
+TEST(evmone, adaptive_code_modified_in_place)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    ASSERT_EQ(vm.set_option("adaptive", "2"), EVMC_SET_OPTION_SUCCESS);
+    const auto& cache = *static_cast<evmone::VM*>(vm.get_raw_pointer())->get_code_cache();
+
+    // MSTORE(0, 1) RETURN(0, 32)
+    uint8_t code[] = {0x60, 0x01, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+    evmc::MockedHost host;
+    evmc_message msg{};
+    msg.gas = 100000;
+
+    for (int i = 0; i < 3; ++i)
+        EXPECT_EQ(vm.execute(host, EVMC_SHANGHAI, msg, code, std::size(code)).output_data[31], 1);
+    EXPECT_EQ(cache.get_stats().advanced_executions, 1u);
+
+    // MSTORE(0, 2) RETURN(0, 32) at the same location is the different code counted separately.
+    code[1] = 0x02;
+    for (int i = 0; i < 3; ++i)
+        EXPECT_EQ(vm.execute(host, EVMC_SHANGHAI, msg, code, std::size(code)).output_data[31], 2);
+
+    const auto stats = cache.get_stats();
+    EXPECT_EQ(stats.baseline_executions, 4u);
+    EXPECT_EQ(stats.advanced_executions, 2u);
+    EXPECT_EQ(stats.promotions, 2u);
+}
+
+TEST(evmone, adaptive_alternating_revisions)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    ASSERT_EQ(vm.set_option("adaptive", "2"), EVMC_SET_OPTION_SUCCESS);
+    const auto& cache = *static_cast<evmone::VM*>(vm.get_raw_pointer())->get_code_cache();
+
+    // MSTORE(0, 1) RETURN(0, 32)
+    const uint8_t code[] = {0x60, 0x01, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+    evmc::MockedHost host;
+    evmc_message msg{};
+    msg.gas = 100000;
+
+    // The executions are counted for the code in all revisions,
+    // but each revision is analyzed once.
+    for (int i = 0; i < 10; ++i)
+    {
+        const auto rev = i % 2 == 0 ? EVMC_SHANGHAI : EVMC_CANCUN;
+        EXPECT_EQ(vm.execute(host, rev, msg, code, std::size(code)).output_data[31], 1);
+    }
+
+    const auto stats = cache.get_stats();
+    EXPECT_EQ(stats.baseline_executions, 3u);
+    EXPECT_EQ(stats.advanced_executions, 7u);
+    EXPECT_EQ(stats.promotions, 2u);
+}
+
+TEST(evmone, adaptive_initcode_not_tracked)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    ASSERT_EQ(vm.set_option("adaptive", "1"), EVMC_SET_OPTION_SUCCESS);
+    const auto& cache = *static_cast<evmone::VM*>(vm.get_raw_pointer())->get_code_cache();
+
+    // MSTORE(0, 1) RETURN(0, 32)
+    const uint8_t code[] = {0x60, 0x01, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+    evmc::MockedHost host;
+    evmc_message msg{};
+    msg.kind = EVMC_CREATE;
+    msg.gas = 100000;
+
+    for (int i = 0; i < 3; ++i)
+        EXPECT_EQ(vm.execute(host, EVMC_SHANGHAI, msg, code, std::size(code)).output_size, 32);
+
+    const auto stats = cache.get_stats();
+    EXPECT_EQ(stats.baseline_executions, 0u);
+    EXPECT_EQ(stats.advanced_executions, 0u);
+    EXPECT_EQ(stats.promotions, 0u);
+}
+
+TEST(evmone, adaptive_eviction)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    ASSERT_EQ(vm.set_option("adaptive", "2"), EVMC_SET_OPTION_SUCCESS);
+    auto& cache = *static_cast<evmone::VM*>(vm.get_raw_pointer())->get_code_cache();
+    cache.config.max_tracked_codes = 1;
+
+    // MSTORE(0, 1) RETURN(0, 32) and MSTORE(0, 2) RETURN(0, 32)
+    const uint8_t code_a[] = {0x60, 0x01, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+    const uint8_t code_b[] = {0x60, 0x02, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+    evmc::MockedHost host;
+    evmc_message msg{};
+    msg.gas = 100000;
+
+    const auto execute = [&](const uint8_t* code) {
+        return vm.execute(host, EVMC_SHANGHAI, msg, code, std::size(code_a)).output_data[31];
+    };
+    EXPECT_EQ(execute(code_a), 1);
+    EXPECT_EQ(execute(code_a), 1);
+    EXPECT_EQ(execute(code_a), 1);
+    EXPECT_EQ(cache.get_stats().advanced_executions, 1u);
+
+    // The new code evicts the least recently used one and the tracking continues.
+    EXPECT_EQ(execute(code_b), 2);
+    EXPECT_EQ(execute(code_b), 2);
+    EXPECT_EQ(execute(code_b), 2);
+    EXPECT_EQ(execute(code_a), 1);
+
+    const auto stats = cache.get_stats();
+    EXPECT_EQ(stats.baseline_executions, 5u);
+    EXPECT_EQ(stats.advanced_executions, 2u);
+    EXPECT_EQ(stats.promotions, 2u);
+    EXPECT_EQ(stats.evictions, 2u);
+}
+
+TEST(evmone, set_option_host_ext)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    EXPECT_FALSE(static_cast<evmone::VM*>(vm.get_raw_pointer())->host_ext);
+    EXPECT_EQ(vm.set_option("host_ext", ""), EVMC_SET_OPTION_SUCCESS);
+    EXPECT_TRUE(static_cast<evmone::VM*>(vm.get_raw_pointer())->host_ext);
+}
+
+TEST(evmone, get_host_ext)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    const auto& evmone_vm = *static_cast<evmone::VM*>(vm.get_raw_pointer());
+
+    static evmone::ExtendedHostInterface ext{};
+    ext.magic = evmone::ExtendedHostInterface::magic_value;
+    static evmone::ExtendedHostInterface unregistered_ext = ext;
+    ASSERT_TRUE(evmone::register_host_ext(ext));
+    EXPECT_EQ(evmone_vm.get_host_ext(&ext.evmc), nullptr);
+
+    ASSERT_EQ(vm.set_option("host_ext", ""), EVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(evmone_vm.get_host_ext(&ext.evmc), &ext);
+    EXPECT_TRUE(evmone::register_host_ext(ext));  // Registering again is fine.
+
+    // The unregistered extension and the plain EVMC host interface are not used.
+    // Only the address of the plain interface is checked (no read past the EVMC struct).
+    EXPECT_EQ(evmone_vm.get_host_ext(&unregistered_ext.evmc), nullptr);
+    static const evmc_host_interface plain_host{};
+    EXPECT_EQ(evmone_vm.get_host_ext(&plain_host), nullptr);
+
+    // The extension of a different version is not registered.
+    unregistered_ext.magic = evmone::ExtendedHostInterface::magic_value + 1;
+    EXPECT_FALSE(evmone::register_host_ext(unregistered_ext));
+    EXPECT_EQ(evmone_vm.get_host_ext(&unregistered_ext.evmc), nullptr);
+}
+
+TEST(evmone, set_option_predecode_push)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    EXPECT_FALSE(static_cast<evmone::VM*>(vm.get_raw_pointer())->predecode_push);
+    EXPECT_EQ(vm.set_option("predecode_push", ""), EVMC_SET_OPTION_SUCCESS);
+    EXPECT_TRUE(static_cast<evmone::VM*>(vm.get_raw_pointer())->predecode_push);
+}
+
+TEST(evmone, baseline_predecode_push)
+{
+    // PUSH9 0x010203040506070809, PUSH1 0x01, PUSH32 0xff..ff, PUSH20 0xaabb (truncated).
+    const auto code = evmc::from_hex(
+        "68010203040506070809"
+        "6001"
+        "7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+        "73aabb")
+                          .value();
+
+    const auto plain = evmone::baseline::analyze(EVMC_CANCUN, code);
+    EXPECT_TRUE(plain.push_values.empty());
+    EXPECT_TRUE(plain.push_value_index.empty());
+
+    const auto analysis = evmone::baseline::analyze(EVMC_CANCUN, code, false, true);
+    ASSERT_EQ(analysis.push_values.size(), 3u);
+    ASSERT_EQ(analysis.push_value_index.size(), code.size());
+    EXPECT_EQ(analysis.push_value_index[0], 0u);
+    EXPECT_EQ(analysis.push_value_index[12], 1u);
+    EXPECT_EQ(analysis.push_value_index[45], 2u);
+    EXPECT_EQ(analysis.push_values[0], 0x010203040506070809_u256);
+    EXPECT_EQ(analysis.push_values[1], ~intx::uint256{});
+    // The missing push data bytes are zeros.
+    EXPECT_EQ(analysis.push_values[2], intx::uint256{0xaabb} << (8 * 18));
+
+    // The PUSH data looking like wide PUSH opcodes is not decoded.
+    const auto data_only = evmone::baseline::analyze(
+        EVMC_CANCUN, evmc::from_hex("6a7f7f7f7f7f7f7f7f7f7f7f").value(), false, true);
+    ASSERT_EQ(data_only.push_values.size(), 1u);
+    EXPECT_EQ(data_only.push_values[0], 0x7f7f7f7f7f7f7f7f7f7f7f_u256);
+
+    // The code having more wide PUSH instructions than the index can address is not decoded.
+    using PushValueIndex = evmone::baseline::CodeAnalysis::PushValueIndex;
+    constexpr auto max_values = size_t{std::numeric_limits<PushValueIndex>::max()} + 1;
+    const auto push9 = evmc::from_hex("68010203040506070809").value();
+    evmc::bytes many_pushes;
+    for (size_t i = 0; i <= max_values; ++i)
+        many_pushes += push9;
+    const auto max_pushes = evmone::baseline::analyze(
+        EVMC_CANCUN, evmc::bytes_view{many_pushes}.substr(push9.size()), false, true);
+    EXPECT_EQ(max_pushes.push_values.size(), max_values);
+    const auto too_many_pushes = evmone::baseline::analyze(EVMC_CANCUN, many_pushes, false, true);
+    EXPECT_TRUE(too_many_pushes.push_values.empty());
+    EXPECT_TRUE(too_many_pushes.push_value_index.empty());
+}
+
+TEST(evmone, set_option_trace_filter)
+{
+    evmc::VM vm{evmc_create_evmone()};
+    const auto& filter = static_cast<evmone::VM*>(vm.get_raw_pointer())->trace_filter;
+
+    EXPECT_EQ(vm.set_option("trace_address", "0x"), EVMC_SET_OPTION_INVALID_VALUE);
+    EXPECT_EQ(vm.set_option("trace_address", "0xc0de"), EVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(filter.code_address, evmc::address{0xc0de});
+
+    EXPECT_EQ(vm.set_option("trace_code_hash", "xx"), EVMC_SET_OPTION_INVALID_VALUE);
+    EXPECT_EQ(vm.set_option("trace_code_hash", "01"), EVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(filter.code_hash, evmc::bytes32{1});
+
+    EXPECT_EQ(vm.set_option("trace_depth", ""), EVMC_SET_OPTION_INVALID_VALUE);
+    EXPECT_EQ(vm.set_option("trace_depth", "2:1"), EVMC_SET_OPTION_INVALID_VALUE);
+    EXPECT_EQ(vm.set_option("trace_depth", "-1"), EVMC_SET_OPTION_INVALID_VALUE);
+    EXPECT_EQ(vm.set_option("trace_depth", "1:3"), EVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(filter.min_depth, 1);
+    EXPECT_EQ(filter.max_depth, 3);
+    EXPECT_EQ(vm.set_option("trace_depth", "2"), EVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(filter.min_depth, 2);
+    EXPECT_EQ(filter.max_depth, 2);
+
+    EXPECT_EQ(vm.set_option("trace_selector", "a9059c"), EVMC_SET_OPTION_INVALID_VALUE);
+    EXPECT_EQ(vm.set_option("trace_selector", "a9059cbb"), EVMC_SET_OPTION_SUCCESS);
+    ASSERT_TRUE(filter.selector.has_value());
+    EXPECT_EQ(filter.selector->at(0), 0xa9);
+    EXPECT_EQ(filter.selector->at(3), 0xbb);
+}
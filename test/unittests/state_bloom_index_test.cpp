@@ -0,0 +1,117 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <test/state/bloom_index.hpp>
+#include <test/state/state.hpp>
+#include <bit>
+
+using namespace evmc::literals;
+using namespace evmone::state;
+
+namespace
+{
+/// Checks if the bloom filter may contain the entry.
+bool bloom_contains(const BloomFilter& bloom, bytes_view entry) noexcept
+{
+    for (const auto bit_index : bloom_bits(entry))
+    {
+        if ((bloom.bytes[bit_index / 8] & (1 << (7 - bit_index % 8))) == 0)
+            return false;
+    }
+    return true;
+}
+
+/// Creates the bloom filter of the block with the single log.
+BloomFilter log_bloom(const address& addr, std::vector<hash256> topics = {})
+{
+    const Log log{.addr = addr, .data = {}, .topics = std::move(topics)};
+    return compute_bloom_filter(std::span{&log, 1});
+}
+
+constexpr auto addr1 = 0xa1_address;
+constexpr auto addr2 = 0xa2_address;
+constexpr auto addr3 = 0xa3_address;
+constexpr auto topic1 = 0x01_bytes32;
+constexpr auto topic2 = 0x02_bytes32;
+}  // namespace
+
+TEST(state_bloom_index, bloom_bits)
+{
+    const auto bloom = log_bloom(addr1, {topic1});
+    EXPECT_TRUE(bloom_contains(bloom, addr1));
+    EXPECT_TRUE(bloom_contains(bloom, topic1));
+
+    int num_bits = 0;
+    for (const auto b : bloom.bytes)
+        num_bits += std::popcount(b);
+    EXPECT_LE(num_bits, 6);
+}
+
+TEST(state_bloom_index, match)
+{
+    BloomIndex index{100};
+    index.add(log_bloom(addr1, {topic1}));  // 100
+    index.add({});                          // 101
+    index.add(log_bloom(addr2, {topic1}));  // 102
+    index.add(log_bloom(addr1, {topic2}));  // 103
+    EXPECT_EQ(index.first_block(), 100);
+    EXPECT_EQ(index.next_block(), 104);
+
+    using V = std::vector<int64_t>;
+    const std::vector<std::vector<bytes_view>> by_addr{{addr1}};
+    EXPECT_EQ(index.match(by_addr, 0, 1000), (V{100, 103}));
+    EXPECT_EQ(index.match(by_addr, 101, 102), V{});
+    EXPECT_EQ(index.match(by_addr, 103, 103), V{103});
+    EXPECT_EQ(index.match(by_addr, 104, 1000), V{});
+
+    const std::vector<std::vector<bytes_view>> by_addr_and_topic{{addr1}, {topic1}};
+    EXPECT_EQ(index.match(by_addr_and_topic, 0, 1000), V{100});
+
+    const std::vector<std::vector<bytes_view>> by_any_addr{{addr2, addr1}, {topic1}};
+    EXPECT_EQ(index.match(by_any_addr, 0, 1000), (V{100, 102}));
+
+    const std::vector<std::vector<bytes_view>> by_absent{{addr3}};
+    EXPECT_EQ(index.match(by_absent, 0, 1000), V{});
+
+    // No criteria or the empty criterion match all the blocks in the range.
+    EXPECT_EQ(index.match({}, 101, 102), (V{101, 102}));
+    const std::vector<std::vector<bytes_view>> wildcard{{}, {topic2}};
+    EXPECT_EQ(index.match(wildcard, 0, 1000), V{103});
+}
+
+TEST(state_bloom_index, sections)
+{
+    // Index the blocks spanning over 3 sections, every 7th block with the log of addr1,
+    // and compare the results with checking the bloom filter of every block.
+    BloomIndex index;
+    std::vector<BloomFilter> blooms;
+    for (size_t i = 0; i < 2 * BloomIndex::section_size + 100; ++i)
+    {
+        const auto& bloom = blooms.emplace_back(
+            i % 7 == 0 ? log_bloom(addr1, {topic1}) : log_bloom(address{i}, {topic2}));
+        index.add(bloom);
+    }
+
+    const std::vector<std::vector<bytes_view>> criteria{{addr1}, {topic1}};
+    const auto check = [&](int64_t from, int64_t to) {
+        std::vector<int64_t> expected;
+        for (auto n = from; n <= to; ++n)
+        {
+            const auto& bloom = blooms[static_cast<size_t>(n)];
+            if (bloom_contains(bloom, addr1) && bloom_contains(bloom, topic1))
+                expected.push_back(n);
+        }
+        EXPECT_EQ(index.match(criteria, from, to), expected) << from << ".." << to;
+    };
+
+    const auto last = index.next_block() - 1;
+    constexpr auto s = static_cast<int64_t>(BloomIndex::section_size);
+    check(0, last);
+    check(1, s - 1);
+    check(s - 10, s + 10);
+    check(s + 63, 2 * s + 64);
+    check(2 * s, last);
+    check(last, last);
+}
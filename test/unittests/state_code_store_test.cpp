@@ -0,0 +1,143 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <test/state/state.hpp>
+#include <test/utils/bytecode.hpp>
+
+using namespace evmone;
+using namespace evmone::state;
+using namespace evmone::test;
+
+namespace
+{
+/// Generates the code looking like a contract dispatching many function selectors.
+bytes dispatcher_code(int num_functions)
+{
+    auto code = bytecode{} + calldataload(0) + push(0xe0) + OP_SHR;
+    for (int i = 0; i < num_functions; ++i)
+        code += OP_DUP1 + push(0x12345600 + i) + OP_EQ + push(0x1000 + 0x20 * i) + OP_JUMPI;
+    return code;
+}
+}  // namespace
+
+TEST(state_code_store, code)
+{
+    const Code empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT_EQ(empty.hash(), keccak256({}));
+    EXPECT_EQ(empty, bytes_view{});
+    EXPECT_EQ(empty.prefix(), bytes_view{});
+    EXPECT_TRUE(Code{bytes{}}.empty());
+    EXPECT_EQ(Code{bytes{0xef}}.prefix(), bytes{0xef});
+
+    const auto code_bytes = bytes{0x60, 0x01, 0x00};
+    const Code code{code_bytes};
+    EXPECT_FALSE(code.empty());
+    EXPECT_FALSE(code.is_compressed());
+    EXPECT_EQ(code.size(), 3u);
+    EXPECT_EQ(code.hash(), keccak256(code_bytes));
+    EXPECT_EQ(code, code_bytes);
+    EXPECT_EQ(code.prefix(), (bytes{0x60, 0x01}));
+
+    // The copies share the code.
+    const auto copy = code;
+    EXPECT_EQ(copy.load().get(), code.load().get());
+}
+
+TEST(state_code_store, dedup)
+{
+    CodeStore store;
+    const auto code_bytes = dispatcher_code(10);
+
+    const auto a = store.intern(code_bytes);
+    const auto b = store.intern(code_bytes);
+    const auto c = store.intern(Code{code_bytes});
+    const auto d = store.intern(bytes{0xfe});
+    EXPECT_EQ(a, code_bytes);
+    EXPECT_EQ(a.load().get(), b.load().get());
+    EXPECT_EQ(a.load().get(), c.load().get());
+    EXPECT_NE(a.load().get(), d.load().get());
+    EXPECT_TRUE(store.intern(bytes_view{}).empty());
+
+    auto stats = store.get_stats();
+    EXPECT_EQ(stats.num_codes, 2u);
+    EXPECT_EQ(stats.code_size, code_bytes.size() + 1);
+    EXPECT_EQ(stats.stored_size, stats.code_size);
+
+    // The code not used anymore is freed.
+    {
+        const auto tmp = store.intern(bytes{0x00});
+        EXPECT_EQ(store.get_stats().num_codes, 3u);
+    }
+    EXPECT_EQ(store.get_stats().num_codes, 2u);
+}
+
+TEST(state_code_store, compression)
+{
+    CodeStore store{{.compression_threshold = 100, .hot_cache_size = 1}};
+    const auto big = dispatcher_code(100);
+    const auto small = bytes{0x60, 0x01, 0x60, 0x01, 0x60, 0x01, 0x60, 0x01, 0x00};
+
+    const auto big_code = store.intern(big);
+    const auto small_code = store.intern(small);
+    EXPECT_TRUE(big_code.is_compressed());
+    EXPECT_FALSE(small_code.is_compressed());
+    EXPECT_EQ(big_code.size(), big.size());
+    EXPECT_EQ(big_code.hash(), keccak256(big));
+
+    auto stats = store.get_stats();
+    EXPECT_EQ(stats.code_size, big.size() + small.size());
+    EXPECT_LT(stats.stored_size, stats.code_size);
+
+    // The code prefix is available without decompressing the code.
+    EXPECT_EQ(big_code.prefix(), big.substr(0, Code::prefix_size));
+    EXPECT_EQ(store.get_stats().hot_cache_misses, 0u);
+
+    // The decompressed code is cached.
+    const auto loaded = big_code.load();
+    EXPECT_EQ(*loaded, big);
+    EXPECT_EQ(big_code.load().get(), loaded.get());
+    stats = store.get_stats();
+    EXPECT_EQ(stats.hot_cache_misses, 1u);
+    EXPECT_EQ(stats.hot_cache_hits, 1u);
+
+    // The evicted code stays valid for the holders.
+    const auto other = bytes(200, 0x5b);
+    const auto other_code = store.intern(other);
+    EXPECT_TRUE(other_code.is_compressed());
+    EXPECT_EQ(other_code, other);
+    EXPECT_EQ(*loaded, big);
+    EXPECT_EQ(big_code, big);
+    EXPECT_EQ(store.get_stats().hot_cache_misses, 3u);
+
+    // The code mixing repeated and random-looking parts round-trips.
+    auto mixed = bytes(3000, 0);
+    for (size_t i = 0; i < mixed.size(); ++i)
+        mixed[i] = static_cast<uint8_t>((i % 500 < 250) ? i % 7 : (i * i * 167) >> 5);
+    EXPECT_EQ(store.intern(mixed), mixed);
+}
+
+TEST(state_code_store, state)
+{
+    const auto code = dispatcher_code(5);
+
+    State state;
+    state.insert(0x01_address, {.code = code});
+    state.insert(0x02_address, {.code = code});
+    const auto code_ptr = [](State& s, const address& addr) { return s.get(addr).code.load(); };
+    EXPECT_NE(code_ptr(state, 0x01_address), code_ptr(state, 0x02_address));
+
+    const auto store = std::make_shared<CodeStore>();
+    state.set_code_store(store);
+    EXPECT_EQ(code_ptr(state, 0x01_address), code_ptr(state, 0x02_address));
+    EXPECT_EQ(store->get_stats().num_codes, 1u);
+
+    // The code deployed in the fork is deduplicated too.
+    auto fork = state.fork();
+    fork.insert(0x03_address, {.code = fork.make_code(code)});
+    EXPECT_EQ(code_ptr(fork, 0x03_address), code_ptr(state, 0x01_address));
+    EXPECT_EQ(store->get_stats().num_codes, 1u);
+}
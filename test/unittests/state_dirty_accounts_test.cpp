@@ -0,0 +1,85 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <test/state/state.hpp>
+
+using namespace evmc::literals;
+using namespace evmone::state;
+
+TEST(state_dirty_accounts, mark_and_clean)
+{
+    State state;
+    state.insert(0x01_address, {.nonce = 1});
+    state.insert(0x02_address, {.nonce = 2});
+    EXPECT_EQ(state.num_dirty(), 2u);
+    EXPECT_TRUE(state.get(0x01_address).dirty);
+
+    int num_cleaned = 0;
+    state.clean([&](Account&) noexcept { ++num_cleaned; });
+    EXPECT_EQ(num_cleaned, 2);
+    EXPECT_EQ(state.num_dirty(), 0u);
+
+    // Reads do not mark accounts dirty.
+    EXPECT_EQ(std::as_const(state).find(0x01_address)->nonce, 1u);
+    EXPECT_EQ(state.num_dirty(), 0u);
+
+    // The account is listed once.
+    state.get(0x02_address).nonce = 3;
+    state.get(0x02_address).nonce = 4;
+    EXPECT_EQ(state.num_dirty(), 1u);
+    EXPECT_FALSE(std::as_const(state).find(0x01_address)->dirty);
+
+    num_cleaned = 0;
+    state.clean([&](Account& acc) noexcept {
+        EXPECT_EQ(acc.nonce, 4u);
+        ++num_cleaned;
+    });
+    EXPECT_EQ(num_cleaned, 1);
+    EXPECT_FALSE(std::as_const(state).find(0x02_address)->dirty);
+}
+
+TEST(state_dirty_accounts, erase)
+{
+    State state;
+    state.insert(0x01_address, {.erasable = true});
+    state.insert(0x02_address, {.erasable = true});
+    state.clean([](Account&) noexcept {});
+
+    // Only the dirty accounts are checked.
+    state.touch(0x03_address);
+    state.erase_dirty_if([](const auto& p) noexcept { return p.second.erasable; });
+    EXPECT_EQ(state.get_accounts().size(), 2u);
+    EXPECT_EQ(std::as_const(state).find(0x03_address), nullptr);
+
+    state.touch(0x01_address);
+    state.erase_dirty_if([](const auto& p) noexcept { return p.second.erasable; });
+    EXPECT_EQ(std::as_const(state).find(0x01_address), nullptr);
+    EXPECT_NE(std::as_const(state).find(0x02_address), nullptr);
+
+    // The erased accounts are skipped.
+    int num_cleaned = 0;
+    state.clean([&](Account&) noexcept { ++num_cleaned; });
+    EXPECT_EQ(num_cleaned, 0);
+}
+
+TEST(state_dirty_accounts, fork)
+{
+    State base;
+    base.insert(0x01_address, {.nonce = 1});
+    base.insert(0x02_address, {.nonce = 2});
+    base.clean([](Account&) noexcept {});
+
+    auto fork = base.fork();
+    EXPECT_EQ(fork.num_dirty(), 0u);
+    fork.get(0x01_address).nonce = 10;
+    EXPECT_EQ(fork.num_dirty(), 1u);
+    EXPECT_EQ(base.num_dirty(), 0u);
+    EXPECT_FALSE(std::as_const(base).find(0x01_address)->dirty);
+
+    fork.commit();
+    EXPECT_EQ(fork.num_dirty(), 0u);
+    EXPECT_EQ(base.num_dirty(), 1u);
+    EXPECT_TRUE(std::as_const(base).find(0x01_address)->dirty);
+}
@@ -0,0 +1,203 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "../utils/bytecode.hpp"
+#include "state_transition.hpp"
+#include <test/state/mpt_hash.hpp>
+
+using namespace evmc::literals;
+using namespace evmone::state;
+using namespace evmone::test;
+
+TEST(state_fork, copy_on_access)
+{
+    State base;
+    base.insert(0x01_address, {.nonce = 1});
+    base.insert(0x02_address, {.nonce = 2});
+
+    auto fork = base.fork();
+    EXPECT_TRUE(fork.get_accounts().empty());
+    EXPECT_EQ(std::as_const(fork).find(0x01_address)->nonce, 1);
+    EXPECT_TRUE(fork.get_accounts().empty());
+
+    fork.get(0x01_address).nonce = 10;
+    fork.insert(0x03_address, {.nonce = 3});
+    EXPECT_EQ(fork.get_accounts().size(), 2);
+    EXPECT_EQ(fork.find(0x02_address)->nonce, 2);
+    EXPECT_EQ(fork.get_accounts().size(), 3);
+
+    // The base state is not modified.
+    EXPECT_EQ(base.get(0x01_address).nonce, 1);
+    EXPECT_EQ(base.find(0x03_address), nullptr);
+
+    fork.commit();
+    EXPECT_TRUE(fork.get_accounts().empty());
+    EXPECT_EQ(base.get(0x01_address).nonce, 10);
+    EXPECT_EQ(base.get(0x02_address).nonce, 2);
+    EXPECT_EQ(base.get(0x03_address).nonce, 3);
+}
+
+TEST(state_fork, erase)
+{
+    State base;
+    base.insert(0x01_address, {.nonce = 1});
+    base.insert(0x02_address, {.nonce = 2});
+
+    auto fork = base.fork();
+    fork.touch(0x01_address).nonce = 0;
+    fork.erase_if([](const auto& p) noexcept { return p.second.nonce == 0; });
+    EXPECT_EQ(fork.find(0x01_address), nullptr);
+    EXPECT_EQ(std::as_const(fork).find(0x01_address), nullptr);
+    EXPECT_NE(base.find(0x01_address), nullptr);
+
+    fork.commit();
+    EXPECT_EQ(base.find(0x01_address), nullptr);
+    EXPECT_EQ(base.get_accounts().size(), 1);
+
+    // Only the accounts copied to the fork are checked.
+    auto fork2 = base.fork();
+    fork2.erase_if([](const auto&) noexcept { return true; });
+    EXPECT_NE(fork2.find(0x02_address), nullptr);
+
+    // The erased account can be created again.
+    fork2.erase_if([](const auto&) noexcept { return true; });
+    EXPECT_EQ(fork2.find(0x02_address), nullptr);
+    fork2.insert(0x02_address, {.nonce = 7});
+    fork2.commit();
+    EXPECT_EQ(base.get(0x02_address).nonce, 7);
+}
+
+TEST(state_fork, nested)
+{
+    State base;
+    base.insert(0x01_address, {.nonce = 1});
+
+    auto child = base.fork();
+    child.get(0x01_address).nonce = 2;
+
+    {
+        // The discarded grandchild.
+        auto grandchild = child.fork();
+        grandchild.get(0x01_address).nonce = 3;
+        grandchild.insert(0x02_address);
+    }
+    EXPECT_EQ(child.get(0x01_address).nonce, 2);
+    EXPECT_EQ(child.find(0x02_address), nullptr);
+
+    auto grandchild = child.fork();
+    EXPECT_EQ(grandchild.get(0x01_address).nonce, 2);
+    grandchild.get(0x01_address).nonce = 4;
+    grandchild.erase_if([](const auto&) noexcept { return true; });
+    grandchild.insert(0x03_address);
+    grandchild.commit();
+
+    EXPECT_EQ(child.find(0x01_address), nullptr);
+    EXPECT_NE(child.find(0x03_address), nullptr);
+    EXPECT_EQ(base.get(0x01_address).nonce, 1);
+
+    child.commit();
+    EXPECT_EQ(base.find(0x01_address), nullptr);
+    EXPECT_NE(base.find(0x03_address), nullptr);
+}
+
+TEST(state_fork, storage_overlay)
+{
+    constexpr auto A = 0x01_address;
+    State base;
+    auto& acc = base.insert(A);
+    for (uint64_t i = 1; i <= 100; ++i)
+        acc.storage[bytes32{i}] = {.current = bytes32{i}, .original = bytes32{i}};
+
+    // Only the accessed slots are copied to the fork.
+    auto child = base.fork();
+    child.get_storage(A, 0x02_bytes32).current = 0x22_bytes32;
+    EXPECT_EQ(child.get(A).storage.size(), 1);
+    EXPECT_EQ(child.find_storage(A, 0x03_bytes32)->current, 0x03_bytes32);
+    EXPECT_EQ(child.get(A).storage.size(), 1);
+    EXPECT_EQ(child.get_storage(A, 0x03_bytes32).original, 0x03_bytes32);
+    EXPECT_EQ(child.get(A).storage.size(), 2);
+    EXPECT_EQ(child.find_storage(A, 0xff_bytes32), nullptr);
+
+    auto grandchild = child.fork();
+    EXPECT_EQ(grandchild.get_storage(A, 0x02_bytes32).current, 0x22_bytes32);
+    EXPECT_EQ(grandchild.get_storage(A, 0x04_bytes32).current, 0x04_bytes32);
+    grandchild.get_storage(A, 0x05_bytes32).current = 0x55_bytes32;
+    grandchild.commit();
+    EXPECT_EQ(child.get(A).storage.size(), 4);
+    EXPECT_EQ(base.find_storage(A, 0x02_bytes32)->current, 0x02_bytes32);
+
+    child.commit();
+    const auto& storage = base.get(A).storage;
+    EXPECT_EQ(storage.size(), 100);
+    EXPECT_EQ(storage.at(0x02_bytes32).current, 0x22_bytes32);
+    EXPECT_EQ(storage.at(0x05_bytes32).current, 0x55_bytes32);
+    EXPECT_EQ(storage.at(0x06_bytes32).current, 0x06_bytes32);
+}
+
+TEST(state_fork, storage_overlay_discarded)
+{
+    constexpr auto A = 0x01_address;
+    State base;
+    base.insert(A, {.storage = {{0x01_bytes32, {.current = 0x01_bytes32}},
+                       {0x02_bytes32, {.current = 0x02_bytes32}}}});
+
+    // The cleared storage does not fall back to the parent state.
+    auto fork = base.fork();
+    fork.get_storage(A, 0x01_bytes32).current = 0x11_bytes32;
+    fork.discard_parent_storage(A);
+    EXPECT_EQ(fork.find_storage(A, 0x01_bytes32)->current, 0x11_bytes32);
+    EXPECT_EQ(fork.find_storage(A, 0x02_bytes32), nullptr);
+    EXPECT_EQ(fork.get_storage(A, 0x02_bytes32).current, bytes32{});
+    EXPECT_EQ(base.find_storage(A, 0x02_bytes32)->current, 0x02_bytes32);
+    fork.commit();
+    EXPECT_EQ(base.get(A).storage.size(), 2);
+    EXPECT_EQ(base.get(A).storage.at(0x02_bytes32).current, bytes32{});
+
+    // The account created again has the empty storage.
+    auto fork2 = base.fork();
+    fork2.get(A);
+    fork2.erase_if([](const auto&) noexcept { return true; });
+    fork2.insert(A);
+    EXPECT_EQ(fork2.find_storage(A, 0x01_bytes32), nullptr);
+    fork2.commit();
+    EXPECT_TRUE(base.get(A).storage.empty());
+}
+
+using state_fork_transition = state_execution;
+
+TEST_F(state_fork_transition, bundle_simulation)
+{
+    pre.insert(To, {.code = sstore(1, add(sload(1), calldataload(0)))});
+    for (uint64_t i = 0; i < 100; ++i)
+        pre.insert(address{0x1000 + i}, {.balance = i});
+
+    tx.to = To;
+    tx.gas_limit = 100'000;
+    const auto execute_bundle = [&](State& state, uint64_t arg) {
+        auto bundle_tx = tx;
+        bundle_tx.data = bytes(31, 0) + bytes{static_cast<uint8_t>(arg)};
+        for (; bundle_tx.nonce <= 2; ++bundle_tx.nonce)
+            EXPECT_EQ(execute(state, bundle_tx, vm).status, EVMC_SUCCESS);
+        finalize(state, rev, block.coinbase, std::nullopt, {}, {});
+    };
+
+    // Simulate the bundles on top of the same pre-state.
+    for (uint64_t arg = 1; arg <= 3; ++arg)
+    {
+        auto fork = pre.fork();
+        execute_bundle(fork, arg);
+        EXPECT_EQ(fork.get(To).storage[0x01_bytes32].current, bytes32{2 * arg});
+        EXPECT_LT(fork.get_accounts().size(), 10);
+    }
+    EXPECT_EQ(pre.get(Sender).nonce, 1);
+
+    // Commit the selected bundle and compare with the direct execution.
+    auto expected = pre;
+    execute_bundle(expected, 2);
+
+    auto fork = pre.fork();
+    execute_bundle(fork, 2);
+    fork.commit();
+    EXPECT_EQ(mpt_hash(pre.get_accounts()), mpt_hash(expected.get_accounts()));
+}
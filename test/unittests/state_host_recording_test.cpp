@@ -0,0 +1,74 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "../utils/bytecode.hpp"
+#include "state_transition.hpp"
+#include <test/state/host_recording.hpp>
+
+using namespace evmc::literals;
+using namespace evmone::test;
+
+class state_host_recording : public state_execution
+{
+protected:
+    static constexpr auto Callee = 0xca11_address;
+
+    /// Executes the transaction calling the To contract with the recording VM.
+    std::vector<HostRecording> record_transaction(const bytes& code)
+    {
+        pre.insert(Callee, {.code = sstore(1, add(sload(1), 1))});
+        pre.insert(To, {.code = code});
+        tx.to = To;
+
+        std::vector<HostRecording> recordings;
+        evmc::VM recording_vm{create_recording_vm(vm, recordings)};
+        auto state = pre;
+        execute(state, tx, recording_vm);
+        return recordings;
+    }
+};
+
+TEST_F(state_host_recording, record_and_replay)
+{
+    const auto code = sstore(0, 0xff) + call(Callee).gas(0xffff) + mstore(0, sload(0)) + ret(0, 32);
+    const auto recordings = record_transaction(code);
+
+    // Only the top-level message is recorded.
+    ASSERT_EQ(recordings.size(), 1);
+    EXPECT_TRUE(recordings[0].host_ext);
+    EXPECT_EQ(recordings[0].code, code);
+
+    const auto serialized = recordings[0].serialize();
+    const auto recording = HostRecording::deserialize(serialized);
+    ASSERT_TRUE(recording.has_value());
+    EXPECT_EQ(recording->serialize(), serialized);
+    EXPECT_FALSE(HostRecording::deserialize(bytes_view{serialized}.substr(1)).has_value());
+
+    ReplayHost host{*recording};
+    const auto msg = recording->message();
+    for (int i = 0; i < 2; ++i)
+    {
+        host.reset();
+        const auto r = vm.execute(ReplayHost::get_extended_interface().evmc, host.to_context(),
+            recording->rev, msg, recording->code.data(), recording->code.size());
+        EXPECT_EQ(r.status_code, EVMC_SUCCESS);
+        ASSERT_EQ(r.output_size, 32);
+        EXPECT_EQ(r.output_data[31], 0xff);
+        EXPECT_FALSE(host.diverged());
+        EXPECT_TRUE(host.finished());
+    }
+}
+
+TEST_F(state_host_recording, replay_diverged)
+{
+    const auto recordings = record_transaction(sstore(0, 0xff));
+    ASSERT_EQ(recordings.size(), 1);
+
+    // Execute different code: the storage key does not match.
+    const auto code = sstore(1, 0xff);
+    ReplayHost host{recordings[0]};
+    [[maybe_unused]] const auto r = vm.execute(ReplayHost::get_extended_interface().evmc,
+        host.to_context(), recordings[0].rev, recordings[0].message(), code.data(), code.size());
+    EXPECT_TRUE(host.diverged());
+}
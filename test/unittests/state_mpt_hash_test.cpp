@@ -108,6 +108,7 @@ TEST(state_mpt_hash, one_transactions)
 
     const auto tx_root = mpt_hash(std::array{tx});
     EXPECT_EQ(tx_root, 0x6ce50bfaaebabe884433c144fa4d8a4c1087e443587a9788b30381636dedbeb2_bytes32);
+    EXPECT_EQ(mpt_hash_encoded(std::array{rlp::encode(tx)}), tx_root);
 }
 
 TEST(state_mpt_hash, legacy_and_eip1559_receipt_three_logs_no_logs)
@@ -0,0 +1,145 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "../utils/bytecode.hpp"
+#include "state_transition.hpp"
+#include <gmock/gmock.h>
+#include <test/state/prefetch.hpp>
+#include <test/state/storage_heatmap.hpp>
+
+using namespace evmc::literals;
+using namespace evmone::test;
+using testing::UnorderedElementsAre;
+
+class state_prefetch : public state_execution
+{
+protected:
+    static constexpr auto Other = 0x07e2_address;
+
+    state_prefetch() noexcept { tx.to = To; }
+
+    /// Predicts the accesses of the transaction with the To contract having the code.
+    AccessPrediction predict(const bytes& code)
+    {
+        auto state = pre;
+        state.insert(To, {.code = code});
+        return predict_accesses(state, tx);
+    }
+};
+
+TEST_F(state_prefetch, predict_accesses)
+{
+    const auto code = sstore(1, add(sload(2), 1)) + sload(calldataload(0)) + OP_PUSH0 + OP_SLOAD;
+    tx.access_list = {{Other, {0x03_bytes32}}};
+
+    const auto p = predict(code);
+    EXPECT_THAT(p.accounts, UnorderedElementsAre(Sender, To, Other));
+    EXPECT_THAT(p.storage,
+        UnorderedElementsAre(std::pair{To, 0x01_bytes32}, std::pair{To, 0x02_bytes32},
+            std::pair{To, 0x00_bytes32}, std::pair{Other, 0x03_bytes32}));
+
+    EXPECT_THAT(p.account_writes, UnorderedElementsAre(Sender));
+    EXPECT_THAT(p.storage_writes, UnorderedElementsAre(std::pair{To, 0x01_bytes32}));
+    EXPECT_THAT(p.dynamic_storage_reads, UnorderedElementsAre(To));
+    EXPECT_TRUE(p.dynamic_storage_writes.empty());
+    EXPECT_FALSE(p.unknown_accesses);
+}
+
+TEST_F(state_prefetch, predict_function_accesses)
+{
+    // The Solidity-style dispatcher of 2 functions:
+    // - 0x40: the function A calling the internal function at 0x80 returning to 0x70,
+    // - 0x60: the function B,
+    // - 0x90: the unreachable code.
+    const auto dispatch = [](uint64_t selector, uint64_t dest) {
+        return OP_DUP1 + push(selector) + OP_EQ + push(dest) + OP_JUMPI;
+    };
+    bytecode code = calldataload(0) + push(0xe0) + OP_SHR + dispatch(0xa9059cbb, 0x40) +
+                    dispatch(0x70a08231, 0x60) + OP_STOP;
+    const auto append_at = [&code](size_t offset, const bytecode& part) {
+        ASSERT_LE(code.size(), offset);
+        code.resize(offset, OP_STOP);
+        code += part;
+    };
+    append_at(0x40, OP_JUMPDEST + sstore(1, sload(2)) + push(0x70) + jump(push(0x80)));
+    append_at(0x60, OP_JUMPDEST + sload(3) + OP_STOP);
+    append_at(0x70, OP_JUMPDEST + sload(4) + OP_STOP);
+    append_at(0x80, OP_JUMPDEST + sstore(5, 0) + OP_JUMP);
+    append_at(0x90, OP_JUMPDEST + sload(6) + call(Other) + OP_STOP);
+
+    tx.data = bytes{0xa9, 0x05, 0x9c, 0xbb};
+    auto p = predict(code);
+    EXPECT_THAT(p.storage,
+        UnorderedElementsAre(std::pair{To, 0x01_bytes32}, std::pair{To, 0x02_bytes32},
+            std::pair{To, 0x04_bytes32}, std::pair{To, 0x05_bytes32}));
+    EXPECT_THAT(p.storage_writes,
+        UnorderedElementsAre(std::pair{To, 0x01_bytes32}, std::pair{To, 0x05_bytes32}));
+    EXPECT_TRUE(p.dynamic_storage_reads.empty());
+    EXPECT_FALSE(p.unknown_accesses);  // The CALL is not reachable.
+
+    tx.data = bytes{0x70, 0xa0, 0x82, 0x31, 0x00};
+    p = predict(code);
+    EXPECT_THAT(p.storage, UnorderedElementsAre(std::pair{To, 0x03_bytes32}));
+    EXPECT_TRUE(p.storage_writes.empty());
+    EXPECT_FALSE(p.unknown_accesses);
+
+    // The unknown function: the whole code is inspected.
+    tx.data = bytes{0x12, 0x34, 0x56, 0x78};
+    p = predict(code);
+    EXPECT_EQ(p.storage.size(), 6u);
+    EXPECT_EQ(p.storage_writes.size(), 2u);
+    EXPECT_TRUE(p.unknown_accesses);
+
+    tx.data = {};
+    tx.value = 1;
+    p = predict(code);
+    EXPECT_EQ(p.storage.size(), 6u);
+    EXPECT_THAT(p.account_writes, UnorderedElementsAre(Sender, To));
+}
+
+TEST_F(state_prefetch, predict_unknown_accesses)
+{
+    EXPECT_TRUE(predict(call(Other) + sstore(1, 1)).unknown_accesses);
+    EXPECT_TRUE(predict(delegatecall(Other)).unknown_accesses);
+    EXPECT_TRUE(predict(create()).unknown_accesses);
+    EXPECT_TRUE(predict(selfdestruct(Other)).unknown_accesses);
+    EXPECT_TRUE(predict(bytecode{OP_CALLER} + OP_BALANCE).unknown_accesses);
+
+    // The CALL opcode in the push data is not an instruction.
+    EXPECT_FALSE(predict(push(uint64_t{OP_CALL}) + sload(1)).unknown_accesses);
+
+    // The initcode of the contract creation is not inspected.
+    tx.to.reset();
+    EXPECT_TRUE(predict({}).unknown_accesses);
+}
+
+TEST_F(state_prefetch, predict_truncated_push)
+{
+    const auto p = predict(push(1) + OP_SLOAD + "7f01");
+    EXPECT_THAT(p.storage, UnorderedElementsAre(std::pair{To, 0x01_bytes32}));
+}
+
+TEST_F(state_prefetch, coverage)
+{
+    // Measure the fraction of the storage slots accessed by the execution which are predicted.
+    pre.insert(To, {.code = sstore(1, add(sload(2), 1)) + sload(calldataload(0))});
+    tx.data = bytes(31, 0) + bytes{0x07};
+
+    const auto p = predict_accesses(pre, tx);
+
+    StorageHeatmap heatmap;
+    evmc::VM heatmap_vm{create_storage_heatmap_vm(vm, heatmap)};
+    auto state = pre;
+    EXPECT_EQ(execute(state, tx, heatmap_vm).status, EVMC_SUCCESS);
+
+    size_t accessed = 0;
+    size_t predicted = 0;
+    for (const auto& [key, stats] : heatmap.contracts.at(To))
+    {
+        ++accessed;
+        predicted += std::ranges::count(p.storage, std::pair{To, key});
+    }
+    EXPECT_EQ(accessed, 3);
+    EXPECT_EQ(predicted, 2);  // The slot 7 is loaded by the key from the input.
+}
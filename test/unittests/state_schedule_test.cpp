@@ -0,0 +1,164 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "../utils/bytecode.hpp"
+#include "state_transition.hpp"
+#include <gmock/gmock.h>
+#include <test/state/schedule.hpp>
+
+using namespace evmc::literals;
+using namespace evmone::state;
+using namespace evmone::test;
+using testing::ElementsAre;
+using testing::UnorderedElementsAre;
+
+namespace
+{
+constexpr auto C = 0xc0de_address;
+
+/// Creates the accesses of the transaction from the sender.
+AccessPrediction tx_from(const address& sender)
+{
+    AccessPrediction p;
+    p.accounts = {sender};
+    p.account_writes = {sender};
+    return p;
+}
+}  // namespace
+
+TEST(state_schedule, conflict_graph)
+{
+    std::vector<AccessPrediction> txs{tx_from(0x0a_address), tx_from(0x0b_address),
+        tx_from(0x0a_address), tx_from(0x0d_address), tx_from(0x0e_address),
+        tx_from(0x0f_address), tx_from(0x10_address)};
+    txs[0].storage = txs[0].storage_writes = {{C, 0x01_bytes32}};
+    txs[1].storage = {{C, 0x02_bytes32}};
+    // The txs[2] has the same sender as txs[0].
+    txs[3].storage = {{C, 0x01_bytes32}};
+    txs[4].dynamic_storage_writes = {C};
+    txs[5].dynamic_storage_reads = {C};
+    txs[6].accounts.push_back(0x0a_address);  // Reads the account modified by txs[0] and txs[2].
+
+    const auto graph = build_conflict_graph(txs);
+    ASSERT_EQ(graph.size(), txs.size());
+    EXPECT_TRUE(graph[0].empty());
+    EXPECT_TRUE(graph[1].empty());
+    EXPECT_THAT(graph[2], ElementsAre(0));
+    EXPECT_THAT(graph[3], ElementsAre(0));
+    EXPECT_THAT(graph[4], ElementsAre(0, 1, 3));
+    EXPECT_THAT(graph[5], ElementsAre(0, 4));
+    EXPECT_THAT(graph[6], ElementsAre(0, 2));
+
+    const auto waves = schedule_waves(graph);
+    ASSERT_EQ(waves.size(), 4u);
+    EXPECT_THAT(waves[0], ElementsAre(0, 1));
+    EXPECT_THAT(waves[1], ElementsAre(2, 3));
+    EXPECT_THAT(waves[2], ElementsAre(4, 6));
+    EXPECT_THAT(waves[3], ElementsAre(5));
+}
+
+TEST(state_schedule, unknown_accesses)
+{
+    std::vector<AccessPrediction> txs{
+        tx_from(0x0a_address), tx_from(0x0b_address), tx_from(0x0c_address)};
+    txs[1].unknown_accesses = true;
+
+    const auto graph = build_conflict_graph(txs);
+    EXPECT_TRUE(graph[0].empty());
+    EXPECT_THAT(graph[1], ElementsAre(0));
+    EXPECT_THAT(graph[2], ElementsAre(1));
+    EXPECT_EQ(schedule_waves(graph).size(), 3u);
+}
+
+using state_schedule_transition = state_execution;
+
+TEST_F(state_schedule_transition, nested_call_conflict)
+{
+    // The tx0 modifies the storage slot of B by the nested call from A.
+    // The tx1 loads the same slot by calling B directly.
+    constexpr auto A = 0xaa_address;
+    constexpr auto B = 0xbb_address;
+    constexpr auto Sender2 = 0x5e2d_address;
+    pre.insert(Sender2, {.nonce = 1, .balance = 1'000'000'000});
+    pre.insert(A, {.code = call(B).gas(OP_GAS)});
+    pre.insert(B, {.code = sstore(1, add(sload(1), 1))});
+
+    tx.gas_limit = 100'000;
+    std::vector txs{tx, tx};
+    txs[0].to = A;
+    txs[1].sender = Sender2;
+    txs[1].to = B;
+
+    auto state = pre;
+    std::vector<AccessPrediction> predicted;
+    std::vector<AccessPrediction> observed;
+    for (const auto& t : txs)
+    {
+        predicted.push_back(predict_accesses(state, t));
+
+        StorageHeatmap heatmap;
+        evmc::VM heatmap_vm{create_storage_heatmap_vm(vm, heatmap)};
+        EXPECT_EQ(execute(state, t, heatmap_vm).status, EVMC_SUCCESS);
+        observed.push_back(observed_accesses(t, heatmap));
+    }
+    EXPECT_EQ(state.get(B).storage.at(0x01_bytes32).current, 0x02_bytes32);
+
+    // The nested call makes the accesses of the tx0 unknown so the conflict is not missed.
+    EXPECT_TRUE(predicted[0].unknown_accesses);
+    EXPECT_THAT(build_conflict_graph(predicted)[1], ElementsAre(0));
+
+    const auto a = measure_accuracy(predicted, observed);
+    EXPECT_EQ(a.observed_conflicts, 1u);
+    EXPECT_EQ(a.missed_conflicts, 0u);
+    EXPECT_EQ(a.predicted_waves, 2u);
+}
+
+TEST(state_schedule, observed_accesses)
+{
+    StorageHeatmap heatmap;
+    heatmap.record_load(C, 0x01_bytes32);
+    heatmap.record_load(C, 0x02_bytes32);
+    heatmap.record_store(C, 0x02_bytes32);
+
+    Transaction tx{};
+    tx.sender = 0x0a_address;
+    tx.to = C;
+    tx.value = 1;
+    const auto p = observed_accesses(tx, heatmap);
+    EXPECT_THAT(p.account_writes, UnorderedElementsAre(0x0a_address, C));
+    EXPECT_THAT(p.storage,
+        UnorderedElementsAre(std::pair{C, 0x01_bytes32}, std::pair{C, 0x02_bytes32}));
+    EXPECT_THAT(p.storage_writes, UnorderedElementsAre(std::pair{C, 0x02_bytes32}));
+}
+
+TEST(state_schedule, measure_accuracy)
+{
+    std::vector<AccessPrediction> predicted{tx_from(0x0a_address), tx_from(0x0b_address)};
+    predicted[0].storage = predicted[0].storage_writes = {{C, 0x01_bytes32}};
+    predicted[1].storage = {{C, 0x02_bytes32}, {C, 0x03_bytes32}};
+
+    // The tx1 also modifies the slot 1 with the key not predicted statically.
+    auto observed = predicted;
+    observed[1].storage = {{C, 0x01_bytes32}, {C, 0x02_bytes32}};
+    observed[1].storage_writes = {{C, 0x01_bytes32}};
+
+    auto a = measure_accuracy(predicted, observed);
+    EXPECT_EQ(a.observed_slots, 3u);
+    EXPECT_EQ(a.predicted_slots, 3u);
+    EXPECT_EQ(a.predicted_observed_slots, 2u);
+    EXPECT_EQ(a.covered_observed_slots, 2u);
+    EXPECT_EQ(a.predicted_conflicts, 0u);
+    EXPECT_EQ(a.observed_conflicts, 1u);
+    EXPECT_EQ(a.missed_conflicts, 1u);
+    EXPECT_EQ(a.predicted_waves, 1u);
+    EXPECT_EQ(a.observed_waves, 2u);
+
+    // With the dynamic storage modification predicted the conflict is not missed.
+    predicted[1].dynamic_storage_writes = {C};
+    a = measure_accuracy(predicted, observed);
+    EXPECT_EQ(a.covered_observed_slots, 3u);
+    EXPECT_EQ(a.predicted_conflicts, 1u);
+    EXPECT_EQ(a.missed_conflicts, 0u);
+    EXPECT_EQ(a.predicted_waves, 2u);
+}
@@ -0,0 +1,119 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "../utils/bytecode.hpp"
+#include "state_transition.hpp"
+
+using namespace evmc::literals;
+using namespace evmone::test;
+
+class state_static_call_memo : public state_execution
+{
+protected:
+    static constexpr auto View = 0x7e_address;
+    static constexpr auto Other = 0x07e2_address;
+
+    /// Executes the transaction calling the To contract which calls the View contract
+    /// with and without the static call memo (with and without the host interface extension)
+    /// and checks the results are identical.
+    /// Returns the storage of the To contract and the memo statistics.
+    std::pair<std::unordered_map<bytes32, bytes32>, StaticCallMemo> execute_memoized(
+        const bytes& code, const bytes& view_code)
+    {
+        pre.insert(To, {.balance = 10, .code = code});
+        pre.insert(View, {.code = view_code});
+        tx.to = To;
+
+        std::unordered_map<bytes32, bytes32> storage;
+        StaticCallMemo memo;
+        evmc::VM plain_vm{evmc_create_evmone()};
+        for (auto* const exec_vm : {&plain_vm, &vm})
+        {
+            auto state = pre;
+            const auto receipt = execute(state, tx, *exec_vm);
+            auto memo_state = pre;
+            const auto memo_receipt = execute(memo_state, tx, *exec_vm, &memo);
+
+            EXPECT_EQ(receipt.status, EVMC_SUCCESS);
+            EXPECT_EQ(memo_receipt.status, receipt.status);
+            EXPECT_EQ(memo_receipt.gas_used, receipt.gas_used);
+            EXPECT_EQ(memo_state.get_accounts().size(), state.get_accounts().size());
+
+            const auto& memo_storage = memo_state.get(To).storage;
+            EXPECT_EQ(memo_storage.size(), state.get(To).storage.size());
+            for (const auto& [key, value] : state.get(To).storage)
+            {
+                EXPECT_EQ(memo_storage.at(key).current, value.current) << key;
+                storage[key] = value.current;
+            }
+        }
+        return {storage, memo};
+    }
+};
+
+TEST_F(state_static_call_memo, invalidated_by_state_write)
+{
+    const auto view_code = ret(push(Other) + OP_BALANCE);
+
+    auto code = bytecode{};
+    for (int i = 0; i < 3; ++i)
+        code += staticcall(push(View)).gas(50000).output(0x20 * i, 0x20) + OP_POP;
+    code += call(push(Other)).value(1) + OP_POP;  // Modifies the state.
+    code += staticcall(push(View)).gas(50000).output(0x60, 0x20) + OP_POP;
+    for (int i = 0; i < 4; ++i)
+        code += sstore(i, mload(0x20 * i));
+
+    // The first call touches the View and warms up the Other account so
+    // only the second call is memoized. The counters are for both VMs.
+    const auto [storage, memo] = execute_memoized(code, view_code);
+    EXPECT_EQ(memo.hits, 2);
+    EXPECT_EQ(memo.misses, 6);
+    EXPECT_EQ(storage.at(0x02_bytes32), 0x00_bytes32);
+    EXPECT_EQ(storage.at(0x03_bytes32), 0x01_bytes32);
+}
+
+TEST_F(state_static_call_memo, revert)
+{
+    // Returns if called without input, reverts otherwise.
+    const auto prefix = mstore(0, 0xdead) + calldatasize();
+    const auto ret_code = ret(0, 0x20);
+    const auto view_code = prefix + push(prefix.size() + 3 + ret_code.size()) + OP_JUMPI +
+                           ret_code + OP_JUMPDEST + revert(0, 0x20);
+
+    auto code = staticcall(push(View)).gas(50000) + OP_POP;  // Touches the View.
+    for (int i = 0; i < 3; ++i)
+    {
+        code += staticcall(push(View)).gas(50000).input(0, 1).output(0x20 * i, 0x20) +
+                mstore(0x80 + 0x20 * i);
+    }
+    for (int i = 0; i < 3; ++i)
+        code += sstore(i, mload(0x20 * i)) + sstore(3 + i, mload(0x80 + 0x20 * i));
+
+    // The reverted execution has not modified the state so it is memoized.
+    const auto [storage, memo] = execute_memoized(code, view_code);
+    EXPECT_EQ(memo.hits, 4);
+    EXPECT_EQ(memo.misses, 4);
+    EXPECT_EQ(storage.at(0x02_bytes32), 0xdead_bytes32);
+    EXPECT_EQ(storage.at(0x05_bytes32), 0x00_bytes32);  // Failure.
+}
+
+TEST_F(state_static_call_memo, keyed_by_gas_and_input)
+{
+    const auto view_code = mstore(0, OP_GAS) + mstore(0x20, calldataload(0)) + ret(0, 0x40);
+
+    auto code = mstore(0x200, 1);
+    for (int i = 0; i < 3; ++i)
+        code += staticcall(push(View)).gas(50000).output(0x40 * i, 0x40) + OP_POP;
+    code += staticcall(push(View)).gas(40000).output(0xc0, 0x40) + OP_POP;
+    code += staticcall(push(View)).gas(50000).input(0x200, 0x20).output(0x100, 0x40) + OP_POP;
+    for (int i = 0; i < 10; ++i)
+        code += sstore(i, mload(0x20 * i));
+
+    const auto [storage, memo] = execute_memoized(code, view_code);
+    EXPECT_EQ(memo.hits, 2);
+    EXPECT_EQ(memo.misses, 8);
+    EXPECT_EQ(storage.at(0x00_bytes32), storage.at(0x04_bytes32));
+    EXPECT_NE(storage.at(0x00_bytes32), storage.at(0x06_bytes32));
+    EXPECT_EQ(storage.at(0x09_bytes32), 0x01_bytes32);
+}
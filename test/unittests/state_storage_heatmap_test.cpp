@@ -0,0 +1,55 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "../utils/bytecode.hpp"
+#include "state_transition.hpp"
+#include <gmock/gmock.h>
+#include <test/state/storage_heatmap.hpp>
+#include <sstream>
+
+using namespace evmc::literals;
+using namespace evmone::test;
+using testing::HasSubstr;
+
+using state_storage_heatmap = state_execution;
+
+TEST_F(state_storage_heatmap, collect_and_report)
+{
+    constexpr auto Callee = 0xca11_address;
+
+    pre.insert(Callee, {.code = sstore(1, add(sload(1), 1))});
+    pre.insert(To, {.code = sstore(0, 0xff) + call(Callee).gas(0xffff) +
+                            call(Callee).gas(0xffff) + sload(0)});
+    tx.to = To;
+
+    StorageHeatmap heatmap;
+    evmc::VM heatmap_vm{create_storage_heatmap_vm(vm, heatmap)};
+    auto state = pre;
+    EXPECT_EQ(execute(state, tx, heatmap_vm).status, EVMC_SUCCESS);
+
+    ASSERT_EQ(heatmap.contracts.size(), 2);
+    const auto& to_slot = heatmap.contracts.at(To).at(evmc::bytes32{0});
+    EXPECT_EQ(to_slot.loads, 1);
+    EXPECT_EQ(to_slot.stores, 1);
+    EXPECT_EQ(to_slot.cold_accesses, 1);
+    EXPECT_EQ(to_slot.warm_accesses, 1);
+
+    // The callee slot is accessed in both calls: cold in the first one only.
+    const auto& callee_slot = heatmap.contracts.at(Callee).at(evmc::bytes32{1});
+    EXPECT_EQ(callee_slot.loads, 2);
+    EXPECT_EQ(callee_slot.stores, 2);
+    EXPECT_EQ(callee_slot.cold_accesses, 1);
+    EXPECT_EQ(callee_slot.warm_accesses, 3);
+
+    std::ostringstream report;
+    heatmap.report(report, 1);
+    EXPECT_THAT(report.str(), HasSubstr("contracts=2 slots=2\nloads,stores,cold,warm\n3,3,2,4\n"));
+    EXPECT_THAT(report.str(),
+        HasSubstr("contract,slots,loads,stores,cold,warm\n"
+                  "0x000000000000000000000000000000000000ca11,1,2,2,1,3\n---"));
+    EXPECT_THAT(report.str(),
+        HasSubstr("contract,slot,loads,stores,cold,warm\n"
+                  "0x000000000000000000000000000000000000ca11,"
+                  "0x0000000000000000000000000000000000000000000000000000000000000001,2,2,1,3\n"));
+}
@@ -0,0 +1,77 @@
+// evmone: Fast Ethereum Virtual Machine implementation
+// Copyright 2024 The evmone Authors.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <test/state/transient_storage.hpp>
+
+using namespace evmc::literals;
+using namespace evmone::state;
+
+TEST(state_transient_storage, get_set)
+{
+    TransientStorage ts;
+    EXPECT_EQ(ts.get(0x01_address, 0x01_bytes32), 0x00_bytes32);
+
+    ts.set(0x01_address, 0x01_bytes32, 0xaa_bytes32);
+    ts.set(0x02_address, 0x01_bytes32, 0xbb_bytes32);
+    EXPECT_EQ(ts.get(0x01_address, 0x01_bytes32), 0xaa_bytes32);
+    EXPECT_EQ(ts.get(0x02_address, 0x01_bytes32), 0xbb_bytes32);
+    EXPECT_EQ(ts.get(0x01_address, 0x02_bytes32), 0x00_bytes32);
+    EXPECT_EQ(ts.size(), 2);
+
+    ts.set(0x01_address, 0x01_bytes32, 0xcc_bytes32);
+    EXPECT_EQ(ts.get(0x01_address, 0x01_bytes32), 0xcc_bytes32);
+    EXPECT_EQ(ts.size(), 2);
+}
+
+TEST(state_transient_storage, grow)
+{
+    TransientStorage ts;
+    for (uint64_t i = 0; i < 1000; ++i)
+        ts.set(address{i % 7}, bytes32{i}, bytes32{i + 1});
+    EXPECT_EQ(ts.size(), 1000);
+    for (uint64_t i = 0; i < 1000; ++i)
+        EXPECT_EQ(ts.get(address{i % 7}, bytes32{i}), bytes32{i + 1}) << i;
+    EXPECT_EQ(ts.get(address{1}, bytes32{0}), 0x00_bytes32);
+}
+
+TEST(state_transient_storage, rollback)
+{
+    TransientStorage ts;
+    ts.set(0x01_address, 0x01_bytes32, 0xaa_bytes32);
+    const auto checkpoint = ts.checkpoint();
+
+    ts.set(0x01_address, 0x01_bytes32, 0xbb_bytes32);
+    ts.set(0x01_address, 0x01_bytes32, 0xcc_bytes32);
+    ts.set(0x01_address, 0x02_bytes32, 0xdd_bytes32);
+    for (uint64_t i = 0; i < 100; ++i)  // Grows the table.
+        ts.set(0x02_address, bytes32{i}, 0x01_bytes32);
+
+    ts.rollback(checkpoint);
+    EXPECT_EQ(ts.checkpoint(), checkpoint);
+    EXPECT_EQ(ts.get(0x01_address, 0x01_bytes32), 0xaa_bytes32);
+    EXPECT_EQ(ts.get(0x01_address, 0x02_bytes32), 0x00_bytes32);
+    EXPECT_EQ(ts.get(0x02_address, 0x05_bytes32), 0x00_bytes32);
+
+    ts.rollback(0);
+    EXPECT_EQ(ts.get(0x01_address, 0x01_bytes32), 0x00_bytes32);
+}
+
+TEST(state_transient_storage, clear)
+{
+    TransientStorage ts;
+    for (uint64_t i = 0; i < 100; ++i)
+        ts.set(0x01_address, bytes32{i}, 0x01_bytes32);
+
+    ts.clear();
+    EXPECT_EQ(ts.size(), 0);
+    EXPECT_EQ(ts.checkpoint(), 0);
+    for (uint64_t i = 0; i < 100; ++i)
+        EXPECT_EQ(ts.get(0x01_address, bytes32{i}), 0x00_bytes32);
+
+    ts.set(0x01_address, 0x05_bytes32, 0x02_bytes32);
+    EXPECT_EQ(ts.get(0x01_address, 0x05_bytes32), 0x02_bytes32);
+    EXPECT_EQ(ts.get(0x01_address, 0x06_bytes32), 0x00_bytes32);
+    EXPECT_EQ(ts.size(), 1);
+}
@@ -37,7 +37,8 @@ void state_transition::TearDown()
     if (trace)
         trace_capture.emplace();
 
-    const auto res = evmone::state::transition(state, block, tx, rev, selected_vm, block.gas_limit);
+    const auto res = evmone::state::transition(
+        state, block, tx, rev, selected_vm, block.gas_limit, nullptr, transient_storage);
 
     if (const auto expected_error = make_error_code(expect.tx_error))
     {
@@ -118,4 +119,17 @@ void state_transition::TearDown()
         EXPECT_EQ(trace_capture->get_capture(), expect.trace);
     }
 }
+
+TransactionReceipt state_execution::execute(State& state, const Transaction& transaction,
+    evmc::VM& exec_vm, StaticCallMemo* static_call_memo)
+{
+    auto res = evmone::state::transition(
+        state, block, transaction, rev, exec_vm, block.gas_limit, static_call_memo);
+    if (holds_alternative<std::error_code>(res))
+    {
+        ADD_FAILURE() << "invalid tx: " << std::get<std::error_code>(res).message();
+        return {};
+    }
+    return std::get<TransactionReceipt>(std::move(res));
+}
 }  // namespace evmone::test
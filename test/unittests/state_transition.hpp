@@ -31,8 +31,9 @@ protected:
 
     static constexpr auto Coinbase = 0xc014bace_address;
 
-    static inline evmc::VM vm{evmc_create_evmone()};
-    static inline evmc::VM tracing_vm{evmc_create_evmone(), {{"trace", "1"}}};
+    static inline evmc::VM vm{evmc_create_evmone(), {{"host_ext", ""}}};
+    static inline evmc::VM tracing_vm{
+        evmc_create_evmone(), {{"trace", "1"}, {"host_ext", ""}}};
 
     struct ExpectedAccount
     {
@@ -81,10 +82,29 @@ protected:
     State pre;
     Expectation expect;
 
+    /// The optional transient storage passed to the transition (reused between transactions).
+    TransientStorage* transient_storage = nullptr;
+
     void SetUp() override;
 
     /// The test runner.
     void TearDown() override;
 };
 
+/// The state_transition fixture for the tests executing the transactions themselves
+/// (e.g. with the VM wrappers) and inspecting the results directly.
+/// The expectations are not checked.
+class state_execution : public state_transition
+{
+protected:
+    state_execution() noexcept { rev = EVMC_CANCUN; }
+
+    void TearDown() override {}
+
+    /// Executes the transaction on the state with the given VM.
+    /// Reports the failure if the transaction is invalid.
+    TransactionReceipt execute(State& state, const Transaction& transaction, evmc::VM& exec_vm,
+        StaticCallMemo* static_call_memo = nullptr);
+};
+
 }  // namespace evmone::test
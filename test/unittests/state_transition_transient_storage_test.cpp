@@ -60,3 +60,23 @@ TEST_F(state_transition, transient_storage_static)
     expect.post[To].storage[0xc3_bytes32] = 0x00_bytes32;
     expect.post[To].storage[0xd1_bytes32] = 0x07_bytes32;
 }
+
+TEST_F(state_transition, transient_storage_reused)
+{
+    rev = EVMC_CANCUN;
+    const auto tbump = 0xb0_address;
+
+    // The storage left by the previous transaction is cleared by the transition.
+    // The storage must outlive the test body as the transition is executed in TearDown().
+    static TransientStorage reused;
+    reused.clear();
+    reused.set(tbump, 0x00_bytes32, 0x05_bytes32);
+    transient_storage = &reused;
+
+    tx.to = To;
+    pre.insert(tbump, {.code = tstore(0, add(tload(0), 1)) + sstore(0, tload(0))});
+    pre.insert(*tx.to, {.code = call(tbump).gas(0xffff) + call(tbump).gas(0xffff)});
+
+    expect.post[To].exists = true;
+    expect.post[tbump].storage[0x00_bytes32] = 0x02_bytes32;
+}
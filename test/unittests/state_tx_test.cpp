@@ -81,3 +81,79 @@ TEST(state_tx, validate_sender)
         std::get<std::error_code>(validate_transaction(acc, bi, tx, EVMC_LONDON, 60000)).message(),
         "insufficient funds for gas * price + value");
 }
+
+TEST(state_tx, validate_data_cost)
+{
+    const BlockInfo bi{.gas_limit = 0x989680,
+        .coinbase = 0x01_address,
+        .prev_randao = {},
+        .base_fee = 0,
+        .withdrawals = {}};
+    const Account acc{.nonce = 0, .balance = 0};
+    Transaction tx{
+        .data = {},
+        .gas_limit = 60000,
+        .max_gas_price = bi.base_fee,
+        .max_priority_gas_price = 0,
+        .sender = 0x02_address,
+        .to = 0x03_address,
+        .value = 0,
+        .access_list = {},
+        .nonce = 0,
+        .r = 0,
+        .s = 0,
+    };
+
+    // 19 bytes: 13 zero bytes and 6 non-zero bytes spanning full 8-byte words and the tail.
+    tx.data = {0x00, 0x01, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x03, 0x04};
+    EXPECT_EQ(std::get<int64_t>(validate_transaction(acc, bi, tx, EVMC_BERLIN, 60000)),
+        60000 - 21000 - (13 * 4 + 6 * 16));
+    EXPECT_EQ(std::get<int64_t>(validate_transaction(acc, bi, tx, EVMC_BYZANTIUM, 60000)),
+        60000 - 21000 - (13 * 4 + 6 * 68));
+}
+
+TEST(state_tx, validate_transactions)
+{
+    const BlockInfo bi{.gas_limit = 0x989680,
+        .coinbase = 0x01_address,
+        .prev_randao = {},
+        .base_fee = 0x0a,
+        .withdrawals = {}};
+    State state;
+    state.insert(0x02_address, {.nonce = 1, .balance = 0xe8d4a51000});
+
+    const Transaction tx{
+        .data = {},
+        .gas_limit = 60000,
+        .max_gas_price = bi.base_fee,
+        .max_priority_gas_price = 0,
+        .sender = 0x02_address,
+        .to = 0x03_address,
+        .value = 0,
+        .access_list = {},
+        .nonce = 1,
+        .r = 0,
+        .s = 0,
+    };
+    std::vector<Transaction> txs(5, tx);
+    txs[1].nonce = 0;
+    txs[2].sender = 0x05_address;  // Not existing in the state.
+    txs[3].gas_limit = 20000;
+    txs[4].data = {0x00, 0x01};
+
+    for (const unsigned num_threads : {1u, 2u, 0u})
+    {
+        const auto results = validate_transactions(state, bi, txs, EVMC_LONDON, num_threads);
+        ASSERT_EQ(results.size(), txs.size());
+        EXPECT_EQ(results[0].error, SUCCESS);
+        EXPECT_EQ(results[0].execution_gas_limit, 60000 - 21000);
+        EXPECT_EQ(results[1].error, NONCE_TOO_LOW);
+        EXPECT_EQ(results[2].error, NONCE_TOO_HIGH);
+        EXPECT_EQ(results[3].error, INTRINSIC_GAS_TOO_LOW);
+        EXPECT_EQ(results[4].error, SUCCESS);
+        EXPECT_EQ(results[4].execution_gas_limit, 60000 - 21000 - 4 - 16);
+    }
+
+    EXPECT_TRUE(validate_transactions(state, bi, {}, EVMC_LONDON).empty());
+}
@@ -5,11 +5,17 @@
 #include "test/utils/bytecode.hpp"
 #include <evmc/evmc.hpp>
 #include <evmc/mocked_host.hpp>
+#include <evmone/baseline.hpp>
+#include <evmone/checkpoints.hpp>
 #include <evmone/evmone.h>
+#include <evmone/execution_state.hpp>
 #include <evmone/instructions_traits.hpp>
 #include <evmone/tracing.hpp>
 #include <evmone/vm.hpp>
 #include <gmock/gmock.h>
+#include <test/state/hash_utils.hpp>
+#include <array>
+#include <set>
 
 using namespace testing;
 
@@ -124,6 +130,64 @@ TEST_F(tracing, three_tracers)
     EXPECT_EQ(trace(dup1(0)), "A0:PUSH1 B0:PUSH1 C0:PUSH1 A2:DUP1 B2:DUP1 C2:DUP1 ");
 }
 
+TEST_F(tracing, filter_depth)
+{
+    vm.add_tracer(std::make_unique<OpcodeTracer>(*this, ""));
+    vm.trace_filter.min_depth = 1;
+    vm.trace_filter.max_depth = 2;
+
+    EXPECT_EQ(trace(add(1, 2), 0), "");
+    EXPECT_EQ(trace(add(1, 2), 1), "0:PUSH1 2:PUSH1 4:ADD ");
+    EXPECT_EQ(trace(add(1, 2), 2), "0:PUSH1 2:PUSH1 4:ADD ");
+    EXPECT_EQ(trace(add(1, 2), 3), "");
+}
+
+TEST_F(tracing, filter_code_address_and_hash)
+{
+    vm.add_tracer(std::make_unique<OpcodeTracer>(*this, ""));
+    const auto code = bytecode{add(1, 2)};
+
+    vm.trace_filter.code_address = evmc::address{0xc0de};
+    EXPECT_EQ(trace(code), "");
+    vm.trace_filter.code_address = evmc::address{};
+    EXPECT_EQ(trace(code), "0:PUSH1 2:PUSH1 4:ADD ");
+
+    vm.trace_filter.code_hash = evmc::bytes32{};
+    EXPECT_EQ(trace(code), "");
+    vm.trace_filter.code_hash = evmone::keccak256(code);
+    EXPECT_EQ(trace(code), "0:PUSH1 2:PUSH1 4:ADD ");
+}
+
+TEST_F(tracing, filter_code_hash_checked_codes)
+{
+    vm.add_tracer(std::make_unique<OpcodeTracer>(*this, ""));
+    const auto code1 = bytecode{add(1, 2)};
+    const auto code2 = bytecode{add(1, 3)};
+    const auto code3 = bytecode{add(1, 2) + OP_STOP};
+
+    // The results of the codes already checked against the hash must be the same.
+    vm.trace_filter.code_hash = evmone::keccak256(code1);
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_EQ(trace(code2), "");
+        EXPECT_EQ(trace(code1), "0:PUSH1 2:PUSH1 4:ADD ");
+        EXPECT_EQ(trace(code3), "");
+    }
+
+    vm.trace_filter.code_hash = evmone::keccak256(code2);
+    EXPECT_EQ(trace(code1), "");
+    EXPECT_EQ(trace(code2), "0:PUSH1 2:PUSH1 4:ADD ");
+}
+
+TEST_F(tracing, filter_selector)
+{
+    vm.add_tracer(std::make_unique<OpcodeTracer>(*this, ""));
+    vm.trace_filter.selector = {0xa9, 0x05, 0x9c, 0xbb};
+
+    // No input.
+    EXPECT_EQ(trace(add(1, 2)), "");
+}
+
 TEST_F(tracing, histogram)
 {
     vm.add_tracer(evmone::create_histogram_tracer(trace_stream));
@@ -175,6 +239,41 @@ TEST_F(tracing, trace)
 )");
 }
 
+TEST_F(tracing, trace_memory_write)
+{
+    vm.add_tracer(evmone::create_instruction_tracer(trace_stream, {.memory = true}));
+
+    const auto code = push(0xaa) + push(1) + OP_MSTORE8 + OP_STOP;
+    trace_stream << '\n';
+    EXPECT_EQ(trace(code), R"(
+{"pc":0,"op":96,"gas":"0xf4240","gasCost":"0x3","memSize":0,"stack":[],"depth":1,"refund":0,"opName":"PUSH1"}
+{"pc":2,"op":96,"gas":"0xf423d","gasCost":"0x3","memSize":0,"stack":["0xaa"],"depth":1,"refund":0,"opName":"PUSH1"}
+{"pc":4,"op":83,"gas":"0xf423a","gasCost":"0x3","memSize":0,"stack":["0xaa","0x1"],"depth":1,"refund":0,"opName":"MSTORE8"}
+{"pc":5,"op":0,"gas":"0xf4234","gasCost":"0x0","memSize":32,"memWrite":{"offset":1,"data":"0xaa"},"stack":[],"depth":1,"refund":0,"opName":"STOP"}
+)");
+}
+
+TEST_F(tracing, trace_memory_write_failed)
+{
+    vm.add_tracer(evmone::create_instruction_tracer(trace_stream, {.memory = true}));
+
+    // The write range of the failed instruction is not reported.
+    const auto code = mstore(0, 1) + OP_MSTORE + OP_STOP;
+    const auto t = trace(code);
+    EXPECT_THAT(t, HasSubstr(R"("memWrite":{"offset":0,"data":"0x)"
+                             R"(0000000000000000000000000000000000000000000000000000000000000001"})"));
+    EXPECT_THAT(t, Not(HasSubstr("STOP")));
+}
+
+TEST_F(tracing, trace_storage_write)
+{
+    vm.add_tracer(evmone::create_instruction_tracer(trace_stream, {.storage = true}));
+
+    const auto t = trace(sstore(1, 0xbeef) + OP_STOP);
+    EXPECT_THAT(t, HasSubstr(R"("storage":{"0x1":"0xbeef"},"stack":[],"depth":1)"));
+    EXPECT_THAT(t, Not(HasSubstr("memWrite")));
+}
+
 TEST_F(tracing, trace_stack)
 {
     vm.add_tracer(evmone::create_instruction_tracer(trace_stream));
@@ -323,3 +422,76 @@ TEST_F(tracing, trace_create_intrcution)
 {"pc":14,"op":243,"gas":"0x3b08","gasCost":"0x0","memSize":32,"stack":["0x20","0x0"],"returnData":"0x60016000526001601ff3","depth":1,"refund":0,"opName":"RETURN"}
 )");
 }
+
+TEST_F(tracing, checkpoints_resume)
+{
+    evmone::CheckpointIndex index{.gas_interval = 10};
+    vm.add_tracer(evmone::create_checkpoint_tracer(index));
+    vm.add_tracer(evmone::create_instruction_tracer(trace_stream));
+
+    const auto code =
+        mstore(0, 1) + mstore(32, 2) + mstore(64, add(mload(0), mload(32))) + ret(64, 32);
+    const auto full_trace = trace(code);
+
+    ASSERT_GE(index.checkpoints.size(), 3);
+    EXPECT_EQ(index.find(0), nullptr);
+    for (size_t i = 1; i < index.checkpoints.size(); ++i)
+    {
+        const auto& prev = index.checkpoints[i - 1];
+        const auto& cp = index.checkpoints[i];
+        EXPECT_GT(cp.step, prev.step);
+        EXPECT_GE(prev.gas_left - cp.gas_left, index.gas_interval);
+        EXPECT_EQ(index.find(cp.step), &cp);
+        EXPECT_EQ(index.find(cp.step + 1), &cp);
+    }
+
+    // Resume from the checkpoint in the middle. The checkpoint is copied
+    // because the resumed execution is also traced by the checkpoint tracer.
+    const auto cp = index.checkpoints[index.checkpoints.size() / 2];
+    evmc_message msg{};
+    msg.gas = 1000000;
+    const auto analysis = evmone::baseline::analyze(EVMC_BERLIN, code);
+    evmone::ExecutionState state{
+        msg, EVMC_BERLIN, host.get_interface(), host.to_context(), code, {}};
+    auto result = evmone::baseline::resume(vm, state, analysis, cp);
+    EXPECT_EQ(result.status_code, EVMC_SUCCESS);
+    ASSERT_EQ(result.output_size, 32);
+    EXPECT_EQ(result.output_data[31], 3);
+    evmc_release_result(&result);
+
+    // The resumed trace is the suffix of the full trace starting at the checkpoint step.
+    size_t suffix_pos = 0;
+    for (uint64_t i = 0; i < cp.step; ++i)
+        suffix_pos = full_trace.find('\n', suffix_pos) + 1;
+    EXPECT_EQ(trace_stream.str(), full_trace.substr(suffix_pos));
+}
+
+TEST_F(tracing, checkpoints_memory_pages)
+{
+    evmone::CheckpointIndex index{.gas_interval = 1};
+    vm.add_tracer(evmone::create_checkpoint_tracer(index));
+
+    // The memory of 3 pages: the first and the last one are modified twice.
+    constexpr auto page_size = evmone::MemorySnapshot::page_size;
+    trace(mstore(2 * page_size, 1) + mstore(0, 2) + mstore(2 * page_size, 3) + OP_STOP);
+
+    std::array<std::set<const bytes*>, 3> distinct_pages;
+    for (const auto& cp : index.checkpoints)
+    {
+        if (cp.memory.size == 0)
+            continue;
+        ASSERT_EQ(cp.memory.size, 2 * page_size + 32);
+        ASSERT_EQ(cp.memory.pages.size(), 3);
+        for (size_t i = 0; i < distinct_pages.size(); ++i)
+            distinct_pages[i].insert(cp.memory.pages[i].get());
+    }
+    EXPECT_EQ(distinct_pages[0].size(), 2);
+    EXPECT_EQ(distinct_pages[1].size(), 1);
+    EXPECT_EQ(distinct_pages[2].size(), 2);
+
+    const auto& last = index.checkpoints.back().memory;
+    bytes memory(last.size, 0xff);
+    last.copy_to(memory.data());
+    EXPECT_EQ(memory, bytes(31, 0) + uint8_t{2} + bytes(2 * page_size - 32, 0) + bytes(31, 0) +
+                          uint8_t{3});
+}